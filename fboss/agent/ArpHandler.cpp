@@ -21,7 +21,7 @@
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/SwitchStats.h"
 #include "fboss/agent/TxPacket.h"
-#include "fboss/agent/packet/PktUtil.h"
+#include "fboss/agent/packet/HdrViews.h"
 #include "fboss/agent/state/AggregatePort.h"
 #include "fboss/agent/state/ArpEntry.h"
 #include "fboss/agent/state/ArpResponseTable.h"
@@ -66,24 +66,23 @@ void ArpHandler::handlePacket(
   CHECK(stats->port(port));
 
   stats->port(port)->arpPkt();
-  // Read htype, ptype, hlen, and plen
-  auto htype = cursor.readBE<uint16_t>();
-  if (htype != ARP_HTYPE_ETHERNET) {
+  // The header is read in place: fields are only loaded as they are checked,
+  // which matters when rejecting a flood of ARP packets.
+  ArpHdrView::Scratch arpScratch;
+  auto arpHdr = ArpHdrView::parse(&cursor, &arpScratch);
+  if (arpHdr.htype() != ARP_HTYPE_ETHERNET) {
     stats->port(port)->arpUnsupported();
     return;
   }
-  auto ptype = cursor.readBE<uint16_t>();
-  if (ptype != ARP_PTYPE_IPV4) {
+  if (arpHdr.ptype() != ARP_PTYPE_IPV4) {
     stats->port(port)->arpUnsupported();
     return;
   }
-  auto hlen = cursor.readBE<uint8_t>();
-  if (hlen != ARP_HLEN_ETHERNET) {
+  if (arpHdr.hlen() != ARP_HLEN_ETHERNET) {
     stats->port(port)->arpUnsupported();
     return;
   }
-  auto plen = cursor.readBE<uint8_t>();
-  if (plen != ARP_PLEN_IPV4) {
+  if (arpHdr.plen() != ARP_PLEN_IPV4) {
     stats->port(port)->arpUnsupported();
     return;
   }
@@ -98,12 +97,11 @@ void ArpHandler::handlePacket(
     return;
   }
 
-  // Parse the remaining data in the packet
-  auto readOp = cursor.readBE<uint16_t>();
-  auto senderMac = PktUtil::readMac(&cursor);
-  auto senderIP = PktUtil::readIPv4(&cursor);
-  auto targetMac = PktUtil::readMac(&cursor);
-  auto targetIP = PktUtil::readIPv4(&cursor);
+  // Read the remaining fields of the header
+  auto readOp = arpHdr.oper();
+  auto senderMac = arpHdr.sha();
+  auto senderIP = arpHdr.spa();
+  auto targetIP = arpHdr.tpa();
 
   if (readOp != ARP_OP_REQUEST && readOp != ARP_OP_REPLY) {
     stats->port(port)->arpBadOp();
@@ -163,8 +161,6 @@ void ArpHandler::handlePacket(
         senderMac,
         senderIP);
   }
-
-  (void)targetMac; // unused
 }
 
 static void sendArp(
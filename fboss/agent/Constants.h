@@ -23,6 +23,8 @@ inline constexpr folly::StringPiece kEgressId{"egressId"};
 inline constexpr folly::StringPiece kEgress{"egress"};
 inline constexpr folly::StringPiece kEntries{"entries"};
 inline constexpr folly::StringPiece kExtraFields{"extraFields"};
+inline constexpr folly::StringPiece kFibV4{"fibV4"};
+inline constexpr folly::StringPiece kFibV6{"fibV6"};
 inline constexpr folly::StringPiece kFlags{"flags"};
 inline constexpr folly::StringPiece kFwdInfo{"forwardingInfo"};
 inline constexpr folly::StringPiece kHostTable{"hostTable"};
@@ -23,6 +23,7 @@
 #include "fboss/agent/packet/DHCPv4Packet.h"
 #include "fboss/agent/packet/EthHdr.h"
 #include "fboss/agent/packet/Ethertype.h"
+#include "fboss/agent/packet/HdrViews.h"
 #include "fboss/agent/packet/IPProto.h"
 #include "fboss/agent/packet/IPv4Hdr.h"
 #include "fboss/agent/packet/UDPHeader.h"
@@ -146,9 +147,9 @@ namespace fboss {
 constexpr uint16_t DHCPv4Handler::kBootPSPort;
 constexpr uint16_t DHCPv4Handler::kBootPCPort;
 
-bool DHCPv4Handler::isDHCPv4Packet(const UDPHeader& udpHdr) {
-  auto srcPort = udpHdr.srcPort;
-  auto dstPort = udpHdr.dstPort;
+bool DHCPv4Handler::isDHCPv4Packet(const UDPHdrView& udpHdr) {
+  auto srcPort = udpHdr.srcPort();
+  auto dstPort = udpHdr.dstPort();
   return (srcPort == kBootPCPort || srcPort == kBootPSPort) ||
       (dstPort == kBootPCPort || dstPort == kBootPSPort);
 }
@@ -158,13 +159,13 @@ void DHCPv4Handler::handlePacket(
     std::unique_ptr<RxPacket> pkt,
     MacAddress srcMac,
     MacAddress /*dstMac*/,
-    const IPv4Hdr& ipHdr,
-    const UDPHeader& /*udpHdr*/,
+    const IPv4HdrView& ipHdr,
+    const UDPHdrView& /*udpHdr*/,
     Cursor cursor) {
   sw->portStats(pkt->getSrcPort())->dhcpV4Pkt();
-  if (ipHdr.ttl <= 1) {
+  if (ipHdr.ttl() <= 1) {
     sw->portStats(pkt->getSrcPort())->dhcpV4BadPkt();
-    XLOG(DBG4) << "Dropped DHCP packet with TTL of " << ipHdr.ttl;
+    XLOG(DBG4) << "Dropped DHCP packet with TTL of " << ipHdr.ttl();
     return;
   }
 
@@ -203,7 +204,7 @@ void DHCPv4Handler::processRequest(
     SwSwitch* sw,
     std::unique_ptr<RxPacket> pkt,
     MacAddress srcMac,
-    const IPv4Hdr& origIPHdr,
+    const IPv4HdrView& origIPHdr,
     const DHCPv4Packet& dhcpPacket) {
   auto dhcpPacketOut(dhcpPacket);
   auto state = sw->getState();
@@ -281,7 +282,7 @@ void DHCPv4Handler::processRequest(
   auto ipHdr = makeIpv4Header(
       switchIp,
       dhcpServer,
-      origIPHdr.ttl - 1,
+      origIPHdr.ttl() - 1,
       IPv4Hdr::minSize() + UDPHeader::size() + dhcpPacketOut.size());
   UDPHeader udpHdr(
       kBootPSPort, kBootPSPort, UDPHeader::size() + dhcpPacketOut.size());
@@ -292,7 +293,7 @@ void DHCPv4Handler::processRequest(
 void DHCPv4Handler::processReply(
     SwSwitch* sw,
     std::unique_ptr<RxPacket> pkt,
-    const IPv4Hdr& origIPHdr,
+    const IPv4HdrView& origIPHdr,
     const DHCPv4Packet& dhcpPacket) {
   auto dhcpPacketOut(dhcpPacket);
   auto state = sw->getState();
@@ -308,7 +309,7 @@ void DHCPv4Handler::processReply(
   }
   auto switchIp = state->getDhcpV4ReplySrc();
   if (switchIp.isZero()) {
-    switchIp = origIPHdr.dstAddr;
+    switchIp = origIPHdr.dstAddr();
   }
   MacAddress cpuMac = sw->getPlatform()->getLocalMac();
   // Extract client MAC address from dhcp reply
@@ -337,7 +338,7 @@ void DHCPv4Handler::processReply(
   auto ipHdr = makeIpv4Header(
       switchIp,
       clientIP,
-      origIPHdr.ttl - 1,
+      origIPHdr.ttl() - 1,
       IPv4Hdr::minSize() + UDPHeader::size() + dhcpPacketOut.size());
   UDPHeader udpHdr(
       kBootPSPort, kBootPCPort, UDPHeader::size() + dhcpPacketOut.size());
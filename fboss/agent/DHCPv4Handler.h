@@ -19,10 +19,10 @@ namespace facebook {
 namespace fboss {
 class SwSwitch;
 class RxPacket;
-class UDPHeader;
 class DHCPv4Packet;
 class TxPacket;
-class IPv4Hdr;
+class IPv4HdrView;
+class UDPHdrView;
 
 class DHCPv4Handler {
  public:
@@ -37,14 +37,17 @@ class DHCPv4Handler {
   enum SubOptionsOfInterest { AGENT_CIRCUIT_ID = 1 };
   static constexpr uint16_t kBootPSPort = 67;
   static constexpr uint16_t kBootPCPort = 68;
-  static bool isDHCPv4Packet(const UDPHeader& udpHdr);
+  static bool isDHCPv4Packet(const UDPHdrView& udpHdr);
+  /*
+   * ipHdr and udpHdr are header views, which are only valid for the call.
+   */
   static void handlePacket(
       SwSwitch* sw,
       std::unique_ptr<RxPacket> pkt,
       folly::MacAddress srcMac,
       folly::MacAddress dstMac,
-      const IPv4Hdr& ipHdr,
-      const UDPHeader& udpHdr,
+      const IPv4HdrView& ipHdr,
+      const UDPHdrView& udpHdr,
       folly::io::Cursor cursor);
 
  private:
@@ -52,12 +55,12 @@ class DHCPv4Handler {
       SwSwitch* sw,
       std::unique_ptr<RxPacket> pkt,
       folly::MacAddress srcMac,
-      const IPv4Hdr& ipHdr,
+      const IPv4HdrView& ipHdr,
       const DHCPv4Packet& dhcpPacket);
   static void processReply(
       SwSwitch* sw,
       std::unique_ptr<RxPacket> pkt,
-      const IPv4Hdr& ipHdr,
+      const IPv4HdrView& ipHdr,
       const DHCPv4Packet& dhcpPacket);
   static bool addAgentOptions(
       SwSwitch* sw,
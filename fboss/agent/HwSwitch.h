@@ -14,6 +14,7 @@
 #include "fboss/agent/types.h"
 
 #include <folly/IPAddress.h>
+#include <folly/Range.h>
 #include <optional>
 
 #include <memory>
@@ -80,6 +81,20 @@ class HwSwitch {
      */
     virtual void packetReceived(std::unique_ptr<RxPacket> pkt) noexcept = 0;
 
+    /*
+     * packetsReceived() is invoked by HwSwitches which receive trapped
+     * packets in batches. The callback takes ownership of the packets by
+     * moving them out of the range. Implementations may amortize per packet
+     * work over the batch; by default each packet is handed to
+     * packetReceived().
+     */
+    virtual void packetsReceived(
+        folly::Range<std::unique_ptr<RxPacket>*> pkts) noexcept {
+      for (auto& pkt : pkts) {
+        packetReceived(std::move(pkt));
+      }
+    }
+
     /*
      * linkStateChanged() is invoked by the HwSwitch whenever the link
      * status changes on a port.
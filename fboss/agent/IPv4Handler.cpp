@@ -27,9 +27,9 @@
 #include "fboss/agent/SwitchStats.h"
 #include "fboss/agent/TxPacket.h"
 #include "fboss/agent/Utils.h"
+#include "fboss/agent/packet/HdrViews.h"
 #include "fboss/agent/packet/ICMPHdr.h"
 #include "fboss/agent/packet/IPv4Hdr.h"
-#include "fboss/agent/packet/UDPHeader.h"
 #include "fboss/agent/state/ArpResponseTable.h"
 #include "fboss/agent/state/ArpTable.h"
 #include "fboss/agent/state/Interface.h"
@@ -131,14 +131,18 @@ void IPv4Handler::handlePacket(
 
   const uint32_t l3Len = pkt->getLength() - (cursor - Cursor(pkt->buf()));
   stats->port(port)->ipv4Rx();
-  IPv4Hdr v4Hdr(cursor);
-  XLOG(DBG4) << "Rx IPv4 packet (" << l3Len << " bytes) " << v4Hdr.srcAddr.str()
-             << " --> " << v4Hdr.dstAddr.str() << " proto: 0x" << std::hex
-             << static_cast<int>(v4Hdr.protocol);
+  // DHCP relay only needs a few header fields, so look at the headers
+  // through views, and decode the whole IPv4 header only for other packets.
+  Cursor v4Cursor(cursor);
+  IPv4HdrView::Scratch v4Scratch;
+  auto v4View = IPv4HdrView::parse(&cursor, &v4Scratch);
+  XLOG(DBG4) << "Rx IPv4 packet (" << l3Len << " bytes) "
+             << v4View.srcAddr().str() << " --> " << v4View.dstAddr().str()
+             << " proto: 0x" << std::hex << static_cast<int>(v4View.protocol());
 
   // Additional data (such as FCS) may be appended after the IP payload
   auto payload =
-      folly::IOBuf::wrapBuffer(cursor.data(), v4Hdr.length - v4Hdr.size());
+      folly::IOBuf::wrapBuffer(cursor.data(), v4View.length() - v4View.size());
   cursor.reset(payload.get());
 
   // retrieve the current switch state
@@ -151,19 +155,24 @@ void IPv4Handler::handlePacket(
     return;
   }
 
-  if (v4Hdr.protocol == static_cast<uint8_t>(IP_PROTO::IP_PROTO_UDP)) {
+  if (v4View.protocol() == static_cast<uint8_t>(IP_PROTO::IP_PROTO_UDP)) {
     Cursor udpCursor(cursor);
-    UDPHeader udpHdr;
-    udpHdr.parse(&udpCursor, sw_->portStats(port));
-    XLOG(DBG4) << "UDP packet, Source port :" << udpHdr.srcPort
-               << " destination port: " << udpHdr.dstPort;
+    if (!udpCursor.canAdvance(UDPHdrView::MAX_SIZE)) {
+      stats->port(port)->udpTooSmall();
+    }
+    UDPHdrView::Scratch udpScratch;
+    auto udpHdr = UDPHdrView::parse(&udpCursor, &udpScratch);
+    XLOG(DBG4) << "UDP packet, Source port :" << udpHdr.srcPort()
+               << " destination port: " << udpHdr.dstPort();
     if (DHCPv4Handler::isDHCPv4Packet(udpHdr)) {
       DHCPv4Handler::handlePacket(
-          sw_, std::move(pkt), src, dst, v4Hdr, udpHdr, udpCursor);
+          sw_, std::move(pkt), src, dst, v4View, udpHdr, udpCursor);
       return;
     }
   }
 
+  IPv4Hdr v4Hdr(v4Cursor);
+
   // Handle packets destined for us
   // Get the Interface to which this packet should be forwarded in host
   // TODO: assume vrf 0 now
@@ -329,7 +329,9 @@ void LinkAggregationManager::enableForwarding(
       portID, aggPortID, AggregatePort::Forwarding::ENABLED);
 
   sw_->updateStateNoCoalescing(
-      "AggregatePort ForwardingState", std::move(enableFwdStateFn));
+      "AggregatePort ForwardingState",
+      std::move(enableFwdStateFn),
+      folly::to<std::string>("aggregate port member ", portID));
 }
 
 void LinkAggregationManager::disableForwarding(
@@ -341,7 +343,9 @@ void LinkAggregationManager::disableForwarding(
       portID, aggPortID, AggregatePort::Forwarding::DISABLED);
 
   sw_->updateStateNoCoalescing(
-      "AggregatePort ForwardingState", std::move(disableFwdStateFn));
+      "AggregatePort ForwardingState",
+      std::move(disableFwdStateFn),
+      folly::to<std::string>("aggregate port member ", portID));
 }
 
 std::vector<std::shared_ptr<LacpController>>
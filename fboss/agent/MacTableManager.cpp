@@ -14,22 +14,62 @@
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/state/SwitchState.h"
 
+#include <gflags/gflags.h>
+
+DEFINE_uint32(
+    l2_learning_batch_window_ms,
+    0,
+    "How long to accumulate L2 learning and aging events before applying "
+    "them. With 0, events are still batched while the update thread is busy.");
+
 namespace facebook {
 namespace fboss {
 
-MacTableManager::MacTableManager(SwSwitch* sw) : sw_(sw) {}
+MacTableManager::MacTableManager(SwSwitch* sw)
+    : sw_(sw), pending_(std::make_shared<PendingL2Updates>()) {}
 
 void MacTableManager::handleL2LearningUpdate(
     L2Entry l2Entry,
     L2EntryUpdateType l2EntryUpdateType) {
-  auto updateMacTableFn =
-      [l2Entry, l2EntryUpdateType](const std::shared_ptr<SwitchState>& state) {
-        return MacTableUtils::updateMacTable(state, l2Entry, l2EntryUpdateType);
-      };
-
-  sw_->updateState(
-      folly::to<std::string>("Programming : ", l2Entry.str()),
-      std::move(updateMacTableFn));
+  bool firstInBatch;
+  {
+    std::lock_guard<std::mutex> guard(pending_->lock);
+    firstInBatch = pending_->updates.empty();
+    pending_->updates.emplace_back(std::move(l2Entry), l2EntryUpdateType);
+  }
+  if (!firstInBatch) {
+    // The state update scheduled for the batch will apply this one as well
+    return;
+  }
+
+  if (FLAGS_l2_learning_batch_window_ms == 0) {
+    scheduleStateUpdate(sw_, pending_);
+    return;
+  }
+  auto* evb = sw_->getUpdateEvb();
+  evb->runInEventBaseThread([sw = sw_, pending = pending_, evb]() {
+    evb->runAfterDelay(
+        [sw, pending]() { scheduleStateUpdate(sw, pending); },
+        FLAGS_l2_learning_batch_window_ms);
+  });
+}
+
+void MacTableManager::scheduleStateUpdate(
+    SwSwitch* sw,
+    std::shared_ptr<PendingL2Updates> pending) {
+  auto updateMacTableFn = [pending = std::move(pending)](
+                              const std::shared_ptr<SwitchState>& state) {
+    // Take everything received so far, later events start a new batch
+    L2Updates l2Updates;
+    {
+      std::lock_guard<std::mutex> guard(pending->lock);
+      l2Updates.swap(pending->updates);
+    }
+    return MacTableUtils::updateMacTable(state, l2Updates);
+  };
+
+  sw->updateState(
+      "Programming L2 learning updates", std::move(updateMacTableFn));
 }
 } // namespace fboss
 } // namespace facebook
@@ -11,11 +11,26 @@
 
 #include "fboss/agent/L2Entry.h"
 
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
 namespace facebook {
 namespace fboss {
 
 class SwSwitch;
 
+/*
+ * MacTableManager applies L2 learning and aging events to the MAC tables.
+ *
+ * Events are not applied one state update each. They accumulate in a batch,
+ * and a single state update applies the whole batch: every event received
+ * until that update runs on the update thread, plus for the first
+ * --l2_learning_batch_window_ms after the first one. A burst of learning
+ * (e.g. a rack of servers rebooting) therefore clones the MAC tables and
+ * programs the hardware once rather than once per MAC.
+ */
 class MacTableManager {
  public:
   explicit MacTableManager(SwSwitch* sw);
@@ -25,11 +40,27 @@ class MacTableManager {
       L2EntryUpdateType l2EntryUpdateType);
 
  private:
+  using L2Updates = std::vector<std::pair<L2Entry, L2EntryUpdateType>>;
+
+  /*
+   * Shared with the callbacks scheduling and applying the batch, which may
+   * still run while the SwSwitch is stopping, after MacTableManager is gone.
+   */
+  struct PendingL2Updates {
+    std::mutex lock;
+    L2Updates updates;
+  };
+
   // Forbidden copy constructor and assignment operator
   MacTableManager(MacTableManager const&) = delete;
   MacTableManager& operator=(MacTableManager const&) = delete;
 
+  static void scheduleStateUpdate(
+      SwSwitch* sw,
+      std::shared_ptr<PendingL2Updates> pending);
+
   SwSwitch* sw_{nullptr};
+  std::shared_ptr<PendingL2Updates> pending_;
 };
 
 } // namespace fboss
@@ -9,6 +9,11 @@
  */
 #include "fboss/agent/MacTableUtils.h"
 
+#include "fboss/agent/FbossError.h"
+
+#include <folly/ExceptionString.h>
+#include <folly/logging/xlog.h>
+
 namespace {
 
 using facebook::fboss::MacEntry;
@@ -61,6 +66,10 @@ std::shared_ptr<SwitchState> MacTableUtils::updateMacTable(
   auto mac = l2Entry.getMac();
   auto portDescr = l2Entry.getPort();
   auto vlan = state->getVlans()->getVlanIf(vlanID).get();
+  if (!vlan) {
+    throw FbossError(
+        "Cannot update MAC ", mac, ": VLAN ", vlanID, " does not exist");
+  }
   std::shared_ptr<SwitchState> newState{state};
   auto* macTable = vlan->getMacTable().get();
   auto node = macTable->getNodeIf(mac);
@@ -85,6 +94,25 @@ std::shared_ptr<SwitchState> MacTableUtils::updateMacTable(
   return newState;
 }
 
+std::shared_ptr<SwitchState> MacTableUtils::updateMacTable(
+    const std::shared_ptr<SwitchState>& state,
+    const std::vector<std::pair<L2Entry, L2EntryUpdateType>>& l2Updates) {
+  // Only the first update that changes anything clones the state, the
+  // following ones modify the unpublished clone in place.
+  // An update that fails is logged and skipped, so that it does not take the
+  // rest of the batch down with it.
+  std::shared_ptr<SwitchState> newState{state};
+  for (const auto& l2Update : l2Updates) {
+    try {
+      newState = updateMacTable(newState, l2Update.first, l2Update.second);
+    } catch (const std::exception& ex) {
+      XLOG(ERR) << "Failed to apply L2 update " << l2Update.first.str()
+                << ": " << folly::exceptionStr(ex);
+    }
+  }
+  return newState;
+}
+
 std::shared_ptr<SwitchState> MacTableUtils::updateOrAddEntryWithClassID(
     const std::shared_ptr<SwitchState>& state,
     VlanID vlanID,
@@ -12,6 +12,9 @@
 #include "fboss/agent/L2Entry.h"
 #include "fboss/agent/state/SwitchState.h"
 
+#include <utility>
+#include <vector>
+
 namespace facebook {
 namespace fboss {
 
@@ -25,6 +28,13 @@ class MacTableUtils {
       L2Entry l2Entry,
       L2EntryUpdateType l2EntryUpdateType);
 
+  /*
+   * Applies a batch of learning updates, in order, as a single state update.
+   */
+  static std::shared_ptr<SwitchState> updateMacTable(
+      const std::shared_ptr<SwitchState>& state,
+      const std::vector<std::pair<L2Entry, L2EntryUpdateType>>& l2Updates);
+
   static std::shared_ptr<SwitchState> updateOrAddEntryWithClassID(
       const std::shared_ptr<SwitchState>& state,
       VlanID vlanID,
@@ -13,7 +13,11 @@ namespace fboss {
 class MirrorManager : public AutoRegisterStateObserver {
  public:
   explicit MirrorManager(SwSwitch* sw)
-      : AutoRegisterStateObserver(sw, "MirrorManager"),
+      : AutoRegisterStateObserver(
+            sw,
+            "MirrorManager",
+            {} /* dependencies */,
+            true /* concurrent */),
         sw_(sw),
         v4Manager_(std::make_unique<MirrorManagerV4>(sw)),
         v6Manager_(std::make_unique<MirrorManagerV6>(sw)) {}
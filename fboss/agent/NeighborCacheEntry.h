@@ -19,6 +19,7 @@
 #include <folly/IPAddress.h>
 #include <folly/MacAddress.h>
 #include <folly/Random.h>
+#include <folly/io/async/HHWheelTimer.h>
 #include <chrono>
 
 /**
@@ -56,6 +57,13 @@
  * next update is scheduled. If the entry ever transitions to the EXPIRED state,
  * we do not schedule another update and the cache will flush the entry.
  *
+ * Timeouts are scheduled on the HHWheelTimer of the neighbor EventBase rather
+ * than as one libevent timer per entry. Scheduling and cancelling are then
+ * constant time even with hundreds of thousands of entries, and all entries
+ * due in the same wheel tick are processed in one pass. The jitter applied to
+ * REACHABLE lifetimes keeps entries learned together from all going STALE in
+ * the same tick.
+ *
  * There is no locking in this class. Instead, the class relies on the
  * synchronization provided by NeighborCache, which should lock around all calls
  * into the cache with a single cache level lock. This class should take care
@@ -79,7 +87,7 @@ template <typename NTable>
 class NeighborCache;
 
 template <typename NTable>
-class NeighborCacheEntry : private folly::AsyncTimeout {
+class NeighborCacheEntry : private folly::HHWheelTimer::Callback {
  public:
   typedef typename NTable::Entry::AddressType AddressType;
   typedef NeighborCache<NTable> Cache;
@@ -90,8 +98,7 @@ class NeighborCacheEntry : private folly::AsyncTimeout {
       folly::EventBase* evb,
       Cache* cache,
       NeighborEntryState state)
-      : AsyncTimeout(evb),
-        fields_(fields),
+      : fields_(fields),
         cache_(cache),
         evb_(evb),
         probesLeft_(cache_->getMaxNeighborProbes()) {
@@ -242,6 +249,16 @@ class NeighborCacheEntry : private folly::AsyncTimeout {
     cache_->processEntry(getIP());
   }
 
+  /*
+   * Only called when the EventBase and its timer are being destroyed, at
+   * which point there is no point processing the entry.
+   */
+  void callbackCanceled() noexcept override {}
+
+  void scheduleTimeout(std::chrono::milliseconds timeout) {
+    evb_->timer().scheduleTimeout(this, timeout);
+  }
+
   /*
    * Schedules an update on the evb_. This is done synchronously so that we
    * can have a destructor guard around both running the state machine and
@@ -142,7 +142,8 @@ void NeighborCacheImpl<NTable>::programPendingEntry(Entry* entry, bool force) {
 
   sw_->updateStateNoCoalescing(
       folly::to<std::string>("add pending entry ", fields.ip),
-      std::move(updateFn));
+      std::move(updateFn),
+      folly::to<std::string>("neighbor ", vlanID, " ", fields.ip));
 }
 
 template <typename NTable>
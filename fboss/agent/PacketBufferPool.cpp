@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/PacketBufferPool.h"
+
+#include "fboss/agent/SwitchStats.h"
+
+#include <algorithm>
+
+using facebook::fb303::RATE;
+using facebook::fb303::SUM;
+using folly::IOBuf;
+
+namespace facebook {
+namespace fboss {
+
+PacketBufferPool::ThreadCache::ThreadCache(PacketBufferPool* pool)
+    : pool(pool),
+      hits(
+          fb303::ThreadCachedServiceData::get()->getThreadStats(),
+          SwitchStats::kCounterPrefix + "packet_buffer_pool.hits",
+          SUM,
+          RATE),
+      misses(
+          fb303::ThreadCachedServiceData::get()->getThreadStats(),
+          SwitchStats::kCounterPrefix + "packet_buffer_pool.misses",
+          SUM,
+          RATE) {}
+
+PacketBufferPool::ThreadCache::~ThreadCache() {
+  for (size_t sizeClass = 0; sizeClass < kNumSizeClasses; ++sizeClass) {
+    pool->giveToDepot(
+        sizeClass, &buffers[sizeClass], buffers[sizeClass].size());
+  }
+}
+
+PacketBufferPool::Depot::~Depot() {
+  for (auto& classBuffers : buffers) {
+    for (auto buf : classBuffers) {
+      delete buf;
+    }
+  }
+}
+
+PacketBufferPool::PacketBufferPool()
+    : caches_([this]() { return new ThreadCache(this); }) {}
+
+PacketBufferPool* PacketBufferPool::get() {
+  static auto pool = new PacketBufferPool();
+  return pool;
+}
+
+std::unique_ptr<IOBuf> PacketBufferPool::allocate(uint32_t size) {
+  auto& cache = *caches_;
+  size_t sizeClass =
+      std::lower_bound(kSizeClasses.begin(), kSizeClasses.end(), size) -
+      kSizeClasses.begin();
+  if (sizeClass == kNumSizeClasses) {
+    cache.misses.addValue(1);
+    auto buf = IOBuf::create(size);
+    buf->append(size);
+    return buf;
+  }
+
+  auto& buffers = cache.buffers[sizeClass];
+  if (buffers.empty()) {
+    takeFromDepot(sizeClass, &buffers, kThreadCacheSize / 2);
+  }
+  std::unique_ptr<IOBuf> buf;
+  if (!buffers.empty()) {
+    buf.reset(buffers.back());
+    buffers.pop_back();
+    buf->clear();
+    cache.hits.addValue(1);
+  } else {
+    // The IOBuf, its SharedInfo and its data in a single allocation
+    buf = IOBuf::createCombined(kSizeClasses[sizeClass]);
+    cache.misses.addValue(1);
+  }
+  buf->append(size);
+  return buf;
+}
+
+void PacketBufferPool::recycle(std::unique_ptr<IOBuf> buf) {
+  if (!buf || buf->isChained() || !buf->isManagedOne() || buf->isSharedOne()) {
+    return;
+  }
+  // createCombined() may round the capacity up, but never to the next class
+  auto capacity = buf->capacity();
+  size_t sizeClass =
+      std::upper_bound(kSizeClasses.begin(), kSizeClasses.end(), capacity) -
+      kSizeClasses.begin();
+  if (sizeClass == 0 ||
+      (sizeClass == kNumSizeClasses &&
+       capacity >= 2 * kSizeClasses[kNumSizeClasses - 1])) {
+    return;
+  }
+  --sizeClass;
+
+  auto& buffers = caches_->buffers[sizeClass];
+  buffers.push_back(buf.release());
+  if (buffers.size() > kThreadCacheSize) {
+    giveToDepot(sizeClass, &buffers, buffers.size() / 2);
+  }
+}
+
+void PacketBufferPool::takeFromDepot(
+    size_t sizeClass,
+    Buffers* buffers,
+    size_t count) {
+  std::lock_guard<std::mutex> guard(depot_.lock);
+  auto& depotBuffers = depot_.buffers[sizeClass];
+  count = std::min(count, depotBuffers.size());
+  buffers->insert(
+      buffers->end(), depotBuffers.end() - count, depotBuffers.end());
+  depotBuffers.resize(depotBuffers.size() - count);
+}
+
+void PacketBufferPool::giveToDepot(
+    size_t sizeClass,
+    Buffers* buffers,
+    size_t count) {
+  auto first = buffers->end() - count;
+  {
+    std::lock_guard<std::mutex> guard(depot_.lock);
+    auto& depotBuffers = depot_.buffers[sizeClass];
+    auto kept = std::min(count, kDepotSize - depotBuffers.size());
+    depotBuffers.insert(depotBuffers.end(), first, first + kept);
+    first += kept;
+  }
+  // The depot is full, these are better off back with malloc
+  std::for_each(first, buffers->end(), [](IOBuf* buf) { delete buf; });
+  buffers->resize(buffers->size() - count);
+}
+
+} // namespace fboss
+} // namespace facebook
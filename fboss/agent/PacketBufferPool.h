@@ -0,0 +1,111 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <fb303/ThreadCachedServiceData.h>
+#include <folly/ThreadLocal.h>
+#include <folly/io/IOBuf.h>
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace facebook {
+namespace fboss {
+
+/*
+ * PacketBufferPool recycles the IOBufs of the packets we send and receive,
+ * so that floods of small control packets (ARP, NDP, LLDP, LACP) don't turn
+ * into floods of malloc()/free() calls.
+ *
+ * Pooled IOBufs are allocated with IOBuf::createCombined(), i.e. the IOBuf,
+ * its SharedInfo and its data come from a single malloc(), and are grouped in
+ * size classes. Packets give their IOBuf back with recycle() when they are
+ * freed, and the next allocation of the same size class reuses it as a
+ * whole, without any malloc().
+ *
+ * Each thread keeps a small cache of free IOBufs per size class, so most
+ * allocations and recycles don't need any locking. Threads with too many free
+ * IOBufs (e.g. the threads freeing sent packets) hand half of them over to a
+ * shared depot, where threads running out of IOBufs (e.g. the threads
+ * building packets) pick them up.
+ *
+ * Allocations served from a free IOBuf are counted in
+ * packet_buffer_pool.hits, the others in packet_buffer_pool.misses.
+ * Requests larger than the largest size class are not pooled.
+ */
+class PacketBufferPool {
+ public:
+  static constexpr size_t kNumSizeClasses = 6;
+  static constexpr std::array<uint32_t, kNumSizeClasses> kSizeClasses = {
+      {128, 256, 512, 1024, 2048, 10240}};
+  // Free IOBufs each thread keeps per size class
+  static constexpr size_t kThreadCacheSize = 64;
+  // Free IOBufs the depot keeps per size class
+  static constexpr size_t kDepotSize = 1024;
+
+  PacketBufferPool();
+
+  /*
+   * The pool used for all packets. It is never destroyed, since packets may
+   * be freed at any time.
+   */
+  static PacketBufferPool* get();
+
+  /*
+   * Returns an IOBuf with size bytes of data and no headroom.
+   */
+  std::unique_ptr<folly::IOBuf> allocate(uint32_t size);
+
+  /*
+   * Keeps buf for a later allocation. buf should come from allocate(). It is
+   * simply freed if it was not pooled, or if it is chained or shares its
+   * buffer with other IOBufs.
+   */
+  void recycle(std::unique_ptr<folly::IOBuf> buf);
+
+ private:
+  using Buffers = std::vector<folly::IOBuf*>;
+
+  struct ThreadCache {
+    explicit ThreadCache(PacketBufferPool* pool);
+    // Returns the free IOBufs to the depot
+    ~ThreadCache();
+
+    PacketBufferPool* pool;
+    std::array<Buffers, kNumSizeClasses> buffers;
+    fb303::ThreadCachedServiceData::TLTimeseries hits;
+    fb303::ThreadCachedServiceData::TLTimeseries misses;
+  };
+
+  // Frees the IOBufs it still holds on destruction
+  struct Depot {
+    ~Depot();
+
+    std::mutex lock;
+    std::array<Buffers, kNumSizeClasses> buffers;
+  };
+
+  // Forbidden copy constructor and assignment operator
+  PacketBufferPool(PacketBufferPool const&) = delete;
+  PacketBufferPool& operator=(PacketBufferPool const&) = delete;
+
+  // Moves up to count IOBufs of the size class between the depot and buffers
+  void takeFromDepot(size_t sizeClass, Buffers* buffers, size_t count);
+  void giveToDepot(size_t sizeClass, Buffers* buffers, size_t count);
+
+  // Destroyed after the thread caches, which return their IOBufs to it
+  Depot depot_;
+  folly::ThreadLocal<ThreadCache> caches_;
+};
+
+} // namespace fboss
+} // namespace facebook
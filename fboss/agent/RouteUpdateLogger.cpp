@@ -65,7 +65,11 @@ RouteUpdateLogger::RouteUpdateLogger(
     std::unique_ptr<RouteLogger<folly::IPAddressV4>> routeLoggerV4,
     std::unique_ptr<RouteLogger<folly::IPAddressV6>> routeLoggerV6,
     std::unique_ptr<MplsRouteLogger> mplsRouteLogger)
-    : AutoRegisterStateObserver(sw, "RouteUpdateLogger"),
+    : AutoRegisterStateObserver(
+          sw,
+          "RouteUpdateLogger",
+          {} /* dependencies */,
+          true /* concurrent */),
       routeLoggerV4_(std::move(routeLoggerV4)),
       routeLoggerV6_(std::move(routeLoggerV6)),
       mplsRouteLogger_(std::move(mplsRouteLogger)) {}
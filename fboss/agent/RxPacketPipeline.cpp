@@ -0,0 +1,190 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/RxPacketPipeline.h"
+
+#include "fboss/agent/RxPacket.h"
+#include "fboss/agent/packet/Ethertype.h"
+#include "fboss/agent/packet/ICMPHdr.h"
+#include "fboss/agent/packet/IPProto.h"
+
+#include <fb303/ThreadCachedServiceData.h>
+#include <folly/Conv.h>
+#include <folly/io/Cursor.h>
+#include <folly/system/ThreadName.h>
+
+using facebook::fb303::SUM;
+using folly::io::Cursor;
+
+namespace {
+
+// Offsets in the IPv6 header
+constexpr size_t kIPv6NextHeaderOffset = 6;
+constexpr size_t kIPv6HeaderLength = 40;
+
+bool isNdp(Cursor cursor) {
+  using facebook::fboss::ICMPv6Type;
+  using facebook::fboss::IP_PROTO;
+
+  uint8_t nextHeader;
+  if (!cursor.tryAdvance(kIPv6NextHeaderOffset) ||
+      !cursor.tryRead<uint8_t>(nextHeader) ||
+      nextHeader != static_cast<uint8_t>(IP_PROTO::IP_PROTO_IPV6_ICMP)) {
+    return false;
+  }
+  uint8_t type;
+  if (!cursor.tryAdvance(kIPv6HeaderLength - kIPv6NextHeaderOffset - 1) ||
+      !cursor.tryRead<uint8_t>(type)) {
+    return false;
+  }
+  auto icmpType = static_cast<ICMPv6Type>(type);
+  return icmpType >= ICMPv6Type::ICMPV6_TYPE_NDP_ROUTER_SOLICITATION &&
+      icmpType <= ICMPv6Type::ICMPV6_TYPE_NDP_REDIRECT_MESSAGE;
+}
+
+} // namespace
+
+namespace facebook {
+namespace fboss {
+
+RxPacketPipeline::RxPacketPipeline(
+    uint32_t numThreads,
+    uint32_t queueSize,
+    PacketHandler handler)
+    : queueSize_(queueSize), handler_(std::move(handler)) {
+  for (size_t i = 0; i < kNumQueues; ++i) {
+    queues_[i].dropsCounter = folly::to<std::string>(
+        "rx_pipeline.", queueName(static_cast<Queue>(i)), ".drops");
+  }
+  for (uint32_t i = 0; i < numThreads; ++i) {
+    workers_.emplace_back([this, i]() {
+      folly::setThreadName(folly::to<std::string>("fbossRxPipeline", i));
+      workerLoop();
+    });
+  }
+}
+
+RxPacketPipeline::~RxPacketPipeline() {
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    stopping_ = true;
+  }
+  packetsQueued_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+bool RxPacketPipeline::enqueue(std::unique_ptr<RxPacket> pkt) {
+  auto& queue = queues_[static_cast<size_t>(classify(pkt.get()))];
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    if (queue.packets.size() >= queueSize_) {
+      ++queue.drops;
+    } else {
+      queue.packets.push_back(std::move(pkt));
+    }
+  }
+  if (pkt) {
+    fb303::ThreadCachedServiceData::get()->addStatValue(
+        queue.dropsCounter, 1, SUM);
+    return false;
+  }
+  packetsQueued_.notify_one();
+  return true;
+}
+
+RxPacketPipeline::Queue RxPacketPipeline::classify(const RxPacket* pkt) {
+  Cursor cursor(pkt->buf());
+  uint16_t ethertype;
+  // Skip over the destination and source MACs
+  if (!cursor.tryAdvance(12) || !cursor.tryReadBE<uint16_t>(ethertype)) {
+    return Queue::OTHER;
+  }
+  if (ethertype == static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_VLAN)) {
+    if (!cursor.tryAdvance(2) || !cursor.tryReadBE<uint16_t>(ethertype)) {
+      return Queue::OTHER;
+    }
+  }
+  switch (static_cast<ETHERTYPE>(ethertype)) {
+    case ETHERTYPE::ETHERTYPE_SLOW_PROTOCOLS:
+      return Queue::LACP;
+    case ETHERTYPE::ETHERTYPE_LLDP:
+      return Queue::LLDP;
+    case ETHERTYPE::ETHERTYPE_ARP:
+      return Queue::ARP;
+    case ETHERTYPE::ETHERTYPE_IPV4:
+      return Queue::IPV4;
+    case ETHERTYPE::ETHERTYPE_IPV6:
+      return isNdp(cursor) ? Queue::NDP : Queue::IPV6;
+    default:
+      return Queue::OTHER;
+  }
+}
+
+folly::StringPiece RxPacketPipeline::queueName(Queue queue) {
+  switch (queue) {
+    case Queue::LACP:
+      return "lacp";
+    case Queue::LLDP:
+      return "lldp";
+    case Queue::ARP:
+      return "arp";
+    case Queue::NDP:
+      return "ndp";
+    case Queue::IPV4:
+      return "ipv4";
+    case Queue::IPV6:
+      return "ipv6";
+    case Queue::OTHER:
+      return "other";
+  }
+  return "unknown";
+}
+
+uint64_t RxPacketPipeline::getDrops(Queue queue) const {
+  std::lock_guard<std::mutex> guard(lock_);
+  return queues_[static_cast<size_t>(queue)].drops;
+}
+
+RxPacketPipeline::PacketQueue* RxPacketPipeline::nextQueue() {
+  for (auto& queue : queues_) {
+    if (!queue.busy && !queue.packets.empty()) {
+      return &queue;
+    }
+  }
+  return nullptr;
+}
+
+void RxPacketPipeline::workerLoop() {
+  std::unique_lock<std::mutex> guard(lock_);
+  while (!stopping_) {
+    auto queue = nextQueue();
+    if (!queue) {
+      packetsQueued_.wait(guard);
+      continue;
+    }
+    auto pkt = std::move(queue->packets.front());
+    queue->packets.pop_front();
+    queue->busy = true;
+
+    guard.unlock();
+    handler_(std::move(pkt));
+    guard.lock();
+
+    queue->busy = false;
+    if (!queue->packets.empty()) {
+      // Other workers may have skipped this queue while we were busy with it
+      packetsQueued_.notify_one();
+    }
+  }
+}
+
+} // namespace fboss
+} // namespace facebook
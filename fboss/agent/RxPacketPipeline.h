@@ -0,0 +1,110 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/Range.h>
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace facebook {
+namespace fboss {
+
+class RxPacket;
+
+/*
+ * RxPacketPipeline moves the handling of trapped packets off the HwSwitch RX
+ * thread.
+ *
+ * Packets are sorted by protocol into bounded queues, and handled by a pool
+ * of worker threads. Queues are served in strict priority order: LACP and
+ * LLDP before ARP and NDP, before any other IP traffic. A flood of ARP
+ * requests therefore can't delay LACP and cause LAG flaps. Packets of a
+ * given queue are handled one at a time and in order, so handlers never see
+ * concurrent packets of their own protocol.
+ *
+ * Packets arriving at a full queue are dropped. Drops are exported in the
+ * rx_pipeline.<queue>.drops counters.
+ */
+class RxPacketPipeline {
+ public:
+  // In priority order
+  enum class Queue {
+    LACP,
+    LLDP,
+    ARP,
+    NDP,
+    IPV4,
+    IPV6,
+    OTHER,
+  };
+  static constexpr size_t kNumQueues = static_cast<size_t>(Queue::OTHER) + 1;
+
+  using PacketHandler = std::function<void(std::unique_ptr<RxPacket>)>;
+
+  /*
+   * Each queue holds up to queueSize packets. The handler must not throw.
+   */
+  RxPacketPipeline(
+      uint32_t numThreads,
+      uint32_t queueSize,
+      PacketHandler handler);
+  /*
+   * Waits for the packets being handled, and drops all the queued ones.
+   */
+  ~RxPacketPipeline();
+
+  /*
+   * Queues the packet for the worker threads. Returns false if the packet
+   * was dropped because its queue is full.
+   */
+  bool enqueue(std::unique_ptr<RxPacket> pkt);
+
+  static Queue classify(const RxPacket* pkt);
+  static folly::StringPiece queueName(Queue queue);
+
+  uint64_t getDrops(Queue queue) const;
+
+ private:
+  struct PacketQueue {
+    std::deque<std::unique_ptr<RxPacket>> packets;
+    // Whether a worker is handling a packet from this queue
+    bool busy{false};
+    uint64_t drops{0};
+    std::string dropsCounter;
+  };
+
+  // Forbidden copy constructor and assignment operator
+  RxPacketPipeline(RxPacketPipeline const&) = delete;
+  RxPacketPipeline& operator=(RxPacketPipeline const&) = delete;
+
+  void workerLoop();
+  // Highest priority queue with packets and no busy worker
+  PacketQueue* nextQueue();
+
+  const uint32_t queueSize_;
+  const PacketHandler handler_;
+
+  mutable std::mutex lock_;
+  std::condition_variable packetsQueued_;
+  std::array<PacketQueue, kNumQueues> queues_;
+  bool stopping_{false};
+  std::vector<std::thread> workers_;
+};
+
+} // namespace fboss
+} // namespace facebook
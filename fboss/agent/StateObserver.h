@@ -11,6 +11,9 @@
 
 #include <boost/core/noncopyable.hpp>
 
+#include <string>
+#include <vector>
+
 #include "fboss/agent/SwSwitch.h"
 #include "fboss/agent/state/StateDelta.h"
 
@@ -25,8 +28,16 @@ class StateObserver : public boost::noncopyable {
 
 class AutoRegisterStateObserver : public StateObserver {
  public:
-  AutoRegisterStateObserver(SwSwitch* sw, const std::string& name) : sw_(sw) {
-    sw_->registerStateObserver(this, name);
+  /*
+   * See SwSwitch::registerStateObserver() for dependencies and concurrent
+   */
+  AutoRegisterStateObserver(
+      SwSwitch* sw,
+      const std::string& name,
+      const std::vector<std::string>& dependencies = {},
+      bool concurrent = false)
+      : sw_(sw) {
+    sw_->registerStateObserver(this, name, dependencies, concurrent);
   }
   ~AutoRegisterStateObserver() override {
     sw_->unregisterStateObserver(this);
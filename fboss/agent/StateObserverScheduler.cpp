@@ -0,0 +1,209 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/StateObserverScheduler.h"
+
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/StateObserver.h"
+#include "fboss/agent/state/StateDelta.h"
+
+#include <fb303/ServiceData.h>
+#include <fb303/ThreadCachedServiceData.h>
+#include <folly/Conv.h>
+#include <folly/ExceptionString.h>
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
+#include <folly/futures/Future.h>
+#include <folly/futures/SharedPromise.h>
+#include <folly/logging/xlog.h>
+
+#include <chrono>
+#include <tuple>
+
+namespace {
+// Latency histogram buckets, in microseconds
+constexpr int64_t kLatencyBucketWidth = 1000;
+constexpr int64_t kLatencyMax = 1000000;
+} // namespace
+
+namespace facebook {
+namespace fboss {
+
+StateObserverScheduler::Observer::Observer(
+    std::string name,
+    std::vector<std::string> dependencies,
+    bool concurrent,
+    uint64_t registration)
+    : name(std::move(name)),
+      dependencies(std::move(dependencies)),
+      concurrent(concurrent),
+      registration(registration),
+      latencyHistogram(
+          folly::to<std::string>("state_observer.", this->name, ".us")) {
+  if (fb303::fbData->addHistogram(
+          latencyHistogram, kLatencyBucketWidth, 0, kLatencyMax)) {
+    fb303::fbData->exportHistogramPercentile(latencyHistogram, 50, 99);
+  }
+}
+
+StateObserverScheduler::StateObserverScheduler(uint32_t numThreads) {
+  if (numThreads > 0) {
+    executor_ = std::make_unique<folly::CPUThreadPoolExecutor>(
+        numThreads,
+        std::make_shared<folly::NamedThreadFactory>("StateObserver"));
+  }
+}
+
+StateObserverScheduler::~StateObserverScheduler() {}
+
+bool StateObserverScheduler::hasObserver(StateObserver* observer) const {
+  return observers_.find(observer) != observers_.end();
+}
+
+void StateObserverScheduler::addObserver(
+    StateObserver* observer,
+    const std::string& name,
+    const std::vector<std::string>& dependencies,
+    bool concurrent) {
+  if (hasObserver(observer)) {
+    throw FbossError("State observer add failed: ", name, " already exists");
+  }
+  observers_.emplace(
+      std::piecewise_construct,
+      std::forward_as_tuple(observer),
+      std::forward_as_tuple(
+          name, dependencies, concurrent, nextRegistration_++));
+  try {
+    schedule_ = computeSchedule();
+  } catch (const FbossError&) {
+    observers_.erase(observer);
+    throw;
+  }
+}
+
+void StateObserverScheduler::removeObserver(StateObserver* observer) {
+  auto nErased = observers_.erase(observer);
+  if (!nErased) {
+    throw FbossError("State observer remove failed: observer does not exist");
+  }
+  // Removing an observer can't create a cycle
+  schedule_ = computeSchedule();
+}
+
+std::vector<StateObserverScheduler::ScheduledObserver>
+StateObserverScheduler::computeSchedule() {
+  std::multimap<std::string, StateObserver*> observersByName;
+  for (const auto& [observer, info] : observers_) {
+    observersByName.emplace(info.name, observer);
+  }
+  auto forEachDependency = [&](const Observer& info, auto fn) {
+    for (const auto& name : info.dependencies) {
+      auto range = observersByName.equal_range(name);
+      for (auto it = range.first; it != range.second; ++it) {
+        fn(it->second);
+      }
+    }
+  };
+
+  // Topological sort, picking the earliest registered observer among those
+  // whose dependencies are all scheduled
+  std::map<StateObserver*, size_t> numPending;
+  std::multimap<StateObserver*, StateObserver*> dependents;
+  std::map<uint64_t, StateObserver*> ready;
+  for (const auto& [observer, info] : observers_) {
+    auto& pending = numPending[observer];
+    forEachDependency(info, [&](StateObserver* dependency) {
+      ++pending;
+      dependents.emplace(dependency, observer);
+    });
+    if (!pending) {
+      ready.emplace(info.registration, observer);
+    }
+  }
+
+  std::vector<ScheduledObserver> schedule;
+  std::map<StateObserver*, size_t> scheduleIndex;
+  while (!ready.empty()) {
+    auto observer = ready.begin()->second;
+    ready.erase(ready.begin());
+    auto& info = observers_.at(observer);
+
+    ScheduledObserver scheduled{observer, &info, {}};
+    forEachDependency(info, [&](StateObserver* dependency) {
+      scheduled.dependencies.push_back(scheduleIndex.at(dependency));
+    });
+    scheduleIndex.emplace(observer, schedule.size());
+    schedule.push_back(std::move(scheduled));
+
+    auto range = dependents.equal_range(observer);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (--numPending[it->second] == 0) {
+        ready.emplace(observers_.at(it->second).registration, it->second);
+      }
+    }
+  }
+  if (schedule.size() != observers_.size()) {
+    throw FbossError("State observers have cyclic dependencies");
+  }
+  return schedule;
+}
+
+void StateObserverScheduler::notify(const StateDelta& delta) {
+  if (!executor_) {
+    for (const auto& scheduled : schedule_) {
+      notifyObserver(scheduled, delta);
+    }
+    return;
+  }
+
+  // schedule_ is in dependency order, so every observer's dependencies have
+  // been started (or are done) by the time we get to it
+  std::vector<folly::SharedPromise<folly::Unit>> notified(schedule_.size());
+  std::vector<folly::Future<folly::Unit>> concurrentObservers;
+  for (size_t i = 0; i < schedule_.size(); ++i) {
+    const auto& scheduled = schedule_[i];
+    std::vector<folly::Future<folly::Unit>> dependencies;
+    for (auto dependency : scheduled.dependencies) {
+      dependencies.push_back(notified[dependency].getFuture());
+    }
+    if (scheduled.info->concurrent) {
+      concurrentObservers.push_back(
+          folly::collectAll(std::move(dependencies))
+              .via(executor_.get())
+              .thenValue([this, i, &delta, &notified](auto&& /*unused*/) {
+                notifyObserver(schedule_[i], delta);
+                notified[i].setValue();
+              }));
+    } else {
+      folly::collectAll(std::move(dependencies)).wait();
+      notifyObserver(scheduled, delta);
+      notified[i].setValue();
+    }
+  }
+  folly::collectAll(std::move(concurrentObservers)).wait();
+}
+
+void StateObserverScheduler::notifyObserver(
+    const ScheduledObserver& scheduled,
+    const StateDelta& delta) const {
+  auto start = std::chrono::steady_clock::now();
+  try {
+    scheduled.observer->stateUpdated(delta);
+  } catch (const std::exception& ex) {
+    // TODO: Figure out the best way to handle errors here.
+    XLOG(FATAL) << "error notifying " << scheduled.info->name
+                << " of update: " << folly::exceptionStr(ex);
+  }
+  auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  fb303::ThreadCachedServiceData::get()->addHistogramValue(
+      scheduled.info->latencyHistogram, duration.count());
+}
+
+} // namespace fboss
+} // namespace facebook
@@ -0,0 +1,102 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/executors/CPUThreadPoolExecutor.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace facebook {
+namespace fboss {
+
+class StateDelta;
+class StateObserver;
+
+/*
+ * StateObserverScheduler notifies the registered StateObservers of each
+ * state update.
+ *
+ * Observers may name the observers that must be done with an update before
+ * they are notified of it. Observers registered as concurrent are notified
+ * on a thread pool, possibly at the same time as other observers. All the
+ * others are notified on the thread calling notify(), i.e. the update
+ * thread. notify() returns once every observer is done, so all observers
+ * are done with an update before being notified of the next one.
+ *
+ * The time each observer spends handling updates is exported in the
+ * state_observer.<name>.us histogram.
+ *
+ * The scheduler itself is not thread safe, it should only be used from the
+ * update thread.
+ */
+class StateObserverScheduler {
+ public:
+  /*
+   * numThreads is the size of the pool notifying concurrent observers. With
+   * no threads all the observers are notified on the update thread.
+   */
+  explicit StateObserverScheduler(uint32_t numThreads);
+  ~StateObserverScheduler();
+
+  bool hasObserver(StateObserver* observer) const;
+  /*
+   * Dependencies that are not registered are ignored. Throws FbossError if
+   * the observer is already registered or if its dependencies form a cycle.
+   */
+  void addObserver(
+      StateObserver* observer,
+      const std::string& name,
+      const std::vector<std::string>& dependencies,
+      bool concurrent);
+  void removeObserver(StateObserver* observer);
+
+  void notify(const StateDelta& delta);
+
+ private:
+  struct Observer {
+    Observer(
+        std::string name,
+        std::vector<std::string> dependencies,
+        bool concurrent,
+        uint64_t registration);
+
+    std::string name;
+    std::vector<std::string> dependencies;
+    bool concurrent;
+    // Observers with no dependencies between them are notified in
+    // registration order
+    uint64_t registration;
+    std::string latencyHistogram;
+  };
+
+  struct ScheduledObserver {
+    StateObserver* observer;
+    Observer* info;
+    // Indices of the observers to wait for in schedule_
+    std::vector<size_t> dependencies;
+  };
+
+  // Orders the observers so that they come after their dependencies
+  std::vector<ScheduledObserver> computeSchedule();
+  void notifyObserver(
+      const ScheduledObserver& scheduled,
+      const StateDelta& delta) const;
+
+  uint64_t nextRegistration_{0};
+  std::map<StateObserver*, Observer> observers_;
+  std::vector<ScheduledObserver> schedule_;
+  std::unique_ptr<folly::CPUThreadPoolExecutor> executor_;
+};
+
+} // namespace fboss
+} // namespace facebook
@@ -34,6 +34,8 @@
 #include "fboss/agent/RestartTimeTracker.h"
 #include "fboss/agent/RouteUpdateLogger.h"
 #include "fboss/agent/RxPacket.h"
+#include "fboss/agent/RxPacketPipeline.h"
+#include "fboss/agent/StateObserverScheduler.h"
 #include "fboss/agent/SwitchStats.h"
 #include "fboss/agent/ThriftHandler.h"
 #include "fboss/agent/TunManager.h"
@@ -42,6 +44,7 @@
 #include "fboss/agent/capture/PktCaptureManager.h"
 #include "fboss/agent/gen-cpp2/switch_config_types_custom_protocol.h"
 #include "fboss/agent/packet/EthHdr.h"
+#include "fboss/agent/packet/HdrViews.h"
 #include "fboss/agent/packet/IPv4Hdr.h"
 #include "fboss/agent/packet/IPv6Hdr.h"
 #include "fboss/agent/packet/PktUtil.h"
@@ -68,10 +71,13 @@
 #include <thrift/lib/cpp2/async/RequestChannel.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
+#include <algorithm>
 #include <chrono>
 #include <condition_variable>
 #include <exception>
 #include <tuple>
+#include <unordered_set>
+#include <utility>
 
 using folly::EventBase;
 using folly::SocketAddress;
@@ -99,6 +105,34 @@ DEFINE_int32(
     distribution_timeout_ms,
     1000,
     "Timeout for sending to distribution_service (ms)");
+DEFINE_uint32(
+    state_observer_threads,
+    4,
+    "Number of threads notifying concurrent state observers of state "
+    "updates. With 0 threads all observers are notified on the update thread");
+DEFINE_uint32(
+    state_update_traces,
+    100,
+    "Number of state update traces kept for getStateUpdateTraces()");
+DEFINE_uint32(
+    state_update_coalescing_window_ms,
+    0,
+    "During bursts of state updates, hold back updates arriving within this "
+    "window of the previous one so that they get applied together. 0 applies "
+    "every update as soon as possible");
+DEFINE_uint32(
+    state_update_max_batch_size,
+    0,
+    "Maximum number of state updates applied together, 0 for no limit");
+DEFINE_uint32(
+    rx_pipeline_threads,
+    0,
+    "Number of threads handling trapped packets. With 0 threads packets are "
+    "handled on the HwSwitch RX thread");
+DEFINE_uint32(
+    rx_pipeline_queue_size,
+    1024,
+    "Maximum number of trapped packets queued per protocol before dropping");
 
 namespace {
 
@@ -163,6 +197,8 @@ class ChannelCloser : public CloseCallback {
 SwSwitch::SwSwitch(std::unique_ptr<Platform> platform)
     : hw_(platform->getHwSwitch()),
       platform_(std::move(platform)),
+      stateObservers_(std::make_unique<StateObserverScheduler>(
+          FLAGS_state_observer_threads)),
       closer_(new ChannelCloser(this)),
       arp_(new ArpHandler(this)),
       ipv4_(new IPv4Handler(this)),
@@ -184,6 +220,15 @@ SwSwitch::SwSwitch(std::unique_ptr<Platform> platform)
 
   // doesnt need to be guarded, only accessed by 1 event base
   pcapPusher_ = nullptr;
+
+  if (FLAGS_rx_pipeline_threads > 0) {
+    rxPipeline_ = std::make_unique<RxPacketPipeline>(
+        FLAGS_rx_pipeline_threads,
+        FLAGS_rx_pipeline_queue_size,
+        [this](std::unique_ptr<RxPacket> pkt) {
+          handlePacketNoThrow(std::move(pkt));
+        });
+  }
 }
 
 void SwSwitch::destroyPushClient() {
@@ -225,6 +270,9 @@ void SwSwitch::stop() {
   // while we are destroying ourselves
   hw_->unregisterCallbacks();
 
+  // Wait for the packets being handled, and drop the ones still queued
+  rxPipeline_.reset();
+
   // Stop tunMgr so we don't get any packets to process
   // in software that were sent to the switch ip or were
   // routed from kernel to the front panel tunnel interface.
@@ -632,10 +680,13 @@ void SwSwitch::fibSynced() {
 
 void SwSwitch::registerStateObserver(
     StateObserver* observer,
-    const string name) {
+    const string name,
+    const std::vector<std::string>& dependencies,
+    bool concurrent) {
   XLOG(DBG2) << "Registering state observer: " << name;
-  updateEventBase_.runImmediatelyOrRunInEventBaseThreadAndWait(
-      [=]() { addStateObserver(observer, name); });
+  updateEventBase_.runImmediatelyOrRunInEventBaseThreadAndWait([=]() {
+    addStateObserver(observer, name, dependencies, concurrent);
+  });
 }
 
 void SwSwitch::unregisterStateObserver(StateObserver* observer) {
@@ -645,23 +696,21 @@ void SwSwitch::unregisterStateObserver(StateObserver* observer) {
 
 bool SwSwitch::stateObserverRegistered(StateObserver* observer) {
   DCHECK(updateEventBase_.isInEventBaseThread());
-  return stateObservers_.find(observer) != stateObservers_.end();
+  return stateObservers_->hasObserver(observer);
 }
 
 void SwSwitch::removeStateObserver(StateObserver* observer) {
   DCHECK(updateEventBase_.isInEventBaseThread());
-  auto nErased = stateObservers_.erase(observer);
-  if (!nErased) {
-    throw FbossError("State observer remove failed: observer does not exist");
-  }
+  stateObservers_->removeObserver(observer);
 }
 
-void SwSwitch::addStateObserver(StateObserver* observer, const string& name) {
+void SwSwitch::addStateObserver(
+    StateObserver* observer,
+    const string& name,
+    const std::vector<std::string>& dependencies,
+    bool concurrent) {
   DCHECK(updateEventBase_.isInEventBaseThread());
-  if (stateObserverRegistered(observer)) {
-    throw FbossError("State observer add failed: ", name, " already exists");
-  }
-  stateObservers_.emplace(observer, name);
+  stateObservers_->addObserver(observer, name, dependencies, concurrent);
 }
 
 void SwSwitch::notifyStateObservers(const StateDelta& delta) {
@@ -670,16 +719,7 @@ void SwSwitch::notifyStateObservers(const StateDelta& delta) {
     // Make sure the SwSwitch is not already being destroyed
     return;
   }
-  for (auto observerName : stateObservers_) {
-    try {
-      auto observer = observerName.first;
-      observer->stateUpdated(delta);
-    } catch (const std::exception& ex) {
-      // TODO: Figure out the best way to handle errors here.
-      XLOG(FATAL) << "error notifying " << observerName.second
-                  << " of update: " << folly::exceptionStr(ex);
-    }
-  }
+  stateObservers_->notify(delta);
 }
 
 void SwSwitch::updateState(unique_ptr<StateUpdate> update) {
@@ -729,6 +769,16 @@ void SwSwitch::updateStateNoCoalescing(StringPiece name, StateUpdateFn fn) {
   updateState(std::move(update));
 }
 
+void SwSwitch::updateStateNoCoalescing(
+    StringPiece name,
+    StateUpdateFn fn,
+    StringPiece mergeKey) {
+  DCHECK(!mergeKey.empty());
+  auto update =
+      make_unique<FunctionStateUpdate>(name, std::move(fn), false, mergeKey);
+  updateState(std::move(update));
+}
+
 void SwSwitch::updateStateBlocking(folly::StringPiece name, StateUpdateFn fn) {
   auto result = std::make_shared<BlockingUpdateResult>();
   auto update = make_unique<BlockingStateUpdate>(name, std::move(fn), result);
@@ -740,7 +790,53 @@ void SwSwitch::handlePendingUpdatesHelper(SwSwitch* sw) {
   sw->handlePendingUpdates();
 }
 
-void SwSwitch::handlePendingUpdates() {
+bool SwSwitch::deferPendingUpdates() {
+  if (deferredUpdateCalls_ > 0) {
+    // The updates are already held back
+    ++deferredUpdateCalls_;
+    return true;
+  }
+  std::chrono::milliseconds window(FLAGS_state_update_coalescing_window_ms);
+  if (window.count() == 0 ||
+      std::chrono::steady_clock::now() - lastUpdateApplied_ >= window) {
+    // Not in a burst of updates, apply them right away
+    return false;
+  }
+  if (FLAGS_state_update_max_batch_size > 0) {
+    // No point in waiting if we already have a full batch
+    folly::SpinLockGuard guard(pendingUpdatesLock_);
+    uint32_t numPending = 0;
+    for (auto iter = pendingUpdates_.begin();
+         iter != pendingUpdates_.end() &&
+         numPending < FLAGS_state_update_max_batch_size;
+         ++iter) {
+      ++numPending;
+    }
+    if (numPending >= FLAGS_state_update_max_batch_size) {
+      return false;
+    }
+  }
+  ++deferredUpdateCalls_;
+  stats()->stateUpdatesDeferred();
+  updateEventBase_.runAfterDelay(
+      [this]() { handleDeferredUpdates(); }, window.count());
+  return true;
+}
+
+void SwSwitch::handleDeferredUpdates() {
+  // Make up for the handlePendingUpdates() calls we held back. Most of them
+  // will find nothing left to do.
+  auto calls = std::exchange(deferredUpdateCalls_, 0);
+  for (uint32_t i = 0; i < calls; ++i) {
+    handlePendingUpdates(false /* mayDefer */);
+  }
+}
+
+void SwSwitch::handlePendingUpdates(bool mayDefer) {
+  if (mayDefer && deferPendingUpdates()) {
+    return;
+  }
+
   // Get the list of updates to run.
   //
   // We might pull multiple updates off the list at once if several updates
@@ -748,17 +844,32 @@ void SwSwitch::handlePendingUpdates() {
   // might also end up finding 0 updates to process if a previous
   // handlePendingUpdates() call processed multiple updates.
   StateUpdateList updates;
+  uint32_t numMerged = 0;
   {
     folly::SpinLockGuard guard(pendingUpdatesLock_);
     // When deciding how many elements to pull off the pendingUpdates_
-    // list, we pull as many as we can, while making sure we don't
-    // include any updates after an update that does not allow
-    // coalescing.
+    // list, we pull as many as we can (up to the max batch size), while
+    // making sure we don't include any updates after an update that does not
+    // allow coalescing. The only exception are mergeable updates, which may
+    // be followed by more mergeable updates with different merge keys.
+    std::unordered_set<std::string> mergeKeys;
+    uint32_t numUpdates = 0;
     auto iter = pendingUpdates_.begin();
-    while (iter != pendingUpdates_.end()) {
+    while (iter != pendingUpdates_.end() &&
+           (FLAGS_state_update_max_batch_size == 0 ||
+            numUpdates < FLAGS_state_update_max_batch_size)) {
       StateUpdate* update = &(*iter);
+      if (update->isMergeable()) {
+        if (!mergeKeys.insert(update->getMergeKey()).second) {
+          break;
+        }
+        ++numMerged;
+      } else if (!mergeKeys.empty()) {
+        break;
+      }
       ++iter;
-      if (!update->allowsCoalescing()) {
+      ++numUpdates;
+      if (!update->allowsCoalescing() && !update->isMergeable()) {
         break;
       }
     }
@@ -787,15 +898,28 @@ void SwSwitch::handlePendingUpdates() {
   // queue whenever applied and desired states diverge. After that, other
   // supplied state updates are applied (that were spliced above).
   auto newDesiredState = oldAppliedState;
+  StateUpdateTrace trace;
+  trace.name = updates.front().getName();
+  trace.startTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::system_clock::now().time_since_epoch())
+                          .count();
+  auto start = std::chrono::steady_clock::now();
+  std::chrono::microseconds updateFnsDuration{0};
+  std::chrono::microseconds publishDuration{0};
   auto iter = updates.begin();
   while (iter != updates.end()) {
     StateUpdate* update = &(*iter);
     ++iter;
+    ++trace.coalescedUpdates;
 
     shared_ptr<SwitchState> intermediateState;
     XLOG(INFO) << "preparing state update " << update->getName();
+    auto updateFnStart = std::chrono::steady_clock::now();
     try {
       intermediateState = update->applyUpdate(newDesiredState);
+      updateFnsDuration +=
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - updateFnStart);
     } catch (const std::exception& ex) {
       // Call the update's onError() function, and then immediately delete
       // it (therefore removing it from the intrusive list).  This way we won't
@@ -811,15 +935,27 @@ void SwSwitch::handlePendingUpdates() {
       // making any changes.  This ensures that if a StateUpdate function
       // ever fails partway through it can't have partially modified our
       // existing state, leaving it in an invalid state.
+      auto publishStart = std::chrono::steady_clock::now();
       intermediateState->publish();
+      publishDuration += std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - publishStart);
       newDesiredState = intermediateState;
     }
   }
+  trace.updateFnsUs = updateFnsDuration.count();
+  trace.publishUs = publishDuration.count();
+  stats()->stateUpdateFns(updateFnsDuration);
+  stats()->stateUpdatePublish(publishDuration);
+  stats()->stateUpdatesCoalesced(trace.coalescedUpdates);
+  if (numMerged > 0) {
+    stats()->stateUpdatesMerged(numMerged);
+  }
 
   // Now apply the update and notify subscribers
   if (newDesiredState != oldAppliedState) {
     // There was some change during these state updates
-    auto newAppliedState = applyUpdate(oldAppliedState, newDesiredState);
+    auto newAppliedState =
+        applyUpdate(oldAppliedState, newDesiredState, &trace);
     // Stick the initial applied->desired in the beginning
     bool newOutOfSync = (newAppliedState != newDesiredState);
     fb303::fbData->setCounter("hw_out_of_sync", newOutOfSync);
@@ -840,6 +976,12 @@ void SwSwitch::handlePendingUpdates() {
     }
   }
 
+  trace.totalUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  recordStateUpdateTrace(std::move(trace));
+  lastUpdateApplied_ = std::chrono::steady_clock::now();
+
   // Notify all of the updates of success, and delete them. Success is defined
   // as SwSwitch's attempt to apply them to hw, even though they might have not
   // actually been applied yet.
@@ -871,9 +1013,26 @@ void SwSwitch::setDesiredState(std::shared_ptr<SwitchState> newDesiredState) {
   desiredStateDontUseDirectly_.swap(newDesiredState);
 }
 
+void SwSwitch::recordStateUpdateTrace(StateUpdateTrace trace) {
+  auto traces = stateUpdateTraces_.wlock();
+  traces->push_front(std::move(trace));
+  while (traces->size() > FLAGS_state_update_traces) {
+    traces->pop_back();
+  }
+}
+
+std::vector<StateUpdateTrace> SwSwitch::getStateUpdateTraces(
+    size_t count) const {
+  auto traces = stateUpdateTraces_.rlock();
+  count = std::min(count, traces->size());
+  return std::vector<StateUpdateTrace>(
+      traces->begin(), traces->begin() + count);
+}
+
 std::shared_ptr<SwitchState> SwSwitch::applyUpdate(
     const shared_ptr<SwitchState>& oldState,
-    const shared_ptr<SwitchState>& newState) {
+    const shared_ptr<SwitchState>& newState,
+    StateUpdateTrace* trace) {
   // Check that we are starting from what has been already applied
   DCHECK_EQ(oldState, getAppliedState());
 
@@ -883,6 +1042,7 @@ std::shared_ptr<SwitchState> SwSwitch::applyUpdate(
   DCHECK_GT(newState->getGeneration(), oldState->getGeneration());
 
   StateDelta delta(oldState, newState);
+  auto deltaEnd = std::chrono::steady_clock::now();
 
   // If we are already exiting, abort the update
   if (isExiting()) {
@@ -914,6 +1074,7 @@ std::shared_ptr<SwitchState> SwSwitch::applyUpdate(
     XLOG(FATAL) << "error applying state change to hardware: "
                 << folly::exceptionStr(ex);
   }
+  auto hwEnd = std::chrono::steady_clock::now();
 
   setStateInternal(newAppliedState, newState);
 
@@ -921,12 +1082,28 @@ std::shared_ptr<SwitchState> SwSwitch::applyUpdate(
   // the state changed to "desired state", even if the whole state might not
   // have been applied yet. If an observer wants to know the applied state,
   // they can query the SwSwitch about it.
+  auto observersStart = std::chrono::steady_clock::now();
   notifyStateObservers(delta);
 
   auto end = std::chrono::steady_clock::now();
   auto duration =
       std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+  auto deltaDuration =
+      std::chrono::duration_cast<std::chrono::microseconds>(deltaEnd - start);
+  auto hwDuration =
+      std::chrono::duration_cast<std::chrono::microseconds>(hwEnd - deltaEnd);
+  auto observersDuration =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          end - observersStart);
   stats()->stateUpdate(duration);
+  stats()->stateUpdateDelta(deltaDuration);
+  stats()->stateUpdateHw(hwDuration);
+  stats()->stateUpdateObservers(observersDuration);
+  if (trace) {
+    trace->deltaUs = deltaDuration.count();
+    trace->hwUs = hwDuration.count();
+    trace->observersUs = observersDuration.count();
+  }
   XLOG(DBG0) << "Update state took " << duration.count() << "us";
   return newAppliedState;
 }
@@ -983,9 +1160,41 @@ void SwSwitch::setPortStatusCounter(PortID port, bool up) {
 }
 
 void SwSwitch::packetReceived(std::unique_ptr<RxPacket> pkt) noexcept {
+  if (rxPipeline_) {
+    PortID port = pkt->getSrcPort();
+    if (!rxPipeline_->enqueue(std::move(pkt))) {
+      portStats(port)->pktDropped();
+    }
+    return;
+  }
+  handlePacketNoThrow(std::move(pkt));
+}
+
+void SwSwitch::packetsReceived(
+    folly::Range<std::unique_ptr<RxPacket>*> pkts) noexcept {
+  if (rxPipeline_) {
+    for (auto& pkt : pkts) {
+      packetReceived(std::move(pkt));
+    }
+    return;
+  }
+  // Do the checks and accounting common to all the packets once per batch
+  if (!isFullyInitialized()) {
+    XLOG(DBG3) << "Dropping received packets received on UNINITIALIZED switch";
+    return;
+  }
+  stats()->trappedPkts(pkts.size());
+  for (auto& pkt : pkts) {
+    handlePacketNoThrow(std::move(pkt), true /* batched */);
+  }
+}
+
+void SwSwitch::handlePacketNoThrow(
+    std::unique_ptr<RxPacket> pkt,
+    bool batched) noexcept {
   PortID port = pkt->getSrcPort();
   try {
-    handlePacket(std::move(pkt));
+    handlePacket(std::move(pkt), batched);
   } catch (const std::exception& ex) {
     portStats(port)->pktError();
     XLOG(ERR) << "error processing trapped packet: " << folly::exceptionStr(ex);
@@ -999,16 +1208,20 @@ void SwSwitch::packetReceivedThrowExceptionOnError(
   handlePacket(std::move(pkt));
 }
 
-void SwSwitch::handlePacket(std::unique_ptr<RxPacket> pkt) {
-  // If we are not fully initialized or are already exiting, don't handle
-  // packets since the individual handlers, h/w sdk data structures
-  // may not be ready or may already be (partially) destroyed
-  if (!isFullyInitialized()) {
-    XLOG(DBG3) << "Dropping received packets received on UNINITIALIZED switch";
-    return;
-  }
+void SwSwitch::handlePacket(std::unique_ptr<RxPacket> pkt, bool batched) {
   PortID port = pkt->getSrcPort();
-  portStats(port)->trappedPkt();
+  // Batched packets were already checked and counted by packetsReceived()
+  if (!batched) {
+    // If we are not fully initialized or are already exiting, don't handle
+    // packets since the individual handlers, h/w sdk data structures
+    // may not be ready or may already be (partially) destroyed
+    if (!isFullyInitialized()) {
+      XLOG(DBG3)
+          << "Dropping received packets received on UNINITIALIZED switch";
+      return;
+    }
+    portStats(port)->trappedPkt();
+  }
 
   pcapMgr_->packetReceived(pkt.get());
 
@@ -1020,16 +1233,14 @@ void SwSwitch::handlePacket(std::unique_ptr<RxPacket> pkt) {
     return;
   }
 
-  // Parse the source and destination MAC, as well as the ethertype.
+  // Parse the source and destination MAC, as well as the ethertype. The VLAN
+  // tag, if any, is skipped over: we ignore it for now.
   Cursor c(pkt->buf());
-  auto dstMac = PktUtil::readMac(&c);
-  auto srcMac = PktUtil::readMac(&c);
-  auto ethertype = c.readBE<uint16_t>();
-  if (ethertype == 0x8100) {
-    // 802.1Q
-    c += 2; // Advance over the VLAN tag.  We ignore it for now
-    ethertype = c.readBE<uint16_t>();
-  }
+  EthHdrView::Scratch ethScratch;
+  auto ethHdr = EthHdrView::parse(&c, &ethScratch);
+  auto dstMac = ethHdr.dstAddr();
+  auto srcMac = ethHdr.srcAddr();
+  auto ethertype = ethHdr.etherType();
 
   if (distributionServiceReady_.load()) {
     publishRxPacket(pkt.get(), ethertype);
@@ -1107,7 +1318,9 @@ void SwSwitch::linkStateChanged(PortID portId, bool up) {
     return newState;
   };
   updateStateNoCoalescing(
-      "Port OperState Update", std::move(updateOperStateFn));
+      "Port OperState Update",
+      std::move(updateOperStateFn),
+      folly::to<std::string>("port ", portId, " oper state"));
 
   // Log event and update counters
   logLinkStateEvent(portId, up);
@@ -21,11 +21,14 @@
 #include <folly/IntrusiveList.h>
 #include <folly/Range.h>
 #include <folly/SpinLock.h>
+#include <folly/Synchronized.h>
 #include <folly/ThreadLocal.h>
 #include <folly/io/async/EventBase.h>
 #include <optional>
 
 #include <atomic>
+#include <chrono>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -48,12 +51,14 @@ class PortDescriptor;
 class PortStats;
 class PortUpdateHandler;
 class RxPacket;
+class RxPacketPipeline;
 class SwitchState;
 class SwitchStats;
 class StateDelta;
 class NeighborUpdater;
 class RouteUpdateLogger;
 class StateObserver;
+class StateObserverScheduler;
 class TunManager;
 class MirrorManager;
 class LookupClassUpdater;
@@ -249,6 +254,19 @@ class SwSwitch : public HwSwitch::Callback {
    */
   void updateStateNoCoalescing(folly::StringPiece name, StateUpdateFn fn);
 
+  /**
+   * A version of updateStateNoCoalescing() for updates which only need to be
+   * seen by the hw implementation before later updates with the same
+   * mergeKey, e.g. the oper state changes of a single port. Consecutive
+   * updates with different merge keys may be sent to the hw implementation
+   * together, which keeps bursts (say a linecard flap) from requiring one hw
+   * update per event. Each update still fails or succeeds on its own.
+   */
+  void updateStateNoCoalescing(
+      folly::StringPiece name,
+      StateUpdateFn fn,
+      folly::StringPiece mergeKey);
+
   /*
    * A version of updateState() that doesn't return until the update has been
    * applied.
@@ -279,10 +297,21 @@ class SwSwitch : public HwSwitch::Callback {
    * all state updates that occur and all classes that care about state updates
    * should register using this api.
    *
-   * The only required method for observers is stateUpdated and observers can
-   * count on this always being called from the update thread.
-   */
-  void registerStateObserver(StateObserver* observer, const std::string name);
+   * The only required method for observers is stateUpdated. Observers can
+   * count on it being called from the update thread, unless they register
+   * as concurrent: concurrent observers may be notified on a thread pool (see
+   * --state_observer_threads), at the same time as other observers. All
+   * observers are done with a state update before being notified of the
+   * next one.
+   *
+   * The observers named in dependencies are done with a state update before
+   * this observer is notified of it.
+   */
+  void registerStateObserver(
+      StateObserver* observer,
+      const std::string name,
+      const std::vector<std::string>& dependencies = {},
+      bool concurrent = false);
   void unregisterStateObserver(StateObserver* observer);
 
   /*
@@ -419,6 +448,8 @@ class SwSwitch : public HwSwitch::Callback {
 
   // HwSwitch::Callback methods
   void packetReceived(std::unique_ptr<RxPacket> pkt) noexcept override;
+  void packetsReceived(
+      folly::Range<std::unique_ptr<RxPacket>*> pkts) noexcept override;
   void linkStateChanged(PortID port, bool up) override;
   void l2LearningUpdateReceived(
       L2Entry l2Entry,
@@ -531,6 +562,14 @@ class SwSwitch : public HwSwitch::Callback {
     return nUpdater_.get();
   }
 
+  /*
+   * The pipeline handling trapped packets, or nullptr when they are handled
+   * on the HwSwitch RX thread (--rx_pipeline_threads=0).
+   */
+  const RxPacketPipeline* getRxPacketPipeline() const {
+    return rxPipeline_.get();
+  }
+
   /*
    * Get the PktCaptureManager object.
    */
@@ -663,6 +702,12 @@ class SwSwitch : public HwSwitch::Callback {
   void clearPortStats(const std::unique_ptr<std::vector<int32_t>>& ports);
   SwitchRunState getSwitchRunState() const;
 
+  /*
+   * Traces of the last (up to count) state updates, most recent first. Only
+   * the last FLAGS_state_update_traces updates are kept.
+   */
+  std::vector<StateUpdateTrace> getStateUpdateTraces(size_t count) const;
+
   template <typename AddressT>
   std::shared_ptr<Route<AddressT>> longestMatch(
       std::shared_ptr<SwitchState> state,
@@ -707,13 +752,29 @@ class SwSwitch : public HwSwitch::Callback {
   void publishSwitchInfo(struct HwInitResult hwInitRet);
   void setSwitchRunState(SwitchRunState desiredState);
   SwitchStats* createSwitchStats();
-  void handlePacket(std::unique_ptr<RxPacket> pkt);
+  void handlePacket(std::unique_ptr<RxPacket> pkt, bool batched = false);
+  void handlePacketNoThrow(
+      std::unique_ptr<RxPacket> pkt,
+      bool batched = false) noexcept;
 
   static void handlePendingUpdatesHelper(SwSwitch* sw);
-  void handlePendingUpdates();
+  /*
+   * If mayDefer is set, updates arriving within
+   * FLAGS_state_update_coalescing_window_ms of the previous update may be
+   * held back to be applied together with the updates following them.
+   */
+  void handlePendingUpdates(bool mayDefer = true);
+  bool deferPendingUpdates();
+  void handleDeferredUpdates();
+  /*
+   * If trace is not null, the time spent computing the delta, programming the
+   * hardware and notifying the observers is recorded in it.
+   */
   std::shared_ptr<SwitchState> applyUpdate(
       const std::shared_ptr<SwitchState>& oldState,
-      const std::shared_ptr<SwitchState>& newState);
+      const std::shared_ptr<SwitchState>& newState,
+      StateUpdateTrace* trace = nullptr);
+  void recordStateUpdateTrace(StateUpdateTrace trace);
 
   void startThreads();
   void stopThreads();
@@ -725,7 +786,11 @@ class SwSwitch : public HwSwitch::Callback {
    * called from the update thread, if the update thread is running.
    */
   bool stateObserverRegistered(StateObserver* observer);
-  void addStateObserver(StateObserver* observer, const std::string& name);
+  void addStateObserver(
+      StateObserver* observer,
+      const std::string& name,
+      const std::vector<std::string>& dependencies,
+      bool concurrent);
   void removeStateObserver(StateObserver* observer);
 
   /*
@@ -771,6 +836,19 @@ class SwSwitch : public HwSwitch::Callback {
   folly::SpinLock pendingUpdatesLock_;
   StateUpdateList pendingUpdates_;
 
+  /*
+   * Number of handlePendingUpdates() calls held back until the coalescing
+   * window expires, and the time the last updates were applied. Only
+   * accessed from the update thread.
+   */
+  uint32_t deferredUpdateCalls_{0};
+  std::chrono::steady_clock::time_point lastUpdateApplied_;
+
+  /*
+   * Traces of the last state updates, most recent first.
+   */
+  folly::Synchronized<std::deque<StateUpdateTrace>> stateUpdateTraces_;
+
   /*
    * The current switch state: modelled as two states:
    *
@@ -850,11 +928,11 @@ class SwSwitch : public HwSwitch::Callback {
       neighborListener_{nullptr};
 
   /*
-   * The list of classes to notify on a state update. This container should only
-   * be accessed/modified from the update thread. This removes the need for
-   * locking when we access the container during a state update.
+   * The classes to notify on a state update. The scheduler should only be
+   * accessed/modified from the update thread. This removes the need for
+   * locking when we access it during a state update.
    */
-  std::map<StateObserver*, std::string> stateObservers_;
+  std::unique_ptr<StateObserverScheduler> stateObservers_;
 
   std::unique_ptr<ChannelCloser> closer_; // must be before pcapPusher_
   std::unique_ptr<PcapPushSubscriberAsyncClient> pcapPusher_;
@@ -865,6 +943,11 @@ class SwSwitch : public HwSwitch::Callback {
   std::unique_ptr<IPv6Handler> ipv6_;
   std::unique_ptr<NeighborUpdater> nUpdater_;
   std::unique_ptr<PktCaptureManager> pcapMgr_;
+  /*
+   * Hands trapped packets to worker threads, null if packets are handled
+   * on the HwSwitch RX thread.
+   */
+  std::unique_ptr<RxPacketPipeline> rxPipeline_;
   std::unique_ptr<MirrorManager> mirrorManager_;
   std::unique_ptr<RouteUpdateLogger> routeUpdateLogger_;
   std::unique_ptr<LinkAggregationManager> lagManager_;
@@ -80,6 +80,53 @@ SwitchStats::SwitchStats(ThreadLocalStatsMap* map)
           SUM,
           RATE),
       updateState_(map, kCounterPrefix + "state_update.us", 50000, 0, 1000000),
+      updateStateFns_(
+          map,
+          kCounterPrefix + "state_update.update_fns.us",
+          50000,
+          0,
+          1000000),
+      updateStatePublish_(
+          map,
+          kCounterPrefix + "state_update.publish.us",
+          1000,
+          0,
+          100000),
+      updateStateDelta_(
+          map,
+          kCounterPrefix + "state_update.delta.us",
+          1000,
+          0,
+          100000),
+      updateStateHw_(
+          map,
+          kCounterPrefix + "state_update.hw.us",
+          50000,
+          0,
+          1000000),
+      updateStateObservers_(
+          map,
+          kCounterPrefix + "state_update.observers.us",
+          50000,
+          0,
+          1000000),
+      updateStateCoalesced_(
+          map,
+          kCounterPrefix + "state_update.coalesced",
+          1,
+          1,
+          100),
+      updateStateMerged_(
+          map,
+          kCounterPrefix + "state_update.merged",
+          10,
+          1,
+          1000),
+      updateStateDeferred_(
+          map,
+          kCounterPrefix + "state_update.deferred",
+          SUM,
+          RATE),
       routeUpdate_(map, kCounterPrefix + "route_update.us", 50, 0, 500),
       bgHeartbeatDelay_(
           map,
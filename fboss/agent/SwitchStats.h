@@ -67,6 +67,9 @@ class SwitchStats : public boost::noncopyable {
   void trappedPkt() {
     trapPkts_.addValue(1);
   }
+  void trappedPkts(uint64_t count) {
+    trapPkts_.addValue(count);
+  }
   void pktDropped() {
     trapPktDrops_.addValue(1);
   }
@@ -227,6 +230,38 @@ class SwitchStats : public boost::noncopyable {
     updateState_.addValue(us.count());
   }
 
+  void stateUpdateFns(std::chrono::microseconds us) {
+    updateStateFns_.addValue(us.count());
+  }
+
+  void stateUpdatePublish(std::chrono::microseconds us) {
+    updateStatePublish_.addValue(us.count());
+  }
+
+  void stateUpdateDelta(std::chrono::microseconds us) {
+    updateStateDelta_.addValue(us.count());
+  }
+
+  void stateUpdateHw(std::chrono::microseconds us) {
+    updateStateHw_.addValue(us.count());
+  }
+
+  void stateUpdateObservers(std::chrono::microseconds us) {
+    updateStateObservers_.addValue(us.count());
+  }
+
+  void stateUpdatesCoalesced(uint64_t updates) {
+    updateStateCoalesced_.addValue(updates);
+  }
+
+  void stateUpdatesMerged(uint64_t updates) {
+    updateStateMerged_.addValue(updates);
+  }
+
+  void stateUpdatesDeferred() {
+    updateStateDeferred_.addValue(1);
+  }
+
   void routeUpdate(std::chrono::microseconds us, uint64_t routes) {
     // As syncFib() could include no routes.
     if (routes == 0) {
@@ -412,6 +447,34 @@ class SwitchStats : public boost::noncopyable {
    */
   TLHistogram updateState_;
 
+  /**
+   * Histograms for the phases of SwSwitch::updateState() (in microsecond):
+   * running the StateUpdate functions, publishing their states, computing
+   * the StateDelta, HwSwitch::stateChanged() and notifying the observers.
+   */
+  TLHistogram updateStateFns_;
+  TLHistogram updateStatePublish_;
+  TLHistogram updateStateDelta_;
+  TLHistogram updateStateHw_;
+  TLHistogram updateStateObservers_;
+
+  /**
+   * Histogram for the number of StateUpdates coalesced into one update
+   */
+  TLHistogram updateStateCoalesced_;
+
+  /**
+   * Histogram for the number of mergeable non-coalescing StateUpdates applied
+   * together
+   */
+  TLHistogram updateStateMerged_;
+
+  /**
+   * Number of times state updates were held back to be applied together with
+   * the following ones
+   */
+  TLTimeseries updateStateDeferred_;
+
   /**
    * Histogram for time used for route update (in microsecond)
    */
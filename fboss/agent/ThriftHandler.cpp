@@ -1526,6 +1526,16 @@ SwitchRunState ThriftHandler::getSwitchRunState() {
   return sw_->getSwitchRunState();
 }
 
+void ThriftHandler::getStateUpdateTraces(
+    std::vector<StateUpdateTrace>& traces,
+    int32_t count) {
+  auto log = LOG_THRIFT_CALL(DBG1);
+  if (count < 0) {
+    throw FbossError("Invalid number of state update traces: ", count);
+  }
+  traces = sw_->getStateUpdateTraces(count);
+}
+
 SSLType ThriftHandler::getSSLPolicy() {
   auto log = LOG_THRIFT_CALL(DBG1);
   SSLType sslType = SSLType::PERMITTED;
@@ -298,6 +298,10 @@ class ThriftHandler : virtual public FbossCtrlSvIf,
 
   SwitchRunState getSwitchRunState() override;
 
+  void getStateUpdateTraces(
+      std::vector<StateUpdateTrace>& traces,
+      int32_t count) override;
+
   void setSSLPolicy(apache::thrift::SSLPolicy sslPolicy) {
     sslPolicy_ = sslPolicy;
   }
@@ -20,6 +20,7 @@
 
 #include <folly/FileUtil.h>
 #include <folly/dynamic.h>
+#include <folly/experimental/bser/Bser.h>
 #include <folly/json.h>
 #include <folly/logging/xlog.h>
 
@@ -95,6 +96,23 @@ bool dumpStateToFile(const std::string& filename, const folly::dynamic& json) {
   return folly::writeFile(folly::toPrettyJson(json), filename.c_str());
 }
 
+bool dumpBinaryStateToFile(
+    const std::string& filename,
+    const folly::dynamic& state) {
+  return folly::writeFile(
+      folly::bser::toBser(state, folly::bser::serialization_opts()),
+      filename.c_str());
+}
+
+folly::dynamic parseState(folly::StringPiece serializedState) {
+  // BSER starts with a "\x00\x01" header, which can't start a JSON document
+  if (serializedState.size() >= 2 && serializedState[0] == '\x00' &&
+      serializedState[1] == '\x01') {
+    return folly::bser::parseBser(serializedState);
+  }
+  return folly::parseJson(serializedState);
+}
+
 std::string getLocalHostname() {
   const size_t kHostnameMaxLen = 256; // from gethostname man page
   char hostname[kHostnameMaxLen];
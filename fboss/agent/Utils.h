@@ -81,6 +81,19 @@ void incNiceValue(const uint32_t increment);
  */
 bool dumpStateToFile(const std::string& filename, const folly::dynamic& json);
 
+/*
+ * Serialize folly dynamic to BSER, a compact binary encoding which is much
+ * cheaper to produce and parse than JSON, and write to file
+ */
+bool dumpBinaryStateToFile(
+    const std::string& filename,
+    const folly::dynamic& state);
+
+/*
+ * Parse state written by either dumpStateToFile or dumpBinaryStateToFile
+ */
+folly::dynamic parseState(folly::StringPiece serializedState);
+
 std::vector<ClientID> AllClientIDs();
 
 /*
@@ -0,0 +1,861 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/capture/BpfFilter.h"
+
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/packet/Ethertype.h"
+#include "fboss/agent/packet/IPProto.h"
+
+#include <folly/Conv.h>
+#include <folly/IPAddress.h>
+#include <folly/Likely.h>
+#include <folly/MacAddress.h>
+#include <folly/io/IOBuf.h>
+
+#include <cctype>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+using folly::IOBuf;
+using folly::StringPiece;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace facebook {
+namespace fboss {
+
+namespace {
+
+constexpr uint32_t kUntaggedHdrLen = 14;
+constexpr uint32_t kTaggedHdrLen = 18;
+constexpr uint32_t kIPv6HdrLen = 40;
+
+// Scratch memory word holding the offset of the network header
+constexpr uint32_t kNetworkOffsetMem = 0;
+
+// What a field's offset is relative to
+enum class Base {
+  LINK,
+  NETWORK,
+  // Only valid for IPv4 packets: found from the IHL
+  TRANSPORT_V4,
+};
+
+struct Field {
+  Base base;
+  // May be negative, loads wrap around in 32 bits
+  uint32_t offset;
+  uint32_t size;
+};
+
+const Field kEtherType{Base::NETWORK, static_cast<uint32_t>(-2), 2};
+
+/*
+ * The parsed filter expression.  MATCH nodes compare a packet field, under a
+ * mask, with a value.
+ */
+struct Node {
+  enum Kind { AND, OR, NOT, MATCH };
+
+  Kind kind;
+  unique_ptr<Node> lhs;
+  unique_ptr<Node> rhs;
+  Field field;
+  uint32_t mask;
+  uint32_t value;
+};
+using NodePtr = unique_ptr<Node>;
+
+NodePtr match(Field field, uint32_t value, uint32_t mask = 0xFFFFFFFF) {
+  return NodePtr(new Node{Node::MATCH, nullptr, nullptr, field, mask, value});
+}
+
+NodePtr combine(Node::Kind kind, NodePtr lhs, NodePtr rhs) {
+  return NodePtr(
+      new Node{kind, std::move(lhs), std::move(rhs), kEtherType, 0, 0});
+}
+
+NodePtr both(NodePtr lhs, NodePtr rhs) {
+  return combine(Node::AND, std::move(lhs), std::move(rhs));
+}
+
+NodePtr either(NodePtr lhs, NodePtr rhs) {
+  return combine(Node::OR, std::move(lhs), std::move(rhs));
+}
+
+NodePtr negate(NodePtr node) {
+  return combine(Node::NOT, std::move(node), nullptr);
+}
+
+NodePtr etherType(ETHERTYPE type) {
+  return match(kEtherType, static_cast<uint16_t>(type));
+}
+
+NodePtr ipv4Proto(IP_PROTO proto) {
+  return both(
+      etherType(ETHERTYPE::ETHERTYPE_IPV4),
+      match({Base::NETWORK, 9, 1}, static_cast<uint8_t>(proto)));
+}
+
+NodePtr ipv6Proto(IP_PROTO proto) {
+  return both(
+      etherType(ETHERTYPE::ETHERTYPE_IPV6),
+      match({Base::NETWORK, 6, 1}, static_cast<uint8_t>(proto)));
+}
+
+NodePtr ipProto(IP_PROTO proto) {
+  return either(ipv4Proto(proto), ipv6Proto(proto));
+}
+
+uint32_t prefixMask(int prefixLen) {
+  if (prefixLen <= 0) {
+    return 0;
+  }
+  return prefixLen >= 32 ? 0xFFFFFFFF : ~(0xFFFFFFFF >> prefixLen);
+}
+
+enum class Dir { SRC, DST, ANY };
+
+/*
+ * Recursive descent parser for filter expressions:
+ *
+ *   expr := and ( ("or" | "||") and )*
+ *   and := not ( ("and" | "&&") not )*
+ *   not := ("not" | "!") not | "(" expr ")" | primitive
+ */
+class Parser {
+ public:
+  explicit Parser(StringPiece expression) {
+    tokenize(expression);
+  }
+
+  NodePtr parse() {
+    if (tokens_.empty()) {
+      throw FbossError("empty capture filter expression");
+    }
+    auto node = parseOr();
+    if (pos_ != tokens_.size()) {
+      throw FbossError(
+          "unexpected \"", tokens_[pos_], "\" in capture filter expression");
+    }
+    return node;
+  }
+
+ private:
+  void tokenize(StringPiece expression) {
+    size_t i = 0;
+    while (i < expression.size()) {
+      char c = expression[i];
+      if (isspace(c)) {
+        ++i;
+      } else if (c == '(' || c == ')' || c == '!') {
+        tokens_.emplace_back(1, c);
+        ++i;
+      } else {
+        size_t start = i;
+        while (i < expression.size() && !isspace(expression[i]) &&
+               expression[i] != '(' && expression[i] != ')') {
+          ++i;
+        }
+        tokens_.push_back(expression.subpiece(start, i - start).str());
+      }
+    }
+  }
+
+  bool accept(StringPiece token) {
+    if (pos_ < tokens_.size() && tokens_[pos_] == token) {
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+
+  const string& next() {
+    if (pos_ == tokens_.size()) {
+      throw FbossError("capture filter expression ends unexpectedly");
+    }
+    return tokens_[pos_++];
+  }
+
+  NodePtr parseOr() {
+    auto node = parseAnd();
+    while (accept("or") || accept("||")) {
+      node = either(std::move(node), parseAnd());
+    }
+    return node;
+  }
+
+  NodePtr parseAnd() {
+    auto node = parseNot();
+    while (accept("and") || accept("&&")) {
+      node = both(std::move(node), parseNot());
+    }
+    return node;
+  }
+
+  NodePtr parseNot() {
+    if (accept("not") || accept("!")) {
+      return negate(parseNot());
+    }
+    if (accept("(")) {
+      auto node = parseOr();
+      if (!accept(")")) {
+        throw FbossError("missing \")\" in capture filter expression");
+      }
+      return node;
+    }
+    return parsePrimitive();
+  }
+
+  NodePtr parsePrimitive() {
+    const auto& word = next();
+    if (word == "arp") {
+      return etherType(ETHERTYPE::ETHERTYPE_ARP);
+    } else if (word == "ip") {
+      return etherType(ETHERTYPE::ETHERTYPE_IPV4);
+    } else if (word == "ip6") {
+      return etherType(ETHERTYPE::ETHERTYPE_IPV6);
+    } else if (word == "tcp") {
+      return ipProto(IP_PROTO::IP_PROTO_TCP);
+    } else if (word == "udp") {
+      return ipProto(IP_PROTO::IP_PROTO_UDP);
+    } else if (word == "icmp") {
+      return ipv4Proto(IP_PROTO::IP_PROTO_ICMP);
+    } else if (word == "icmp6") {
+      return ipv6Proto(IP_PROTO::IP_PROTO_IPV6_ICMP);
+    } else if (word == "vlan") {
+      auto vlan = parseNumber(next(), 4095);
+      return both(
+          match(
+              {Base::LINK, 12, 2},
+              static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_VLAN)),
+          match({Base::LINK, 14, 2}, vlan, 0x0FFF));
+    } else if (word == "ether") {
+      auto dir = parseDir();
+      expect("host");
+      auto mac = parseMac(next());
+      return withDir(dir, [mac](Dir d) { return etherHost(mac, d); });
+    }
+
+    --pos_;
+    auto dir = parseDir();
+    const auto& qualifier = next();
+    if (qualifier == "host" || qualifier == "net") {
+      const auto& addrStr = next();
+      auto network = parseNetwork(addrStr, qualifier == "host");
+      return withDir(dir, [&network](Dir d) { return host(network, d); });
+    } else if (qualifier == "port") {
+      auto port = parseNumber(next(), 65535);
+      return withDir(dir, [port](Dir d) { return transportPort(port, d); });
+    }
+    throw FbossError("unknown capture filter primitive \"", qualifier, "\"");
+  }
+
+  void expect(StringPiece token) {
+    if (!accept(token)) {
+      throw FbossError("expected \"", token, "\" in capture filter expression");
+    }
+  }
+
+  Dir parseDir() {
+    if (accept("src")) {
+      return Dir::SRC;
+    } else if (accept("dst")) {
+      return Dir::DST;
+    }
+    return Dir::ANY;
+  }
+
+  static NodePtr withDir(Dir dir, const std::function<NodePtr(Dir)>& fn) {
+    if (dir == Dir::ANY) {
+      return either(fn(Dir::SRC), fn(Dir::DST));
+    }
+    return fn(dir);
+  }
+
+  static uint32_t parseNumber(const string& str, uint32_t max) {
+    uint32_t value;
+    try {
+      value = folly::to<uint32_t>(str);
+    } catch (const std::exception&) {
+      throw FbossError("invalid number \"", str, "\" in capture filter");
+    }
+    if (value > max) {
+      throw FbossError(
+          "number ", value, " in capture filter is larger than ", max);
+    }
+    return value;
+  }
+
+  static folly::MacAddress parseMac(const string& str) {
+    try {
+      return folly::MacAddress(str);
+    } catch (const std::exception&) {
+      throw FbossError("invalid MAC address \"", str, "\" in capture filter");
+    }
+  }
+
+  static folly::CIDRNetwork parseNetwork(const string& str, bool isHost) {
+    try {
+      if (isHost) {
+        folly::IPAddress addr(str);
+        return std::make_pair(addr, static_cast<uint8_t>(addr.bitCount()));
+      }
+      return folly::IPAddress::createNetwork(str, -1, false);
+    } catch (const std::exception&) {
+      throw FbossError("invalid address \"", str, "\" in capture filter");
+    }
+  }
+
+  static NodePtr etherHost(folly::MacAddress mac, Dir dir) {
+    uint32_t offset = dir == Dir::SRC ? 6 : 0;
+    auto value = mac.u64HBO();
+    auto high = static_cast<uint32_t>(value >> 16);
+    auto low = static_cast<uint32_t>(value & 0xFFFF);
+    return both(
+        match({Base::LINK, offset, 4}, high),
+        match({Base::LINK, offset + 4, 2}, low));
+  }
+
+  static NodePtr host(const folly::CIDRNetwork& network, Dir dir) {
+    if (network.first.isV4()) {
+      auto mask = prefixMask(network.second);
+      auto addr = network.first.asV4().toLongHBO() & mask;
+      // The sender and target protocol addresses of ARP packets
+      uint32_t ipOffset = dir == Dir::SRC ? 12 : 16;
+      uint32_t arpOffset = dir == Dir::SRC ? 14 : 24;
+      return either(
+          both(
+              etherType(ETHERTYPE::ETHERTYPE_IPV4),
+              match({Base::NETWORK, ipOffset, 4}, addr, mask)),
+          both(
+              etherType(ETHERTYPE::ETHERTYPE_ARP),
+              match({Base::NETWORK, arpOffset, 4}, addr, mask)));
+    }
+
+    uint32_t offset = dir == Dir::SRC ? 8 : 24;
+    auto bytes = network.first.asV6().toByteArray();
+    auto node = etherType(ETHERTYPE::ETHERTYPE_IPV6);
+    for (int word = 0; word < 4; ++word) {
+      auto mask = prefixMask(network.second - 32 * word);
+      if (mask == 0) {
+        break;
+      }
+      uint32_t value = 0;
+      for (int i = 0; i < 4; ++i) {
+        value = (value << 8) | bytes[4 * word + i];
+      }
+      node = both(
+          std::move(node),
+          match({Base::NETWORK, offset + 4 * word, 4}, value & mask, mask));
+    }
+    return node;
+  }
+
+  static NodePtr transportPort(uint32_t port, Dir dir) {
+    uint32_t offset = dir == Dir::SRC ? 0 : 2;
+    // Only the first fragment has the transport header
+    auto v4 = both(
+        both(
+            etherType(ETHERTYPE::ETHERTYPE_IPV4),
+            either(
+                match(
+                    {Base::NETWORK, 9, 1},
+                    static_cast<uint8_t>(IP_PROTO::IP_PROTO_TCP)),
+                match(
+                    {Base::NETWORK, 9, 1},
+                    static_cast<uint8_t>(IP_PROTO::IP_PROTO_UDP)))),
+        both(
+            match({Base::NETWORK, 6, 2}, 0, 0x1FFF),
+            match({Base::TRANSPORT_V4, offset, 2}, port)));
+    auto v6 = both(
+        both(
+            etherType(ETHERTYPE::ETHERTYPE_IPV6),
+            either(
+                match(
+                    {Base::NETWORK, 6, 1},
+                    static_cast<uint8_t>(IP_PROTO::IP_PROTO_TCP)),
+                match(
+                    {Base::NETWORK, 6, 1},
+                    static_cast<uint8_t>(IP_PROTO::IP_PROTO_UDP)))),
+        match({Base::NETWORK, kIPv6HdrLen + offset, 2}, port));
+    return either(std::move(v4), std::move(v6));
+  }
+
+  vector<string> tokens_;
+  size_t pos_{0};
+};
+
+/*
+ * Generates the BPF program for a parsed expression.  Every node is compiled
+ * into code which jumps to one label if it matches, and to another if it
+ * doesn't, so there are only forward jumps.
+ *
+ * Conditional jumps only have 8 bit offsets.  Matches whose labels are
+ * further away branch to unconditional jumps instead, which have 32 bit
+ * offsets.  Making a match long only moves labels further away, so the
+ * program is generated again until no more matches need to be made long.
+ */
+class CodeGen {
+ public:
+  vector<sock_filter> generate(const Node& root) {
+    while (!tryGenerate(root)) {
+    }
+    for (const auto& jump : jumps_) {
+      auto& insn = program_[jump.pc];
+      if (longMatches_[jump.match]) {
+        insn.jt = 0;
+        insn.jf = 1;
+        program_[jump.pc + 1].k = jumpOffset(jump.pc + 1, jump.trueLabel);
+        program_[jump.pc + 2].k = jumpOffset(jump.pc + 2, jump.falseLabel);
+      } else {
+        insn.jt = jumpOffset(jump.pc, jump.trueLabel);
+        insn.jf = jumpOffset(jump.pc, jump.falseLabel);
+      }
+    }
+    return std::move(program_);
+  }
+
+ private:
+  static constexpr uint32_t kMaxShortJump = 0xFF;
+
+  struct Jump {
+    size_t pc;
+    size_t trueLabel;
+    size_t falseLabel;
+    // Index of the match in the program
+    size_t match;
+  };
+
+  /*
+   * Returns false if some matches had to be made long, and the program must
+   * be generated again.
+   */
+  bool tryGenerate(const Node& root) {
+    program_.clear();
+    labels_.clear();
+    jumps_.clear();
+
+    // Find the network header, after the 802.1Q tag if there is one
+    emit(BPF_STMT(BPF_LD | BPF_IMM, kUntaggedHdrLen));
+    emit(BPF_STMT(BPF_ST, kNetworkOffsetMem));
+    emit(BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 12));
+    emit(BPF_JUMP(
+        BPF_JMP | BPF_JEQ | BPF_K,
+        static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_VLAN),
+        0,
+        2));
+    emit(BPF_STMT(BPF_LD | BPF_IMM, kTaggedHdrLen));
+    emit(BPF_STMT(BPF_ST, kNetworkOffsetMem));
+
+    auto accept = newLabel();
+    auto reject = newLabel();
+    gen(root, accept, reject);
+    place(accept);
+    emit(BPF_STMT(BPF_RET | BPF_K, 0xFFFFFFFF));
+    place(reject);
+    emit(BPF_STMT(BPF_RET | BPF_K, 0));
+
+    if (program_.size() > BPF_MAXINSNS) {
+      throw FbossError("capture filter expression is too complex");
+    }
+    bool done = true;
+    for (const auto& jump : jumps_) {
+      if (!longMatches_[jump.match] &&
+          (jumpOffset(jump.pc, jump.trueLabel) > kMaxShortJump ||
+           jumpOffset(jump.pc, jump.falseLabel) > kMaxShortJump)) {
+        longMatches_[jump.match] = true;
+        done = false;
+      }
+    }
+    return done;
+  }
+
+  size_t newLabel() {
+    labels_.push_back(0);
+    return labels_.size() - 1;
+  }
+
+  void place(size_t label) {
+    labels_[label] = program_.size();
+  }
+
+  void emit(sock_filter insn) {
+    program_.push_back(insn);
+  }
+
+  uint32_t jumpOffset(size_t pc, size_t label) const {
+    return labels_[label] - pc - 1;
+  }
+
+  void gen(const Node& node, size_t trueLabel, size_t falseLabel) {
+    switch (node.kind) {
+      case Node::AND: {
+        auto rhs = newLabel();
+        gen(*node.lhs, rhs, falseLabel);
+        place(rhs);
+        gen(*node.rhs, trueLabel, falseLabel);
+        return;
+      }
+      case Node::OR: {
+        auto rhs = newLabel();
+        gen(*node.lhs, trueLabel, rhs);
+        place(rhs);
+        gen(*node.rhs, trueLabel, falseLabel);
+        return;
+      }
+      case Node::NOT:
+        gen(*node.lhs, falseLabel, trueLabel);
+        return;
+      case Node::MATCH: {
+        genMatch(node);
+        auto match = jumps_.size();
+        if (match == longMatches_.size()) {
+          longMatches_.push_back(false);
+        }
+        jumps_.push_back({program_.size(), trueLabel, falseLabel, match});
+        emit(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, node.value, 0, 0));
+        if (longMatches_[match]) {
+          emit(BPF_STMT(BPF_JMP | BPF_JA, 0));
+          emit(BPF_STMT(BPF_JMP | BPF_JA, 0));
+        }
+        return;
+      }
+    }
+  }
+
+  void genMatch(const Node& node) {
+    uint16_t size = node.field.size == 4
+        ? BPF_W
+        : (node.field.size == 2 ? BPF_H : BPF_B);
+    switch (node.field.base) {
+      case Base::LINK:
+        emit(BPF_STMT(BPF_LD | size | BPF_ABS, node.field.offset));
+        break;
+      case Base::NETWORK:
+        emit(BPF_STMT(BPF_LDX | BPF_MEM, kNetworkOffsetMem));
+        emit(BPF_STMT(BPF_LD | size | BPF_IND, node.field.offset));
+        break;
+      case Base::TRANSPORT_V4:
+        // X = network offset + IHL * 4
+        emit(BPF_STMT(BPF_LD | BPF_MEM, kNetworkOffsetMem));
+        emit(BPF_STMT(BPF_MISC | BPF_TAX, 0));
+        emit(BPF_STMT(BPF_LD | BPF_B | BPF_IND, 0));
+        emit(BPF_STMT(BPF_ALU | BPF_AND | BPF_K, 0x0F));
+        emit(BPF_STMT(BPF_ALU | BPF_LSH | BPF_K, 2));
+        emit(BPF_STMT(BPF_ALU | BPF_ADD | BPF_X, 0));
+        emit(BPF_STMT(BPF_MISC | BPF_TAX, 0));
+        emit(BPF_STMT(BPF_LD | size | BPF_IND, node.field.offset));
+        break;
+    }
+    uint32_t fieldMask = node.field.size == 4
+        ? 0xFFFFFFFF
+        : (1u << (8 * node.field.size)) - 1;
+    if ((node.mask & fieldMask) != fieldMask) {
+      emit(BPF_STMT(BPF_ALU | BPF_AND | BPF_K, node.mask));
+    }
+  }
+
+  vector<sock_filter> program_;
+  vector<size_t> labels_;
+  vector<Jump> jumps_;
+  // Indexed by match, kept from one try to the next
+  vector<bool> longMatches_;
+};
+
+/*
+ * Load size bytes at offset from the packet, as a big endian number.
+ */
+bool loadPkt(const IOBuf* buf, uint32_t offset, uint32_t size, uint32_t* val) {
+  if (LIKELY(offset < buf->length() && buf->length() - offset >= size)) {
+    const uint8_t* data = buf->data() + offset;
+    uint32_t result = 0;
+    for (uint32_t i = 0; i < size; ++i) {
+      result = (result << 8) | data[i];
+    }
+    *val = result;
+    return true;
+  }
+
+  // The load is not within the first buffer of the chain
+  const IOBuf* current = buf;
+  uint32_t result = 0;
+  uint32_t loaded = 0;
+  do {
+    if (offset >= current->length()) {
+      offset -= current->length();
+    } else {
+      while (offset < current->length() && loaded < size) {
+        result = (result << 8) | current->data()[offset++];
+        ++loaded;
+      }
+      offset = 0;
+    }
+    current = current->next();
+  } while (loaded < size && current != buf);
+  *val = result;
+  return loaded == size;
+}
+
+} // namespace
+
+BpfFilter BpfFilter::compile(StringPiece expression) {
+  auto root = Parser(expression).parse();
+  return BpfFilter(CodeGen().generate(*root));
+}
+
+BpfFilter::BpfFilter(vector<sock_filter> program)
+    : program_(std::move(program)) {
+  validate();
+}
+
+void BpfFilter::validate() const {
+  if (program_.empty() || program_.size() > BPF_MAXINSNS) {
+    throw FbossError(
+        "BPF programs must have between 1 and ",
+        BPF_MAXINSNS,
+        " instructions");
+  }
+
+  // Like the kernel, only accept programs which can't read out of bounds
+  // and always end with a return.
+  for (size_t pc = 0; pc < program_.size(); ++pc) {
+    const auto& insn = program_[pc];
+    size_t remaining = program_.size() - pc - 1;
+    bool valid = true;
+    switch (BPF_CLASS(insn.code)) {
+      case BPF_LD:
+      case BPF_LDX:
+        switch (BPF_MODE(insn.code)) {
+          case BPF_IMM:
+          case BPF_LEN:
+            break;
+          case BPF_MEM:
+            valid = insn.k < BPF_MEMWORDS;
+            break;
+          case BPF_ABS:
+          case BPF_IND:
+            valid = BPF_CLASS(insn.code) == BPF_LD &&
+                (BPF_SIZE(insn.code) == BPF_W || BPF_SIZE(insn.code) == BPF_H ||
+                 BPF_SIZE(insn.code) == BPF_B);
+            // Negative offsets are the kernel's ancillary data (SKF_AD_OFF,
+            // SKF_NET_OFF, ...), which trapped packets don't have
+            if (BPF_MODE(insn.code) == BPF_ABS &&
+                static_cast<int32_t>(insn.k) < 0) {
+              valid = false;
+            }
+            break;
+          case BPF_MSH:
+            valid = insn.code == (BPF_LDX | BPF_B | BPF_MSH);
+            break;
+          default:
+            valid = false;
+        }
+        break;
+      case BPF_ST:
+      case BPF_STX:
+        valid = insn.k < BPF_MEMWORDS;
+        break;
+      case BPF_ALU:
+        switch (BPF_OP(insn.code)) {
+          case BPF_DIV:
+          case BPF_MOD:
+            valid = BPF_SRC(insn.code) == BPF_X || insn.k != 0;
+            break;
+          case BPF_ADD:
+          case BPF_SUB:
+          case BPF_MUL:
+          case BPF_OR:
+          case BPF_AND:
+          case BPF_XOR:
+          case BPF_LSH:
+          case BPF_RSH:
+          case BPF_NEG:
+            break;
+          default:
+            valid = false;
+        }
+        break;
+      case BPF_JMP:
+        switch (BPF_OP(insn.code)) {
+          case BPF_JA:
+            valid = insn.k < remaining;
+            break;
+          case BPF_JEQ:
+          case BPF_JGT:
+          case BPF_JGE:
+          case BPF_JSET:
+            valid = insn.jt < remaining && insn.jf < remaining;
+            break;
+          default:
+            valid = false;
+        }
+        break;
+      case BPF_RET:
+        valid = BPF_RVAL(insn.code) == BPF_K || BPF_RVAL(insn.code) == BPF_A;
+        break;
+      case BPF_MISC:
+        valid = BPF_MISCOP(insn.code) == BPF_TAX ||
+            BPF_MISCOP(insn.code) == BPF_TXA;
+        break;
+      default:
+        valid = false;
+    }
+    if (!valid) {
+      throw FbossError("invalid BPF instruction ", insn.code, " at ", pc);
+    }
+  }
+  if (BPF_CLASS(program_.back().code) != BPF_RET) {
+    throw FbossError("BPF programs must end with a return");
+  }
+}
+
+bool BpfFilter::matches(const IOBuf* buf) const {
+  uint32_t a = 0;
+  uint32_t x = 0;
+  uint32_t mem[BPF_MEMWORDS] = {};
+
+  // validate() guarantees the program only jumps forward, and ends in a
+  // return.
+  for (size_t pc = 0;; ++pc) {
+    const auto& insn = program_[pc];
+    switch (BPF_CLASS(insn.code)) {
+      case BPF_LD:
+      case BPF_LDX: {
+        uint32_t val;
+        switch (BPF_MODE(insn.code)) {
+          case BPF_IMM:
+            val = insn.k;
+            break;
+          case BPF_MEM:
+            val = mem[insn.k];
+            break;
+          case BPF_LEN:
+            val = buf->computeChainDataLength();
+            break;
+          case BPF_MSH:
+            if (!loadPkt(buf, insn.k, 1, &val)) {
+              return false;
+            }
+            val = (val & 0x0F) << 2;
+            break;
+          default: {
+            uint32_t offset = insn.k;
+            if (BPF_MODE(insn.code) == BPF_IND) {
+              offset += x;
+            }
+            uint32_t size = BPF_SIZE(insn.code) == BPF_W
+                ? 4
+                : (BPF_SIZE(insn.code) == BPF_H ? 2 : 1);
+            // Out of bounds loads reject the packet
+            if (!loadPkt(buf, offset, size, &val)) {
+              return false;
+            }
+          }
+        }
+        if (BPF_CLASS(insn.code) == BPF_LD) {
+          a = val;
+        } else {
+          x = val;
+        }
+        break;
+      }
+      case BPF_ST:
+        mem[insn.k] = a;
+        break;
+      case BPF_STX:
+        mem[insn.k] = x;
+        break;
+      case BPF_ALU: {
+        uint32_t operand = BPF_SRC(insn.code) == BPF_X ? x : insn.k;
+        switch (BPF_OP(insn.code)) {
+          case BPF_ADD:
+            a += operand;
+            break;
+          case BPF_SUB:
+            a -= operand;
+            break;
+          case BPF_MUL:
+            a *= operand;
+            break;
+          case BPF_DIV:
+            if (operand == 0) {
+              return false;
+            }
+            a /= operand;
+            break;
+          case BPF_MOD:
+            if (operand == 0) {
+              return false;
+            }
+            a %= operand;
+            break;
+          case BPF_OR:
+            a |= operand;
+            break;
+          case BPF_AND:
+            a &= operand;
+            break;
+          case BPF_XOR:
+            a ^= operand;
+            break;
+          case BPF_LSH:
+            a = operand < 32 ? a << operand : 0;
+            break;
+          case BPF_RSH:
+            a = operand < 32 ? a >> operand : 0;
+            break;
+          case BPF_NEG:
+            a = -a;
+            break;
+        }
+        break;
+      }
+      case BPF_JMP: {
+        uint32_t operand = BPF_SRC(insn.code) == BPF_X ? x : insn.k;
+        bool taken = false;
+        switch (BPF_OP(insn.code)) {
+          case BPF_JA:
+            pc += insn.k;
+            continue;
+          case BPF_JEQ:
+            taken = a == operand;
+            break;
+          case BPF_JGT:
+            taken = a > operand;
+            break;
+          case BPF_JGE:
+            taken = a >= operand;
+            break;
+          case BPF_JSET:
+            taken = (a & operand) != 0;
+            break;
+        }
+        pc += taken ? insn.jt : insn.jf;
+        break;
+      }
+      case BPF_RET:
+        return (BPF_RVAL(insn.code) == BPF_A ? a : insn.k) != 0;
+      case BPF_MISC:
+        if (BPF_MISCOP(insn.code) == BPF_TAX) {
+          x = a;
+        } else {
+          a = x;
+        }
+        break;
+    }
+  }
+}
+
+} // namespace fboss
+} // namespace facebook
@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/Range.h>
+
+#include <linux/filter.h>
+#include <vector>
+
+namespace folly {
+class IOBuf;
+}
+
+namespace facebook {
+namespace fboss {
+
+/*
+ * A packet filter, run as classic BPF bytecode.
+ *
+ * Filters are usually compiled from tcpdump style expressions, made up of the
+ * primitives
+ *
+ *   arp, ip, ip6, tcp, udp, icmp, icmp6
+ *   vlan ID
+ *   ether [src|dst] host MAC
+ *   [src|dst] host IP
+ *   [src|dst] net IP/LEN
+ *   [src|dst] port PORT
+ *
+ * combined with "and" ("&&"), "or" ("||"), "not" ("!") and parentheses.  As
+ * with tcpdump, IPv4 host and net also match the addresses in ARP packets.
+ * Unlike tcpdump, the network header is looked for after the 802.1Q tag, if
+ * any, since trapped packets usually carry one.
+ *
+ * Classic BPF programs, e.g. generated by "tcpdump -dd", can be run too.
+ * Loads from negative offsets, which the kernel uses for ancillary data
+ * (e.g. the VLAN tag tcpdump may match with "vlan"), aren't supported and
+ * such programs are rejected.
+ */
+class BpfFilter {
+ public:
+  /*
+   * Compile a filter expression.  Throws FbossError if the expression is not
+   * valid.
+   */
+  static BpfFilter compile(folly::StringPiece expression);
+
+  /*
+   * Throws FbossError if the program is not valid.
+   */
+  explicit BpfFilter(std::vector<sock_filter> program);
+
+  /*
+   * Run the filter on a packet, starting from its ethernet header.  The
+   * packet is read in place, even if it is split across several IOBufs.
+   */
+  bool matches(const folly::IOBuf* buf) const;
+
+  const std::vector<sock_filter>& program() const {
+    return program_;
+  }
+
+ private:
+  void validate() const;
+
+  std::vector<sock_filter> program_;
+};
+
+} // namespace fboss
+} // namespace facebook
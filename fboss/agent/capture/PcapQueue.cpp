@@ -11,7 +11,6 @@
 
 #include "fboss/agent/RxPacket.h"
 #include "fboss/agent/TxPacket.h"
-#include "fboss/agent/capture/PcapPkt.h"
 
 DEFINE_int32(
     fboss_pcap_queue_depth,
@@ -26,95 +25,92 @@ namespace fboss {
 PcapQueue::PcapQueue(uint32_t pktCapacity, uint64_t bytesCapacity)
     : pktCapacity_(
           pktCapacity == 0 ? FLAGS_fboss_pcap_queue_depth : pktCapacity),
-      bytesCapacity_(bytesCapacity) {
-  queue_.reserve(pktCapacity_);
-}
+      bytesCapacity_(bytesCapacity),
+      queue_(pktCapacity_) {}
 
 PcapQueue::~PcapQueue() {}
 
 template <typename PktType>
 void PcapQueue::addPktInternal(const PktType* pkt) {
-  // Check to see if this would exceed the queue capacity.
-  if (queue_.size() >= pktCapacity_) {
-    pktsDropped_ += 1;
+  if (finished_.load(std::memory_order_relaxed)) {
     return;
   }
-  auto newBytes = bytesInQueue_ + pkt->buf()->computeChainDataLength();
-  if (bytesCapacity_ > 0 && newBytes >= bytesCapacity_) {
-    pktsDropped_ += 1;
-    return;
+  uint64_t pktBytes = 0;
+  if (bytesCapacity_ > 0) {
+    pktBytes = pkt->buf()->computeChainDataLength();
+    auto newBytes =
+        bytesInQueue_.fetch_add(pktBytes, std::memory_order_relaxed) +
+        pktBytes;
+    if (newBytes >= bytesCapacity_) {
+      bytesInQueue_.fetch_sub(pktBytes, std::memory_order_relaxed);
+      pktsDropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
   }
 
-  queue_.emplace_back(pkt);
-}
-
-void PcapQueue::addPkt(const RxPacket* pkt) {
-  {
-    std::lock_guard<std::mutex> guard(mutex_);
-    addPktInternal(pkt);
+  // Check to see if this would exceed the queue capacity.
+  if (!queue_.write(pkt)) {
+    bytesInQueue_.fetch_sub(pktBytes, std::memory_order_relaxed);
+    pktsDropped_.fetch_add(1, std::memory_order_relaxed);
   }
-  cv_.notify_one();
 }
 
-void PcapQueue::addPktLocked(const RxPacket* pkt) {
+void PcapQueue::addPkt(const RxPacket* pkt) {
   addPktInternal(pkt);
-  // It is preferred not to be holding the lock when we signal cv_,
-  // but it is okay to call it with the lock held anyway.  (Having the lock
-  // held will just prevent the reader thread from being able to acquire it
-  // immediately when the reader wakes.)
-  cv_.notify_one();
 }
 
 void PcapQueue::addPkt(const TxPacket* pkt) {
-  {
-    std::lock_guard<std::mutex> guard(mutex_);
-    addPktInternal(pkt);
-  }
-  cv_.notify_one();
-}
-
-void PcapQueue::addPktLocked(const TxPacket* pkt) {
   addPktInternal(pkt);
-  // It is preferred not to be holding the lock when we signal cv_,
-  // but it is okay to call it with the lock held anyway.  (Having the lock
-  // held will just prevent the reader thread from being able to acquire it
-  // immediately when the reader wakes.)
-  cv_.notify_one();
 }
 
 void PcapQueue::finish() {
-  std::lock_guard<std::mutex> guard(mutex_);
-  finished_ = true;
-  cv_.notify_all();
+  if (finished_.exchange(true)) {
+    return;
+  }
+  // Wakes up the reader if it is waiting for packets. If the queue is full
+  // the reader isn't waiting, and it will see finished_ once it has read the
+  // queued packets. Either way don't wait for room, the reader may be gone.
+  queue_.write();
 }
 
 bool PcapQueue::isFinished() const {
-  std::lock_guard<std::mutex> guard(mutex_);
-  return finished_;
+  return finished_.load();
 }
 
 uint64_t PcapQueue::numDropped() const {
-  std::lock_guard<std::mutex> guard(mutex_);
-  return pktsDropped_;
+  return pktsDropped_.load(std::memory_order_relaxed);
 }
 
 bool PcapQueue::wait(std::vector<PcapPkt>* swapQueue) {
   swapQueue->clear();
-  swapQueue->reserve(pktCapacity_);
-
-  std::unique_lock<std::mutex> guard(mutex_);
-  while (queue_.empty() && !finished_) {
-    cv_.wait(guard);
-  }
-  if (queue_.empty()) {
-    DCHECK(finished_);
-    queue_.shrink_to_fit();
+  if (readerFinished_) {
     return false;
   }
 
-  swapQueue->swap(queue_);
-  bytesInQueue_ = 0;
-  return true;
+  PcapPkt pkt;
+  if (finished_.load()) {
+    // finish() may not have found room for the end of queue marker, so don't
+    // wait for it
+    if (!queue_.read(pkt)) {
+      readerFinished_ = true;
+      return false;
+    }
+  } else {
+    queue_.blockingRead(pkt);
+  }
+  do {
+    if (!pkt.initialized()) {
+      // This is the end of queue marker pushed by finish()
+      readerFinished_ = true;
+      break;
+    }
+    if (bytesCapacity_ > 0) {
+      bytesInQueue_.fetch_sub(
+          pkt.buf()->computeChainDataLength(), std::memory_order_relaxed);
+    }
+    swapQueue->push_back(std::move(pkt));
+  } while (swapQueue->size() < pktCapacity_ && queue_.read(pkt));
+  return !swapQueue->empty();
 }
 
 } // namespace fboss
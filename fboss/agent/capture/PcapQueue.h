@@ -9,8 +9,11 @@
  */
 #pragma once
 
-#include <condition_variable>
-#include <mutex>
+#include "fboss/agent/capture/PcapPkt.h"
+
+#include <folly/MPMCQueue.h>
+
+#include <atomic>
 #include <vector>
 
 namespace facebook {
@@ -18,13 +21,17 @@ namespace fboss {
 
 class RxPacket;
 class TxPacket;
-class PcapPkt;
 
 /*
  * PcapQueue stores a queue of PcapPkt objects, for transferring packets
  * from an asynchronous capture thread to a blocking thread that will process
  * the packets.  (For instance, writing them to disk using blocking I/O.)
  *
+ * Packets may be added from any number of threads.  The queue is a bounded
+ * lock-free ring, so adding a packet never blocks or contends on a lock: if
+ * the ring is full the packet is dropped.  The reader sleeps on a futex while
+ * the ring is empty.
+ *
  * There can only be a single reader.
  */
 class PcapQueue {
@@ -33,31 +40,18 @@ class PcapQueue {
   virtual ~PcapQueue();
 
   uint32_t getPktCapacity() const {
-    // pktCapacity_ is const, so no need for locking
     return pktCapacity_;
   }
 
-  /*
-   * Get the mutex protecting this PcapQueue.
-   *
-   * This is exposed to allow callers to also protect their own data
-   * with the same mutex if desired.  Callers should call addPktLocked()
-   * instead of addPkt() when they are already holding the PcapQueue mutex.
-   */
-  std::mutex& mutex() const {
-    return mutex_;
-  }
-
   void addPkt(const RxPacket* pkt);
-  void addPktLocked(const RxPacket* pkt);
   void addPkt(const TxPacket* pkt);
-  void addPktLocked(const TxPacket* pkt);
 
   /*
    * finish() signals that no more packets will be added to the queue.
    *
    * This causes wait() to return false in the reader thread once the packets
-   * currently in the queue have been read.
+   * currently in the queue have been read.  finish() never blocks, even if
+   * the queue is full and there is no reader anymore.
    */
   void finish();
   bool isFinished() const;
@@ -75,7 +69,7 @@ class PcapQueue {
    * Wait for new packets from the queue.
    *
    * Note: for best performance, the writer should re-use the same vector
-   * for multiple wait() calls.  On subsequent calls the queue will already
+   * for multiple wait() calls.  On subsequent calls the vector will already
    * have the desired capacity, and will not need to reallocate memory.
    */
   bool wait(std::vector<PcapPkt>* swapQueue);
@@ -88,15 +82,16 @@ class PcapQueue {
   template <typename PktType>
   void addPktInternal(const PktType* pkt);
 
-  mutable std::mutex mutex_;
-  std::condition_variable cv_;
-
-  bool finished_{false};
   const uint32_t pktCapacity_{0};
-  uint64_t bytesCapacity_{0};
-  uint64_t bytesInQueue_{0};
-  uint64_t pktsDropped_{0};
-  std::vector<PcapPkt> queue_;
+  const uint64_t bytesCapacity_{0};
+  // finish() pushes an uninitialized PcapPkt to mark the end of the queue,
+  // unless the queue is full
+  folly::MPMCQueue<PcapPkt> queue_;
+  std::atomic<bool> finished_{false};
+  std::atomic<uint64_t> bytesInQueue_{0};
+  std::atomic<uint64_t> pktsDropped_{0};
+  // Only accessed by the reader
+  bool readerFinished_{false};
 };
 
 } // namespace fboss
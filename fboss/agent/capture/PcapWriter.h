@@ -35,28 +35,15 @@ class PcapWriter {
   void start(folly::StringPiece path, bool overwriteExisting = false);
 
   /*
-   * Get the mutex protecting this PcapWriter.
-   *
-   * This is exposed to allow callers to also protect their own data
-   * with the same mutex if desired.  Callers should call addPktLocked()
-   * instead of addPkt() when they are already holding the PcapWriter mutex.
+   * Add a packet to be written.  This is safe to call from any thread, and
+   * never blocks: the packet is dropped if too many are waiting to be written.
    */
-  std::mutex& mutex() const {
-    return queue_.mutex();
-  }
-
   void addPkt(const RxPacket* pkt) {
     queue_.addPkt(pkt);
   }
-  void addPktLocked(const RxPacket* pkt) {
-    queue_.addPktLocked(pkt);
-  }
   void addPkt(const TxPacket* pkt) {
     queue_.addPkt(pkt);
   }
-  void addPktLocked(const TxPacket* pkt) {
-    queue_.addPktLocked(pkt);
-  }
   void finish();
 
   /*
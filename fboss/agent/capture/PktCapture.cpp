@@ -45,20 +45,19 @@ void PktCapture::stop() {
 }
 
 bool PktCapture::packetReceived(const RxPacket* pkt) {
-  std::lock_guard<std::mutex> guard(writer_.mutex());
   if (direction_ != CaptureDirection::CAPTURE_ONLY_TX &&
       true == packetFilter_.passes(pkt)) {
     ++numPacketsReceived_;
-    writer_.addPktLocked(pkt);
+    writer_.addPkt(pkt);
   }
   return (numPacketsSent_ + numPacketsReceived_) < maxPackets_;
 }
 
 bool PktCapture::packetSent(const TxPacket* pkt) {
-  std::lock_guard<std::mutex> guard(writer_.mutex());
-  if (direction_ != CaptureDirection::CAPTURE_ONLY_RX) {
+  if (direction_ != CaptureDirection::CAPTURE_ONLY_RX &&
+      packetFilter_.passes(pkt)) {
     ++numPacketsSent_;
-    writer_.addPktLocked(pkt);
+    writer_.addPkt(pkt);
   }
   return (numPacketsSent_ + numPacketsReceived_) < maxPackets_;
 }
@@ -72,7 +71,8 @@ std::string PktCapture::toString(bool withStats) const {
                                                                   : "TX only"));
   if (withStats) {
     ss << ", Packet received:" << numPacketsReceived_
-       << ", Packet sent:" << numPacketsSent_;
+       << ", Packet sent:" << numPacketsSent_
+       << ", Packet dropped:" << writer_.numDropped();
   }
   return ss.str();
 }
@@ -9,11 +9,14 @@
  */
 #pragma once
 
+#include "fboss/agent/capture/BpfFilter.h"
 #include "fboss/agent/capture/PcapWriter.h"
 #include "fboss/agent/if/gen-cpp2/ctrl_types.h"
 
 #include <boost/container/flat_set.hpp>
 #include <folly/Range.h>
+#include <atomic>
+#include <optional>
 #include <string>
 #include "fboss/agent/RxPacket.h"
 #include "fboss/agent/TxPacket.h"
@@ -38,17 +41,38 @@ class RxPacketFilter {
   boost::container::flat_set<CpuCosQueueId> cosQueues_;
 };
 
+/*
+ * The criteria a packet must meet to be captured.
+ *
+ * The BPF filter, if any, is compiled once when the capture is started and
+ * run on the packet in place, so that packets which are not wanted are never
+ * copied into the capture queue.  Throws FbossError if the filter expression
+ * is not valid.
+ */
 class PacketFilter {
  public:
   explicit PacketFilter(const CaptureFilter& captureFilter)
-      : rxPacketFilter_(captureFilter.get_rxCaptureFilter()) {}
+      : rxPacketFilter_(captureFilter.get_rxCaptureFilter()) {
+    if (!captureFilter.get_bpfExpression().empty()) {
+      bpfFilter_ = BpfFilter::compile(captureFilter.get_bpfExpression());
+    }
+  }
 
-  bool passes(const RxPacket* pkt) {
-    return rxPacketFilter_.passes(pkt);
+  bool passes(const RxPacket* pkt) const {
+    return rxPacketFilter_.passes(pkt) && bpfPasses(pkt);
+  }
+
+  bool passes(const TxPacket* pkt) const {
+    return bpfPasses(pkt);
   }
 
  private:
+  bool bpfPasses(const Packet* pkt) const {
+    return !bpfFilter_ || bpfFilter_->matches(pkt->buf());
+  }
+
   RxPacketFilter rxPacketFilter_;
+  std::optional<BpfFilter> bpfFilter_;
 };
 
 /*
@@ -85,12 +109,13 @@ class PktCapture {
 
   const std::string name_;
 
-  // Note: the rest of the state in this class is protcted by
-  // the PcapWriter's mutex.
+  // Packets are captured from any thread without locking, so the counters
+  // are atomic.  A capture may overshoot maxPackets_ by a few packets when
+  // several threads reach the limit at the same time.
   PcapWriter writer_;
   uint64_t maxPackets_{0};
-  uint64_t numPacketsReceived_{0};
-  uint64_t numPacketsSent_{0};
+  std::atomic<uint64_t> numPacketsReceived_{0};
+  std::atomic<uint64_t> numPacketsSent_{0};
   CaptureDirection direction_{CaptureDirection::CAPTURE_TX_RX};
   PacketFilter packetFilter_;
 };
@@ -18,6 +18,9 @@
 #include <folly/String.h>
 #include <folly/logging/xlog.h>
 
+#include <utility>
+#include <vector>
+
 using folly::StringPiece;
 using std::string;
 using std::unique_ptr;
@@ -39,7 +42,7 @@ void PktCaptureManager::startCapture(unique_ptr<PktCapture> capture) {
   auto path =
       folly::to<std::string>(captureDir_, "/", capture->name(), ".pcap");
 
-  std::lock_guard<std::mutex> g(mutex_);
+  folly::SharedMutexWritePriority::WriteHolder g(&lock_);
 
   const auto& name = capture->name();
   if (activeCaptures_.find(name) != activeCaptures_.end()) {
@@ -52,7 +55,7 @@ void PktCaptureManager::startCapture(unique_ptr<PktCapture> capture) {
 }
 
 void PktCaptureManager::stopCapture(StringPiece name) {
-  std::lock_guard<std::mutex> g(mutex_);
+  folly::SharedMutexWritePriority::WriteHolder g(&lock_);
 
   auto nameStr = name.str();
   auto it = activeCaptures_.find(nameStr);
@@ -66,7 +69,7 @@ void PktCaptureManager::stopCapture(StringPiece name) {
 }
 
 unique_ptr<PktCapture> PktCaptureManager::forgetCapture(StringPiece name) {
-  std::lock_guard<std::mutex> g(mutex_);
+  folly::SharedMutexWritePriority::WriteHolder g(&lock_);
   auto nameStr = name.str();
   auto activeIt = activeCaptures_.find(nameStr);
   if (activeIt != activeCaptures_.end()) {
@@ -88,51 +91,65 @@ unique_ptr<PktCapture> PktCaptureManager::forgetCapture(StringPiece name) {
 }
 
 void PktCaptureManager::stopAllCaptures() {
-  std::lock_guard<std::mutex> g(mutex_);
+  folly::SharedMutexWritePriority::WriteHolder g(&lock_);
 
   // FIXME
 }
 
 void PktCaptureManager::forgetAllCaptures() {
-  std::lock_guard<std::mutex> g(mutex_);
+  folly::SharedMutexWritePriority::WriteHolder g(&lock_);
 
   // FIXME
 }
 
 template <typename Fn>
 void PktCaptureManager::invokeCaptures(const Fn& fn) {
-  std::lock_guard<std::mutex> g(mutex_);
-
-  for (auto it = activeCaptures_.begin(); it != activeCaptures_.end();
-       /* increment in loop */) {
-    // Increment the iterator now, in case this capture deactivates itself and
-    // we need to remove it from the active captures.
-    auto thisIt = it;
-    ++it;
-    PktCapture* capture = thisIt->second.get();
-    bool stillActive = false;
-    try {
-      stillActive = fn(capture);
-    } catch (const std::exception& ex) {
-      XLOG(ERR) << "error when processing packet for capture "
-                << capture->name() << " : " << folly::exceptionStr(ex);
-      stillActive = false;
-    }
-
-    if (!stillActive) {
-      XLOG(INFO) << "auto-stopping packet capture \"" << capture->name()
-                 << "\"";
+  // Packets are handed to the captures under a read lock, so packet handling
+  // threads don't contend with each other.  Only deactivating a capture
+  // requires the write lock.
+  std::vector<std::pair<std::string, PktCapture*>> finished;
+  {
+    folly::SharedMutexWritePriority::ReadHolder g(&lock_);
+    for (const auto& nameAndCapture : activeCaptures_) {
+      PktCapture* capture = nameAndCapture.second.get();
+      bool stillActive = false;
       try {
-        inactiveCaptures_[capture->name()] = std::move(thisIt->second);
+        stillActive = fn(capture);
       } catch (const std::exception& ex) {
-        XLOG(ERR) << "error adding capture " << capture->name()
-                  << " to the inactive list";
-        // Can't do much else here.  Just continue and forget the capture.
+        XLOG(ERR) << "error when processing packet for capture "
+                  << capture->name() << " : " << folly::exceptionStr(ex);
+        stillActive = false;
+      }
+      if (!stillActive) {
+        finished.emplace_back(capture->name(), capture);
       }
-      activeCaptures_.erase(thisIt);
     }
   }
 
+  if (finished.empty()) {
+    return;
+  }
+  folly::SharedMutexWritePriority::WriteHolder g(&lock_);
+  for (const auto& nameAndCapture : finished) {
+    // Another thread may have deactivated, or even forgotten, the capture
+    // while we weren't holding the lock
+    const auto& name = nameAndCapture.first;
+    auto it = activeCaptures_.find(name);
+    if (it == activeCaptures_.end() ||
+        it->second.get() != nameAndCapture.second) {
+      continue;
+    }
+
+    XLOG(INFO) << "auto-stopping packet capture \"" << name << "\"";
+    try {
+      inactiveCaptures_[name] = std::move(it->second);
+    } catch (const std::exception& ex) {
+      XLOG(ERR) << "error adding capture " << name << " to the inactive list";
+      // Can't do much else here.  Just continue and forget the capture.
+    }
+    activeCaptures_.erase(it);
+  }
+
   bool running = !activeCaptures_.empty();
   capturesRunning_.store(running, std::memory_order_release);
 }
@@ -10,11 +10,11 @@
 #pragma once
 
 #include <folly/Range.h>
+#include <folly/SharedMutex.h>
 
 #include <atomic>
 #include <map>
 #include <memory>
-#include <mutex>
 #include <string>
 
 namespace facebook {
@@ -90,7 +90,7 @@ class PktCaptureManager {
 
   std::atomic<bool> capturesRunning_{false};
 
-  std::mutex mutex_;
+  folly::SharedMutexWritePriority lock_;
   std::string captureDir_;
   std::map<std::string, std::unique_ptr<PktCapture>> activeCaptures_;
   std::map<std::string, std::unique_ptr<PktCapture>> inactiveCaptures_;
@@ -0,0 +1,184 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/capture/BpfFilter.h"
+
+#include <gtest/gtest.h>
+
+#include <folly/io/IOBuf.h>
+
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/packet/PktUtil.h"
+
+using namespace facebook::fboss;
+
+namespace {
+
+const char* kArpRequest =
+    // Ethernet Header
+    "ff ff ff ff ff ff" // Destination MAC Address
+    "10 dd b1 bb 5a ef" // Source MAC Address
+    "81 00 00 05" // 802.1Q Tag: VLAN 5
+    "08 06" // EtherType: ARP
+    // ARP Header
+    "00 01 08 00 06 04 00 01" // Ethernet, IPv4, Request
+    "10 dd b1 bb 5a ef" // Sender Hardware Address
+    "0a 00 00 0f" // Sender Protocol Address: 10.0.0.15
+    "00 00 00 00 00 00" // Target Hardware Address
+    "0a 01 02 03"; // Target Protocol Address: 10.1.2.3
+
+const char* kDhcpRequest =
+    // Ethernet Header, untagged
+    "02 00 00 00 00 01 02 00 00 00 00 02 08 00"
+    // IPv4 Header
+    "46 00 00 24 00 00 00 00 40 11 00 00" // IHL(6), Protocol: UDP
+    "0a 00 00 0f" // Source Address: 10.0.0.15
+    "0a 00 00 01" // Destination Address: 10.0.0.1
+    "01 01 01 01" // Options
+    // UDP Header
+    "00 44 00 43 00 08 00 00"; // Source Port: 68, Destination Port: 67
+
+const char* kTcp6 =
+    // Ethernet Header
+    "02 00 00 00 00 01 02 00 00 00 00 02"
+    "81 00 00 64" // 802.1Q Tag: VLAN 100
+    "86 dd" // EtherType: IPv6
+    // IPv6 Header
+    "60 00 00 00 00 14 06 40" // Next Header: TCP
+    "20 01 0d b8 00 00 00 00 00 00 00 00 00 00 00 01" // 2001:db8::1
+    "fe 80 00 00 00 00 00 00 00 00 00 00 00 00 00 02" // fe80::2
+    // TCP Header
+    "01 bb 12 34 00 00 00 00"; // Source Port: 443, Destination Port: 4660
+
+bool matches(const char* expression, const char* pkt) {
+  auto buf = PktUtil::parseHexData(pkt);
+  return BpfFilter::compile(expression).matches(&buf);
+}
+
+} // namespace
+
+TEST(BpfFilterTest, Arp) {
+  EXPECT_TRUE(matches("arp", kArpRequest));
+  EXPECT_FALSE(matches("ip", kArpRequest));
+  EXPECT_TRUE(matches("arp and dst net 10.0.0.0/8", kArpRequest));
+  EXPECT_FALSE(matches("arp and dst net 11.0.0.0/8", kArpRequest));
+  EXPECT_TRUE(matches("arp and src host 10.0.0.15", kArpRequest));
+  EXPECT_FALSE(matches("arp && !(host 10.1.2.3)", kArpRequest));
+}
+
+TEST(BpfFilterTest, Link) {
+  EXPECT_TRUE(matches("vlan 5", kArpRequest));
+  EXPECT_FALSE(matches("vlan 6", kArpRequest));
+  EXPECT_FALSE(matches("vlan 1", kDhcpRequest));
+  EXPECT_TRUE(matches("ether src host 10:dd:b1:bb:5a:ef", kArpRequest));
+  EXPECT_FALSE(matches("ether dst host 10:dd:b1:bb:5a:ef", kArpRequest));
+  EXPECT_TRUE(matches("ether host 10:dd:b1:bb:5a:ef", kArpRequest));
+}
+
+TEST(BpfFilterTest, IPv4) {
+  // The UDP header is found after the IP options
+  EXPECT_TRUE(matches("udp and dst port 67", kDhcpRequest));
+  EXPECT_TRUE(matches("udp and port 68", kDhcpRequest));
+  EXPECT_FALSE(matches("tcp or port 69", kDhcpRequest));
+  EXPECT_TRUE(matches("ip and host 10.0.0.1 and not arp", kDhcpRequest));
+  EXPECT_TRUE(matches("net 10.0.0.0/30", kDhcpRequest));
+  EXPECT_FALSE(matches("dst net 10.0.0.4/30", kDhcpRequest));
+}
+
+TEST(BpfFilterTest, Fragment) {
+  // Non-first fragments don't carry the transport header
+  auto fragment =
+      "02 00 00 00 00 01 02 00 00 00 00 02 08 00"
+      "45 00 00 24 00 00 00 01 40 11 00 00 0a 00 00 0f 0a 00 00 01"
+      "00 44 00 43 00 08 00 00";
+  EXPECT_TRUE(matches("udp", fragment));
+  EXPECT_FALSE(matches("port 67", fragment));
+}
+
+TEST(BpfFilterTest, IPv6) {
+  EXPECT_TRUE(matches("ip6 and tcp and src port 443", kTcp6));
+  EXPECT_TRUE(matches("src net 2001:db8::/32 and dst host fe80::2", kTcp6));
+  EXPECT_FALSE(matches("src net 2001:db9::/32", kTcp6));
+  EXPECT_FALSE(matches("icmp6 or icmp", kTcp6));
+  EXPECT_TRUE(matches("vlan 100 and ip6", kTcp6));
+}
+
+TEST(BpfFilterTest, SplitPacket) {
+  // Split the frame in the middle of the IPv6 source address
+  auto frame = PktUtil::parseHexData(kTcp6);
+  auto buf = frame.clone();
+  buf->prependChain(frame.clone());
+  buf->trimEnd(buf->length() - 25);
+  buf->next()->trimStart(25);
+
+  auto filter = BpfFilter::compile(
+      "src net 2001:db8::/32 and dst host fe80::2 and port 443");
+  EXPECT_TRUE(filter.matches(buf.get()));
+  EXPECT_FALSE(BpfFilter::compile("port 444").matches(buf.get()));
+}
+
+TEST(BpfFilterTest, Truncated) {
+  // Reading past the end of the packet rejects it
+  auto buf =
+      PktUtil::parseHexData("02 00 00 00 00 01 02 00 00 00 00 02 08 00 45");
+  EXPECT_FALSE(BpfFilter::compile("udp").matches(&buf));
+  EXPECT_FALSE(BpfFilter::compile("not udp").matches(&buf));
+}
+
+TEST(BpfFilterTest, BadExpression) {
+  for (auto expression :
+       {"",
+        "arp and",
+        "(arp",
+        "arp )",
+        "foo",
+        "port 70000",
+        "host 1.2.3",
+        "net 10.0.0.0/33",
+        "ether host xx"}) {
+    EXPECT_THROW(BpfFilter::compile(expression), FbossError) << expression;
+  }
+}
+
+TEST(BpfFilterTest, LongJumps) {
+  // The first hosts are too far from the end for 8 bit jump offsets
+  std::string expression = "arp and (host 10.0.0.15";
+  for (int i = 0; i < 100; ++i) {
+    expression += " or host 10.2.0." + std::to_string(i);
+  }
+  expression += ")";
+  EXPECT_TRUE(matches(expression.c_str(), kArpRequest));
+  EXPECT_FALSE(matches(("not " + expression).c_str(), kArpRequest));
+  EXPECT_FALSE(matches(expression.c_str(), kDhcpRequest));
+}
+
+TEST(BpfFilterTest, RawProgram) {
+  // tcpdump -dd arp
+  BpfFilter filter({
+      {0x28, 0, 0, 0x0000000c},
+      {0x15, 0, 1, 0x00000806},
+      {0x06, 0, 0, 0x00040000},
+      {0x06, 0, 0, 0x00000000},
+  });
+  auto arp = PktUtil::parseHexData(
+      "ff ff ff ff ff ff 10 dd b1 bb 5a ef 08 06 00 01 08 00 06 04 00 01");
+  auto udp = PktUtil::parseHexData(kDhcpRequest);
+  EXPECT_TRUE(filter.matches(&arp));
+  EXPECT_FALSE(filter.matches(&udp));
+}
+
+TEST(BpfFilterTest, BadProgram) {
+  // Jump past the end of the program
+  EXPECT_THROW((BpfFilter({{0x15, 0, 5, 1}, {0x06, 0, 0, 0}})), FbossError);
+  // Doesn't end with a return
+  EXPECT_THROW((BpfFilter({{0x06, 0, 0, 0}, {0x00, 0, 0, 0}})), FbossError);
+  // Ancillary load of the VLAN tag (SKF_AD_OFF + SKF_AD_VLAN_TAG)
+  EXPECT_THROW(
+      (BpfFilter({{0x28, 0, 0, 0xfffff02c}, {0x06, 0, 0, 0}})), FbossError);
+}
@@ -13,6 +13,7 @@
 
 #include <gtest/gtest.h>
 #include <thread>
+#include <vector>
 
 using namespace facebook::fboss;
 using folly::ByteRange;
@@ -71,3 +72,81 @@ TEST(PcapQueueTest, SimpleAdd) {
   ByteRange waitedPktData = waitedPktBufClone->coalesce();
   EXPECT_EQ(expectedPktData, waitedPktData);
 }
+
+namespace {
+std::unique_ptr<MockRxPacket> makeRxPkt() {
+  auto pkt = MockRxPacket::fromHex(
+      // dst mac, src mac
+      "02 00 01 00 00 01  02 00 02 01 02 03"
+      // 802.1q, VLAN 1
+      "81 00 00 01"
+      // Local experimental ethertype
+      "88 b5");
+  pkt->padToLength(68);
+  pkt->setSrcPort(PortID(1));
+  pkt->setSrcVlan(VlanID(1));
+  return pkt;
+}
+} // namespace
+
+TEST(PcapQueueTest, DropsWhenFull) {
+  PcapQueue queue(2);
+  auto pkt = makeRxPkt();
+  for (int i = 0; i < 5; ++i) {
+    queue.addPkt(pkt.get());
+  }
+  EXPECT_EQ(3, queue.numDropped());
+
+  std::vector<PcapPkt> waitedPkts;
+  std::thread waiter([&]() { pktWaitThread(&queue, &waitedPkts); });
+  queue.finish();
+  waiter.join();
+  EXPECT_EQ(2, waitedPkts.size());
+
+  // Packets added after finish() are ignored
+  queue.addPkt(pkt.get());
+  EXPECT_EQ(3, queue.numDropped());
+}
+
+TEST(PcapQueueTest, FinishDoesNotWaitForReader) {
+  PcapQueue queue(2);
+  auto pkt = makeRxPkt();
+  queue.addPkt(pkt.get());
+  queue.addPkt(pkt.get());
+
+  // No reader and no room for the end of queue marker
+  queue.finish();
+  EXPECT_TRUE(queue.isFinished());
+
+  // A late reader still gets the queued packets, and then stops
+  std::vector<PcapPkt> waitedPkts;
+  std::thread waiter([&]() { pktWaitThread(&queue, &waitedPkts); });
+  waiter.join();
+  EXPECT_EQ(2, waitedPkts.size());
+}
+
+TEST(PcapQueueTest, MultipleWriters) {
+  const int kNumWriters = 4;
+  const int kPktsPerWriter = 1000;
+  PcapQueue queue(kNumWriters * kPktsPerWriter);
+  std::vector<PcapPkt> waitedPkts;
+  std::thread waiter([&]() { pktWaitThread(&queue, &waitedPkts); });
+
+  auto pkt = makeRxPkt();
+  std::vector<std::thread> writers;
+  for (int i = 0; i < kNumWriters; ++i) {
+    writers.emplace_back([&]() {
+      for (int n = 0; n < kPktsPerWriter; ++n) {
+        queue.addPkt(pkt.get());
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  queue.finish();
+  waiter.join();
+
+  EXPECT_EQ(0, queue.numDropped());
+  EXPECT_EQ(kNumWriters * kPktsPerWriter, waitedPkts.size());
+}
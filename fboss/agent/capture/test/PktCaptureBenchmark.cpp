@@ -0,0 +1,133 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/capture/PktCapture.h"
+#include "fboss/agent/capture/PktCaptureManager.h"
+#include "fboss/agent/hw/mock/MockRxPacket.h"
+#include "fboss/agent/test/HwTestHandle.h"
+#include "fboss/agent/test/TestUtils.h"
+
+#include <folly/Benchmark.h>
+#include <folly/Conv.h>
+
+#include <limits>
+#include <thread>
+#include <vector>
+
+using namespace facebook::fboss;
+
+namespace {
+
+// Global state used by the benchmarks
+std::unique_ptr<HwTestHandle> handle;
+
+std::unique_ptr<MockRxPacket> makeRxPkt() {
+  auto pkt = MockRxPacket::fromHex(
+      // dst mac, src mac
+      "02 00 01 00 00 01  02 00 02 01 02 03"
+      // 802.1q, VLAN 1
+      "81 00 00 01"
+      // Local experimental ethertype
+      "88 b5");
+  pkt->padToLength(68);
+  pkt->setSrcPort(PortID(1));
+  pkt->setSrcVlan(VlanID(1));
+  return pkt;
+}
+
+void startCaptures(uint32_t numCaptures) {
+  auto mgr = handle->getSw()->getCaptureMgr();
+  for (uint32_t i = 0; i < numCaptures; ++i) {
+    mgr->startCapture(std::make_unique<PktCapture>(
+        folly::to<std::string>("bench", i),
+        std::numeric_limits<uint64_t>::max(),
+        CaptureDirection::CAPTURE_TX_RX));
+  }
+}
+
+void forgetCaptures(uint32_t numCaptures) {
+  auto mgr = handle->getSw()->getCaptureMgr();
+  for (uint32_t i = 0; i < numCaptures; ++i) {
+    mgr->forgetCapture(folly::to<std::string>("bench", i));
+  }
+}
+
+/*
+ * The cost of PktCaptureManager::packetReceived() for each packet trapped to
+ * the CPU, when numCaptures captures are running. The captures' queues fill
+ * up quickly, after which the packets are dropped, as they would be during a
+ * packet storm.
+ */
+void packetReceived(uint32_t numIters, uint32_t numCaptures) {
+  std::unique_ptr<MockRxPacket> pkt;
+  BENCHMARK_SUSPEND {
+    pkt = makeRxPkt();
+    startCaptures(numCaptures);
+  }
+
+  auto mgr = handle->getSw()->getCaptureMgr();
+  for (uint32_t n = 0; n < numIters; ++n) {
+    mgr->packetReceived(pkt.get());
+  }
+
+  BENCHMARK_SUSPEND {
+    forgetCaptures(numCaptures);
+  }
+}
+
+/*
+ * The same, with packets received on 4 threads at once.
+ */
+void packetReceivedMultiThreaded(uint32_t numIters, uint32_t numCaptures) {
+  constexpr int kNumThreads = 4;
+  std::unique_ptr<MockRxPacket> pkt;
+  BENCHMARK_SUSPEND {
+    pkt = makeRxPkt();
+    startCaptures(numCaptures);
+  }
+
+  auto mgr = handle->getSw()->getCaptureMgr();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([mgr, &pkt, numIters]() {
+      for (uint32_t n = 0; n < numIters / kNumThreads; ++n) {
+        mgr->packetReceived(pkt.get());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  BENCHMARK_SUSPEND {
+    forgetCaptures(numCaptures);
+  }
+}
+
+} // namespace
+
+BENCHMARK_PARAM(packetReceived, 0)
+BENCHMARK_PARAM(packetReceived, 1)
+BENCHMARK_PARAM(packetReceived, 4)
+BENCHMARK_DRAW_LINE();
+BENCHMARK_PARAM(packetReceivedMultiThreaded, 0)
+BENCHMARK_PARAM(packetReceivedMultiThreaded, 1)
+BENCHMARK_PARAM(packetReceivedMultiThreaded, 4)
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  // Setting up the switch is fairly expensive, do it once for all benchmarks
+  handle = createTestHandle(testStateA());
+
+  folly::runBenchmarks();
+  handle.reset();
+  return 0;
+}
@@ -19,6 +19,11 @@ DEFINE_string(
     switch_state_file,
     "switch_state",
     "File for dumping switch state JSON in on exit");
+DEFINE_bool(
+    binary_warm_boot_state,
+    false,
+    "Dump switch state on exit in a binary format (BSER) rather than JSON. "
+    "Either format is read back on warm boot.");
 
 namespace {
 constexpr auto wbFlagPrefix = "can_warm_boot_";
@@ -131,17 +136,18 @@ bool DiscBackedBcmWarmBootHelper::checkAndClearWarmBootFlags() {
 
 bool DiscBackedBcmWarmBootHelper::storeWarmBootState(
     const folly::dynamic& switchState) {
-  warmBootStateWritten_ =
-      dumpStateToFile(warmBootSwitchStateFile(), switchState);
+  warmBootStateWritten_ = FLAGS_binary_warm_boot_state
+      ? dumpBinaryStateToFile(warmBootSwitchStateFile(), switchState)
+      : dumpStateToFile(warmBootSwitchStateFile(), switchState);
   return warmBootStateWritten_;
 }
 
 folly::dynamic DiscBackedBcmWarmBootHelper::getWarmBootState() const {
-  std::string warmBootJson;
-  auto ret = folly::readFile(warmBootSwitchStateFile().c_str(), warmBootJson);
+  std::string warmBootState;
+  auto ret = folly::readFile(warmBootSwitchStateFile().c_str(), warmBootState);
   sysCheckError(
       ret, "Unable to read switch state from : ", warmBootSwitchStateFile());
-  return folly::parseJson(warmBootJson);
+  return parseState(warmBootState);
 }
 
 } // namespace fboss
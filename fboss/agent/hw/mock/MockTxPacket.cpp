@@ -11,16 +11,18 @@
 
 #include <folly/io/IOBuf.h>
 
+#include "fboss/agent/PacketBufferPool.h"
 #include "fboss/agent/packet/EthHdr.h"
 
-using folly::IOBuf;
-
 namespace facebook {
 namespace fboss {
 
 MockTxPacket::MockTxPacket(uint32_t size) {
-  buf_ = IOBuf::create(size);
-  buf_->append(size);
+  buf_ = PacketBufferPool::get()->allocate(size);
+}
+
+MockTxPacket::~MockTxPacket() {
+  PacketBufferPool::get()->recycle(std::move(buf_));
 }
 
 std::unique_ptr<MockTxPacket> MockTxPacket::clone() const {
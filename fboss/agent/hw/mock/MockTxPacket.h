@@ -17,6 +17,7 @@ namespace fboss {
 class MockTxPacket : public TxPacket {
  public:
   explicit MockTxPacket(uint32_t size);
+  ~MockTxPacket() override;
 
   std::unique_ptr<MockTxPacket> clone() const;
 };
@@ -34,7 +34,7 @@ sai_status_t send_hostif_fn(
         tx_port = attr_list[i].value.oid;
     }
   }
-  XLOG(INFO) << "Sending packet on port : " << std::hex << tx_port
+  XLOG(DBG5) << "Sending packet on port : " << std::hex << tx_port
              << " tx type : " << tx_type;
 
   return SAI_STATUS_SUCCESS;
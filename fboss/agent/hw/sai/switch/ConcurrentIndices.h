@@ -32,6 +32,11 @@ struct ConcurrentIndices {
   // callback supports punt with vlan id in either an attribute
   // or the frame itself
   folly::ConcurrentHashMap<PortSaiId, VlanID> vlanIds;
+  /*
+   * portSaiIds is read by packet tx to find the egress port
+   * and modified by port updates
+   */
+  folly::ConcurrentHashMap<PortID, PortSaiId> portSaiIds;
 };
 
 } // namespace fboss
@@ -186,6 +186,8 @@ PortSaiId SaiPortManager::addPort(const std::shared_ptr<Port>& swPort) {
       saiPort->adapterKey(), handle->queues, swPort->getPortQueues());
   handles_.emplace(swPort->getID(), std::move(handle));
   concurrentIndices_->portIds.emplace(saiPort->adapterKey(), swPort->getID());
+  concurrentIndices_->portSaiIds.emplace(
+      swPort->getID(), saiPort->adapterKey());
   return saiPort->adapterKey();
 }
 
@@ -195,6 +197,7 @@ void SaiPortManager::removePort(PortID swId) {
     throw FbossError("Attempted to remove non-existent port: ", swId);
   }
   concurrentIndices_->portIds.erase(itr->second->port->adapterKey());
+  concurrentIndices_->portSaiIds.erase(swId);
   handles_.erase(itr);
 }
 
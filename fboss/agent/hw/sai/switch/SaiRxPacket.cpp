@@ -9,6 +9,7 @@
  */
 
 #include "fboss/agent/hw/sai/switch/SaiRxPacket.h"
+#include "fboss/agent/PacketBufferPool.h"
 
 #include <folly/io/IOBuf.h>
 
@@ -30,4 +31,22 @@ SaiRxPacket::SaiRxPacket(
   srcVlan_ = vlanId;
 }
 
+SaiRxPacket::SaiRxPacket(
+    std::unique_ptr<folly::IOBuf> buf,
+    PortID portId,
+    VlanID vlanId) {
+  buf_ = std::move(buf);
+  len_ = buf_->computeChainDataLength();
+  srcPort_ = portId;
+  srcVlan_ = vlanId;
+  pooled_ = true;
+}
+
+SaiRxPacket::~SaiRxPacket() {
+  // The other buffers belong to the SDK
+  if (pooled_) {
+    PacketBufferPool::get()->recycle(std::move(buf_));
+  }
+}
+
 } // namespace facebook::fboss
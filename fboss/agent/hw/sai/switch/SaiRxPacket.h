@@ -22,6 +22,16 @@ class SaiRxPacket : public RxPacket {
       const void* buffer,
       PortID portID,
       VlanID vlanID);
+  /*
+   * Takes ownership of the buffer, so that the packet can outlive the RX
+   * callback. The buffer should come from PacketBufferPool, it is recycled
+   * when the packet is freed.
+   */
+  SaiRxPacket(std::unique_ptr<folly::IOBuf> buf, PortID portID, VlanID vlanID);
+  ~SaiRxPacket() override;
+
+ private:
+  bool pooled_{false};
 };
 
 } // namespace facebook::fboss
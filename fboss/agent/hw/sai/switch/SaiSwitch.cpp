@@ -9,6 +9,7 @@
  */
 
 #include "fboss/agent/hw/sai/switch/SaiSwitch.h"
+#include "fboss/agent/PacketBufferPool.h"
 #include "fboss/agent/Utils.h"
 #include "fboss/agent/hw/sai/api/FdbApi.h"
 #include "fboss/agent/hw/sai/api/HostifApi.h"
@@ -126,34 +127,27 @@ bool SaiSwitch::isValidStateUpdate(const StateDelta& delta) const {
 }
 
 std::unique_ptr<TxPacket> SaiSwitch::allocatePacket(uint32_t size) const {
-  std::lock_guard<std::mutex> lock(saiSwitchMutex_);
-  return allocatePacketLocked(lock, size);
+  return std::make_unique<SaiTxPacket>(size);
 }
 
 bool SaiSwitch::sendPacketSwitchedAsync(
     std::unique_ptr<TxPacket> pkt) noexcept {
-  std::lock_guard<std::mutex> lock(saiSwitchMutex_);
-  return sendPacketSwitchedAsyncLocked(lock, std::move(pkt));
+  asyncTxEventBase_.runInEventBaseThread(
+      [this, pkt = std::move(pkt)]() mutable {
+        sendPacketSwitchedSync(std::move(pkt));
+      });
+  return true;
 }
 
 bool SaiSwitch::sendPacketOutOfPortAsync(
     std::unique_ptr<TxPacket> pkt,
     PortID portID,
-    std::optional<uint8_t> queue) noexcept {
-  std::lock_guard<std::mutex> lock(saiSwitchMutex_);
-  return sendPacketOutOfPortAsyncLocked(lock, std::move(pkt), portID, queue);
-}
-
-bool SaiSwitch::sendPacketSwitchedSync(std::unique_ptr<TxPacket> pkt) noexcept {
-  std::lock_guard<std::mutex> lock(saiSwitchMutex_);
-  return sendPacketSwitchedSyncLocked(lock, std::move(pkt));
-}
-
-bool SaiSwitch::sendPacketOutOfPortSync(
-    std::unique_ptr<TxPacket> pkt,
-    PortID portID) noexcept {
-  std::lock_guard<std::mutex> lock(saiSwitchMutex_);
-  return sendPacketOutOfPortSyncLocked(lock, std::move(pkt), portID);
+    std::optional<uint8_t> /* queue */) noexcept {
+  asyncTxEventBase_.runInEventBaseThread(
+      [this, pkt = std::move(pkt), portID]() mutable {
+        sendPacketOutOfPortSync(std::move(pkt), portID);
+      });
+  return true;
 }
 
 void SaiSwitch::updateStats(SwitchStats* switchStats) {
@@ -207,7 +201,7 @@ cfg::PortSpeed SaiSwitch::getPortMaxSpeed(PortID port) const {
 }
 
 void SaiSwitch::packetRxCallbackTopHalf(
-    SwitchSaiId switch_id,
+    SwitchSaiId /* switch_id */,
     sai_size_t buffer_size,
     const void* buffer,
     uint32_t attr_count,
@@ -215,15 +209,20 @@ void SaiSwitch::packetRxCallbackTopHalf(
   std::vector<sai_attribute_t> attrList;
   attrList.resize(attr_count);
   std::copy(attr_list, attr_list + attr_count, attrList.data());
-  std::unique_ptr<folly::IOBuf> ioBuf =
-      folly::IOBuf::copyBuffer(buffer, buffer_size);
-  rxBottomHalfEventBase_.runInEventBaseThread(
-      [this,
-       switch_id,
-       ioBufTmp = std::move(ioBuf),
-       attrListTmp = std::move(attrList)]() mutable {
-        packetRxCallbackBottomHalf(switch_id, std::move(ioBufTmp), attrListTmp);
-      });
+  auto ioBuf = PacketBufferPool::get()->allocate(buffer_size);
+  memcpy(ioBuf->writableData(), buffer, buffer_size);
+  bool scheduleBottomHalf;
+  {
+    auto pendingRxPackets = pendingRxPackets_.lock();
+    scheduleBottomHalf = pendingRxPackets->empty();
+    pendingRxPackets->push_back({std::move(ioBuf), std::move(attrList)});
+  }
+  // Otherwise the bottom half scheduled for the earlier packets will pick
+  // this one up as well
+  if (scheduleBottomHalf) {
+    rxBottomHalfEventBase_.runInEventBaseThread(
+        [this]() { packetRxCallbackBottomHalf(); });
+  }
 }
 
 void SaiSwitch::linkStateChangedCallback(
@@ -311,10 +310,27 @@ void SaiSwitch::initAsyncTx(const std::lock_guard<std::mutex>& /* lock */) {
   });
 }
 
-void SaiSwitch::packetRxCallbackBottomHalf(
-    SwitchSaiId /* unused */,
+void SaiSwitch::packetRxCallbackBottomHalf() {
+  std::vector<PendingRxPacket> pendingRxPackets;
+  pendingRxPackets_.lock()->swap(pendingRxPackets);
+
+  std::vector<std::unique_ptr<RxPacket>> rxPackets;
+  rxPackets.reserve(pendingRxPackets.size());
+  for (auto& pending : pendingRxPackets) {
+    auto rxPacket =
+        createRxPacket(std::move(pending.ioBuf), pending.attributes);
+    if (rxPacket) {
+      rxPackets.push_back(std::move(rxPacket));
+    }
+  }
+  if (!rxPackets.empty()) {
+    callback_->packetsReceived(folly::range(rxPackets));
+  }
+}
+
+std::unique_ptr<SaiRxPacket> SaiSwitch::createRxPacket(
     std::unique_ptr<folly::IOBuf> ioBuf,
-    std::vector<sai_attribute_t> attrList) {
+    const std::vector<sai_attribute_t>& attrList) const {
   std::optional<PortSaiId> portSaiIdOpt;
   for (auto attr : attrList) {
     switch (attr.id) {
@@ -334,20 +350,18 @@ void SaiSwitch::packetRxCallbackBottomHalf(
   const auto portItr = concurrentIndices_->portIds.find(portSaiId);
   if (portItr == concurrentIndices_->portIds.cend()) {
     XLOG(WARNING) << "RX packet had port with unknown sai id: " << portSaiId;
-    return;
+    return nullptr;
   }
   PortID swPortId = portItr->second;
 
   const auto vlanItr = concurrentIndices_->vlanIds.find(portSaiId);
   if (vlanItr == concurrentIndices_->vlanIds.cend()) {
     XLOG(WARNING) << "RX packet had port in no known vlan: " << portSaiId;
-    return;
+    return nullptr;
   }
   VlanID swVlanId = vlanItr->second;
 
-  auto rxPacket = std::make_unique<SaiRxPacket>(
-      ioBuf->length(), ioBuf->writableData(), swPortId, swVlanId);
-  callback_->packetReceived(std::move(rxPacket));
+  return std::make_unique<SaiRxPacket>(std::move(ioBuf), swPortId, swVlanId);
 }
 
 void SaiSwitch::unregisterCallbacksLocked(
@@ -382,39 +396,7 @@ bool SaiSwitch::isValidStateUpdateLocked(
   return true;
 }
 
-std::unique_ptr<TxPacket> SaiSwitch::allocatePacketLocked(
-    const std::lock_guard<std::mutex>& /* lock */,
-    uint32_t size) const {
-  return std::make_unique<SaiTxPacket>(size);
-}
-
-bool SaiSwitch::sendPacketSwitchedAsyncLocked(
-    const std::lock_guard<std::mutex>& lock,
-    std::unique_ptr<TxPacket> pkt) noexcept {
-  asyncTxEventBase_.runInEventBaseThread(
-      [this, pkt = std::move(pkt)]() mutable {
-        std::lock_guard<std::mutex> lock(saiSwitchMutex_);
-        sendPacketSwitchedSyncLocked(lock, std::move(pkt));
-      });
-  return true;
-}
-
-bool SaiSwitch::sendPacketOutOfPortAsyncLocked(
-    const std::lock_guard<std::mutex>& lock,
-    std::unique_ptr<TxPacket> pkt,
-    PortID portID,
-    std::optional<uint8_t> /* queue */) noexcept {
-  asyncTxEventBase_.runInEventBaseThread(
-      [this, pkt = std::move(pkt), portID]() mutable {
-        std::lock_guard<std::mutex> lock(saiSwitchMutex_);
-        sendPacketOutOfPortSyncLocked(lock, std::move(pkt), portID);
-      });
-  return true;
-}
-
-bool SaiSwitch::sendPacketSwitchedSyncLocked(
-    const std::lock_guard<std::mutex>& lock,
-    std::unique_ptr<TxPacket> pkt) noexcept {
+bool SaiSwitch::sendPacketSwitchedSync(std::unique_ptr<TxPacket> pkt) noexcept {
   /*
   TODO: remove this hack when difference in src and dst mac is no longer
   required pipe line look up causes packet to pass through pipeline and
@@ -447,13 +429,12 @@ bool SaiSwitch::sendPacketSwitchedSyncLocked(
   return true;
 }
 
-bool SaiSwitch::sendPacketOutOfPortSyncLocked(
-    const std::lock_guard<std::mutex>& lock,
+bool SaiSwitch::sendPacketOutOfPortSync(
     std::unique_ptr<TxPacket> pkt,
     PortID portID) noexcept {
-  auto portHandle =
-      managerTableLocked(lock)->portManager().getPortHandle(portID);
-  if (!portHandle) {
+  // Not the port manager, which stateChanged may be modifying
+  const auto portItr = concurrentIndices_->portSaiIds.find(portID);
+  if (portItr == concurrentIndices_->portSaiIds.cend()) {
     throw FbossError("Failed to send packet on invalid port: ", portID);
   }
   /* TODO: this hack is required, sending packet out of port with with pipeline
@@ -498,8 +479,7 @@ bool SaiSwitch::sendPacketOutOfPortSyncLocked(
 
   SaiTxPacketTraits::Attributes::TxType txType(
       SAI_HOSTIF_TX_TYPE_PIPELINE_BYPASS);
-  SaiTxPacketTraits::Attributes::EgressPortOrLag egressPort(
-      portHandle->port->adapterKey());
+  SaiTxPacketTraits::Attributes::EgressPortOrLag egressPort(portItr->second);
   SaiTxPacketTraits::TxAttributes attributes{txType, egressPort};
   auto& hostifApi = SaiApiTable::getInstance()->hostifApi();
   hostifApi.send(attributes, switchId_, txPacket);
@@ -14,11 +14,13 @@
 #include "fboss/agent/hw/sai/switch/SaiManagerTable.h"
 #include "fboss/agent/hw/sai/switch/SaiRxPacket.h"
 
+#include <folly/Synchronized.h>
 #include <folly/io/async/EventBase.h>
 
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 namespace facebook::fboss {
 
@@ -96,8 +98,9 @@ class SaiSwitch : public HwSwitch {
    * This method is not thread safe, it should only be used
    * from the SAI adapter's rx callback caller thread.
    *
-   * It immediately runs packetRxCallbackBottomHalf with the
-   * same arguments on rxBottomHalfEventBase_
+   * It queues the packet for packetRxCallbackBottomHalf on
+   * rxBottomHalfEventBase_, which hands all the packets queued by the time
+   * it runs to the SwSwitch as one batch.
    */
   void packetRxCallbackTopHalf(
       SwitchSaiId switch_id,
@@ -130,7 +133,9 @@ class SaiSwitch : public HwSwitch {
    * to avoid a deadlock trying to lock saiSwitchMutex_ twice.
    *
    * N.B., packet rx is handled slightly differently, which is documented
-   * along with its methods.
+   * along with its methods. Packet tx doesn't take saiSwitchMutex_ at all:
+   * it only reads concurrentIndices_, so that a long stateChanged doesn't
+   * hold up LACP, LLDP or ARP replies.
    */
   HwInitResult initLocked(
       const std::lock_guard<std::mutex>& lock,
@@ -147,29 +152,6 @@ class SaiSwitch : public HwSwitch {
       const std::lock_guard<std::mutex>& lock,
       const StateDelta& delta) const;
 
-  std::unique_ptr<TxPacket> allocatePacketLocked(
-      const std::lock_guard<std::mutex>& lock,
-      uint32_t size) const;
-
-  bool sendPacketSwitchedAsyncLocked(
-      const std::lock_guard<std::mutex>& lock,
-      std::unique_ptr<TxPacket> pkt) noexcept;
-
-  bool sendPacketOutOfPortAsyncLocked(
-      const std::lock_guard<std::mutex>& lock,
-      std::unique_ptr<TxPacket> pkt,
-      PortID portID,
-      std::optional<uint8_t> queue) noexcept;
-
-  bool sendPacketSwitchedSyncLocked(
-      const std::lock_guard<std::mutex>& lock,
-      std::unique_ptr<TxPacket> pkt) noexcept;
-
-  bool sendPacketOutOfPortSyncLocked(
-      const std::lock_guard<std::mutex>& lock,
-      std::unique_ptr<TxPacket> pkt,
-      PortID portID) noexcept;
-
   void updateStatsLocked(
       const std::lock_guard<std::mutex>& lock,
       SwitchStats* switchStats);
@@ -220,10 +202,11 @@ class SaiSwitch : public HwSwitch {
   void initRx(const std::lock_guard<std::mutex>& lock);
   void initAsyncTx(const std::lock_guard<std::mutex>& lock);
 
-  void packetRxCallbackBottomHalf(
-      SwitchSaiId switch_id,
+  void packetRxCallbackBottomHalf();
+  // Returns null for packets from unknown ports
+  std::unique_ptr<SaiRxPacket> createRxPacket(
       std::unique_ptr<folly::IOBuf> ioBuf,
-      std::vector<sai_attribute_t> attrList);
+      const std::vector<sai_attribute_t>& attrList) const;
   /*
    * SaiSwitch must support a few varieties of concurrent access:
    * 1. state updates on the SwSwitch update thread calling stateChanged
@@ -239,7 +222,8 @@ class SaiSwitch : public HwSwitch {
    * lock, but give a fast-path for 2, 3, 4, 5 in the form of possibly out
    * of date indices stored in folly::ConcurrentHashMaps in ConcurrentIndices
    * e.g., rx can look up the PortID from the sai_object_id_t on the
-   * packet without blocking normal hardware programming.
+   * packet, and tx the sai_object_id_t of its egress port, without blocking
+   * normal hardware programming.
    */
   mutable std::mutex saiSwitchMutex_;
   std::unique_ptr<ConcurrentIndices> concurrentIndices_;
@@ -265,6 +249,14 @@ class SaiSwitch : public HwSwitch {
   std::unique_ptr<std::thread> rxBottomHalfThread_;
   folly::EventBase rxBottomHalfEventBase_;
 
+  struct PendingRxPacket {
+    std::unique_ptr<folly::IOBuf> ioBuf;
+    std::vector<sai_attribute_t> attributes;
+  };
+  // Packets received by the top half, waiting for the bottom half
+  folly::Synchronized<std::vector<PendingRxPacket>, std::mutex>
+      pendingRxPackets_;
+
   std::unique_ptr<std::thread> asyncTxThread_;
   folly::EventBase asyncTxEventBase_;
 };
@@ -9,6 +9,7 @@
  */
 
 #include "fboss/agent/hw/sai/switch/SaiTxPacket.h"
+#include "fboss/agent/PacketBufferPool.h"
 #include "fboss/agent/hw/sai/switch/SaiPortManager.h"
 
 #include <folly/io/IOBuf.h>
@@ -16,8 +17,11 @@
 namespace facebook::fboss {
 
 SaiTxPacket::SaiTxPacket(uint32_t size) {
-  buf_ = folly::IOBuf::createSeparate(size);
-  buf_->append(size);
+  buf_ = PacketBufferPool::get()->allocate(size);
+}
+
+SaiTxPacket::~SaiTxPacket() {
+  PacketBufferPool::get()->recycle(std::move(buf_));
 }
 
 } // namespace facebook::fboss
@@ -18,6 +18,7 @@ namespace facebook::fboss {
 class SaiTxPacket : public TxPacket {
  public:
   explicit SaiTxPacket(uint32_t size);
+  ~SaiTxPacket() override;
 };
 
 } // namespace facebook::fboss
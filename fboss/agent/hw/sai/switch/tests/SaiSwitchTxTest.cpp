@@ -0,0 +1,174 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/TxPacket.h"
+#include "fboss/agent/hw/sai/fake/FakeSai.h"
+#include "fboss/agent/hw/sai/store/SaiStore.h"
+#include "fboss/agent/hw/sai/switch/SaiSwitch.h"
+#include "fboss/agent/hw/test/AgentConfigFactory.h"
+#include "fboss/agent/platforms/sai/SaiFakePlatform.h"
+#include "fboss/agent/state/Port.h"
+#include "fboss/agent/state/RouteUpdater.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/SwitchState.h"
+
+#include <folly/Singleton.h>
+#include <folly/io/Cursor.h>
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+
+namespace {
+// IEEE local experimental ethertype, which nothing in the pipeline acts on
+constexpr uint16_t kEthertype = 0x88b5;
+constexpr uint32_t kPktSize = 64;
+constexpr int kNumRoutes = 2000;
+constexpr int kNumRounds = 20;
+
+class NoopCallback : public HwSwitch::Callback {
+ public:
+  void packetReceived(std::unique_ptr<RxPacket> /* pkt */) noexcept override {}
+  void linkStateChanged(PortID /* port */, bool /* up */) override {}
+  void l2LearningUpdateReceived(
+      L2Entry /* l2Entry */,
+      L2EntryUpdateType /* l2EntryUpdateType */) override {}
+  void exitFatal() const noexcept override {}
+};
+} // namespace
+
+/*
+ * Packet TX in SaiSwitch does not take saiSwitchMutex_: it only reads
+ * ConcurrentIndices, which stateChanged updates as it adds and removes
+ * ports. Exercise that on fake SAI, sending packets from one thread while
+ * another repeatedly adds and removes a port and a batch of routes.
+ */
+class SaiSwitchTxTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    folly::SingletonVault::singleton()->destroyInstances();
+    folly::SingletonVault::singleton()->reenableInstances();
+    fs = FakeSai::getInstance();
+    auto productInfo =
+        std::make_unique<PlatformProductInfo>(FLAGS_fruid_filepath);
+    saiPlatform = std::make_unique<SaiFakePlatform>(std::move(productInfo));
+    auto agentConfig = std::make_unique<AgentConfig>(
+        utility::getAgentConfig(), "dummyConfigStr");
+    saiPlatform->init(std::move(agentConfig));
+    saiPlatform->initPorts();
+    // No RX or linkscan, only the async TX thread
+    saiSwitch = std::make_unique<SaiSwitch>(saiPlatform.get(), 0);
+    saiSwitch->init(&callback);
+    saiSwitch->switchRunStateChanged(SwitchRunState::INITIALIZED);
+    saiSwitch->switchRunStateChanged(SwitchRunState::CONFIGURED);
+  }
+
+  void TearDown() override {
+    saiSwitch.reset();
+    SaiStore::getInstance()->release();
+    FakeSai::clear();
+  }
+
+  std::shared_ptr<Port> makePort(PortID id) const {
+    auto swPort = std::make_shared<Port>(id, folly::sformat("port{}", id));
+    swPort->setAdminState(cfg::PortState::ENABLED);
+    swPort->setSpeed(cfg::PortSpeed::TWENTYFIVEG);
+    return swPort;
+  }
+
+  std::shared_ptr<SwitchState> makeState(
+      const std::vector<std::shared_ptr<Port>>& ports,
+      int numRoutes) const {
+    auto state = std::make_shared<SwitchState>();
+    for (const auto& port : ports) {
+      state->addPort(port);
+    }
+    if (!numRoutes) {
+      state->publish();
+      return state;
+    }
+    RouteUpdater updater(state->getRouteTables());
+    for (int i = 0; i < numRoutes; ++i) {
+      updater.addRoute(
+          RouterID(0),
+          folly::IPAddressV4::fromLongHBO(0x0a010000 + i),
+          32,
+          ClientID(1001),
+          RouteNextHopEntry(
+              RouteForwardAction::DROP, AdminDistance::STATIC_ROUTE));
+    }
+    state->resetRouteTables(updater.updateDone());
+    state->publish();
+    return state;
+  }
+
+  std::unique_ptr<TxPacket> makePacket() const {
+    auto pkt = saiSwitch->allocatePacket(kPktSize);
+    memset(pkt->buf()->writableData(), 0, kPktSize);
+    folly::io::RWPrivateCursor cursor(pkt->buf());
+    TxPacket::writeEthHeader(
+        &cursor,
+        folly::MacAddress("02:00:00:00:00:01"),
+        folly::MacAddress("02:00:00:00:00:02"),
+        kEthertype);
+    return pkt;
+  }
+
+  std::shared_ptr<FakeSai> fs;
+  std::unique_ptr<SaiPlatform> saiPlatform;
+  std::unique_ptr<SaiSwitch> saiSwitch;
+  NoopCallback callback;
+};
+
+TEST_F(SaiSwitchTxTest, txDuringPortAndRouteChanges) {
+  auto txPort = makePort(PortID(0));
+  auto churnPort = makePort(PortID(1));
+  auto empty = std::make_shared<SwitchState>();
+  empty->publish();
+  auto base = makeState({txPort}, 0);
+  auto churned = makeState({txPort, churnPort}, kNumRoutes);
+  saiSwitch->stateChanged(StateDelta(empty, base));
+
+  // Odd while a stateChanged call is in progress
+  std::atomic<uint64_t> generation{0};
+  std::atomic<bool> done{false};
+  std::thread programmer([&]() {
+    auto current = base;
+    for (int i = 0; i < 2 * kNumRounds; ++i) {
+      // Alternately add and remove churnPort and the routes
+      auto next = current == base ? churned : base;
+      ++generation;
+      saiSwitch->stateChanged(StateDelta(current, next));
+      ++generation;
+      current = next;
+    }
+    done = true;
+  });
+
+  uint64_t sentDuringStateChanged = 0;
+  while (!done) {
+    auto before = generation.load();
+    EXPECT_TRUE(
+        saiSwitch->sendPacketOutOfPortSync(makePacket(), txPort->getID()));
+    EXPECT_TRUE(saiSwitch->sendPacketOutOfPortAsync(
+        makePacket(), txPort->getID(), std::nullopt));
+    auto after = generation.load();
+    // Only sends that started and finished inside one stateChanged count
+    if (before == after && before % 2) {
+      ++sentDuringStateChanged;
+    }
+  }
+  programmer.join();
+
+  EXPECT_GT(sentDuringStateChanged, 0);
+}
@@ -87,6 +87,10 @@ void SimSwitch::injectPacket(std::unique_ptr<RxPacket> pkt) {
   callback_->packetReceived(std::move(pkt));
 }
 
+void SimSwitch::injectPackets(std::vector<std::unique_ptr<RxPacket>> pkts) {
+  callback_->packetsReceived(folly::range(pkts));
+}
+
 folly::dynamic SimSwitch::toFollyDynamic() const {
   return folly::dynamic::object;
 }
@@ -12,6 +12,7 @@
 #include "fboss/agent/HwSwitch.h"
 
 #include <optional>
+#include <vector>
 
 namespace facebook {
 namespace fboss {
@@ -40,6 +41,7 @@ class SimSwitch : public HwSwitch {
   folly::dynamic toFollyDynamic() const override;
 
   void injectPacket(std::unique_ptr<RxPacket> pkt);
+  void injectPackets(std::vector<std::unique_ptr<RxPacket>> pkts);
   void switchRunStateChanged(SwitchRunState newState) override {}
 
   // TODO
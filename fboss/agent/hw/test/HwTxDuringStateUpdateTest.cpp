@@ -0,0 +1,81 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/HwSwitch.h"
+#include "fboss/agent/TxPacket.h"
+#include "fboss/agent/hw/test/ConfigFactory.h"
+#include "fboss/agent/hw/test/HwTest.h"
+#include "fboss/agent/hw/test/HwTestStatUtils.h"
+#include "fboss/agent/test/RouteScaleGenerators.h"
+
+#include <folly/io/Cursor.h>
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace {
+// IEEE local experimental ethertype, which nothing in the pipeline acts on
+constexpr uint16_t kEthertype = 0x88b5;
+constexpr uint32_t kPktSize = 64;
+} // namespace
+
+namespace facebook {
+namespace fboss {
+
+/*
+ * Control plane TX must not wait for state programming. Send packets out of
+ * a port while a large route update is being programmed, and check that
+ * sends complete while the update is still in progress.
+ */
+TEST_F(HwTest, txDuringRouteProgramming) {
+  applyNewConfig(
+      utility::onePortPerVlanConfig(getHwSwitch(), masterLogicalPortIds()));
+  auto desiredState = utility::FSWRouteScaleGenerator(getProgrammedState())
+                          .getSwitchStates()
+                          .back();
+  auto port = masterLogicalPortIds()[0];
+  auto sendPacket = [this, port]() {
+    auto pkt = getHwSwitch()->allocatePacket(kPktSize);
+    memset(pkt->buf()->writableData(), 0, kPktSize);
+    folly::io::RWPrivateCursor cursor(pkt->buf());
+    TxPacket::writeEthHeader(
+        &cursor,
+        folly::MacAddress("02:00:00:00:00:01"),
+        folly::MacAddress("02:00:00:00:00:02"),
+        kEthertype);
+    EXPECT_TRUE(getHwSwitch()->sendPacketOutOfPortSync(std::move(pkt), port));
+  };
+  auto outPktsBefore = getPortOutPkts(getLatestPortStats(port));
+
+  std::atomic<bool> programming{true};
+  std::thread programmer([this, &desiredState, &programming]() {
+    applyNewState(desiredState);
+    programming = false;
+  });
+  uint64_t sent = 0;
+  uint64_t sentWhileProgramming = 0;
+  while (programming) {
+    sendPacket();
+    ++sent;
+    if (programming) {
+      ++sentWhileProgramming;
+    }
+  }
+  programmer.join();
+
+  // Only sends that both started and finished during programming count
+  EXPECT_GT(sentWhileProgramming, 1);
+  auto outPktsAfter = getPortOutPkts(getLatestPortStats(port));
+  EXPECT_GE(outPktsAfter - outPktsBefore, sent);
+}
+
+} // namespace fboss
+} // namespace facebook
@@ -380,6 +380,12 @@ struct RxCaptureFilter {
 
 struct CaptureFilter {
   1: RxCaptureFilter rxCaptureFilter;
+  /*
+   * A tcpdump style filter expression, e.g. "arp and dst net 10.0.0.0/8".
+   * Only the packets it matches are captured.  Empty matches every packet.
+   * See capture/BpfFilter.h for the supported primitives.
+   */
+  2: string bpfExpression
 }
 
 struct CaptureInfo {
@@ -446,6 +452,30 @@ struct LinkNeighborThrift {
   15: optional string localPortName
 }
 
+/*
+ * Where the time of a state update went, see SwSwitch::handlePendingUpdates().
+ * Durations are in microseconds.
+ */
+struct StateUpdateTrace {
+  // Name of the first of the coalesced StateUpdates
+  1: string name
+  // Number of StateUpdates coalesced into this update
+  2: i32 coalescedUpdates
+  // Start of the update, in milliseconds since the epoch
+  3: i64 startTimeMs
+  // Running the StateUpdate functions
+  4: i64 updateFnsUs
+  // Publishing the states they returned
+  5: i64 publishUs
+  // Computing the StateDelta
+  6: i64 deltaUs
+  // HwSwitch::stateChanged()
+  7: i64 hwUs
+  // Notifying the state observers
+  8: i64 observersUs
+  9: i64 totalUs
+}
+
 enum ClientID {
   BGPD = 0,
   STATIC_ROUTE = 1,
@@ -797,6 +827,12 @@ service FbossCtrl extends fb303.FacebookService {
   */
   SwitchRunState getSwitchRunState()
 
+  /*
+   * Traces of the last (up to count) state updates, most recent first
+   */
+  list<StateUpdateTrace> getStateUpdateTraces(1: i32 count)
+    throws (1: fboss.FbossBaseError error)
+
   SSLType getSSLPolicy()
     throws (1: fboss.FbossBaseError error)
 }
@@ -0,0 +1,358 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+/*
+ * Non-owning views of packet headers.
+ *
+ * The owned header structs (EthHdr, ArpHdr, IPv4Hdr, ...) copy and convert
+ * every field when they are constructed, which is wasted work for trapped
+ * packets that are dropped after looking at one or two fields. A view just
+ * points at the header bytes in the packet buffer, and reads a field only
+ * when it is asked for.
+ *
+ * Views must not outlive the buffer they were parsed from.
+ */
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+#include <folly/MacAddress.h>
+#include <folly/Range.h>
+#include <folly/io/Cursor.h>
+#include <folly/lang/Bits.h>
+#include "fboss/agent/packet/Ethertype.h"
+#include "fboss/agent/packet/HdrParseError.h"
+
+#include <array>
+
+namespace facebook {
+namespace fboss {
+
+template <size_t kMaxSize>
+class HdrView {
+ public:
+  enum { MAX_SIZE = kMaxSize };
+  /*
+   * Space for a copy of a header which is split across IOBufs.
+   */
+  using Scratch = std::array<uint8_t, kMaxSize>;
+
+ protected:
+  explicit HdrView(const uint8_t* data) : data_(data) {}
+
+  /*
+   * Return a pointer to the next len bytes at the cursor, and advance the
+   * cursor past them. The bytes are only copied, to scratch, in the rare case
+   * they don't all live in the cursor's current IOBuf.
+   */
+  static const uint8_t*
+  pull(folly::io::Cursor* cursor, size_t len, uint8_t* scratch) {
+    if (LIKELY(cursor->length() >= len)) {
+      auto data = cursor->data();
+      cursor->skip(len);
+      return data;
+    }
+    if (!cursor->canAdvance(len)) {
+      throw HdrParseError("header too small");
+    }
+    cursor->pull(scratch, len);
+    return scratch;
+  }
+
+  uint8_t read8(size_t offset) const {
+    return data_[offset];
+  }
+  uint16_t read16(size_t offset) const {
+    return folly::Endian::big(folly::loadUnaligned<uint16_t>(data_ + offset));
+  }
+  uint32_t read32(size_t offset) const {
+    return folly::Endian::big(folly::loadUnaligned<uint32_t>(data_ + offset));
+  }
+  folly::MacAddress readMac(size_t offset) const {
+    return folly::MacAddress::fromBinary(
+        folly::ByteRange(data_ + offset, folly::MacAddress::SIZE));
+  }
+  folly::IPAddressV4 readIPv4(size_t offset) const {
+    return folly::IPAddressV4::fromLong(
+        folly::loadUnaligned<uint32_t>(data_ + offset));
+  }
+  folly::IPAddressV6 readIPv6(size_t offset) const {
+    return folly::IPAddressV6::fromBinary(
+        folly::ByteRange(data_ + offset, folly::IPAddressV6::byteCount()));
+  }
+
+  const uint8_t* data_;
+};
+
+/*
+ * An Ethernet header, with at most one 802.1Q tag.
+ */
+class EthHdrView : public HdrView<18> {
+ public:
+  enum { UNTAGGED_SIZE = 14 };
+
+  static EthHdrView parse(folly::io::Cursor* cursor, Scratch* scratch) {
+    size_t len = isTagged(*cursor) ? MAX_SIZE : UNTAGGED_SIZE;
+    return EthHdrView(pull(cursor, len, scratch->data()), len);
+  }
+
+  folly::MacAddress dstAddr() const {
+    return readMac(0);
+  }
+  folly::MacAddress srcAddr() const {
+    return readMac(6);
+  }
+  bool tagged() const {
+    return size_ == MAX_SIZE;
+  }
+  /*
+   * The ethertype of the payload, after any 802.1Q tag.
+   */
+  uint16_t etherType() const {
+    return read16(size_ - 2);
+  }
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  EthHdrView(const uint8_t* data, size_t size) : HdrView(data), size_(size) {}
+
+  static bool isTagged(const folly::io::Cursor& cursor) {
+    constexpr auto kVlan = static_cast<uint16_t>(ETHERTYPE::ETHERTYPE_VLAN);
+    if (LIKELY(cursor.length() >= UNTAGGED_SIZE)) {
+      return folly::Endian::big(folly::loadUnaligned<uint16_t>(
+                 cursor.data() + 12)) == kVlan;
+    }
+    folly::io::Cursor tpid(cursor);
+    if (!tpid.canAdvance(UNTAGGED_SIZE)) {
+      throw HdrParseError("Ethernet header too small");
+    }
+    tpid.skip(12);
+    return tpid.readBE<uint16_t>() == kVlan;
+  }
+
+  size_t size_;
+};
+
+/*
+ * An Ethernet/IPv4 Address Resolution Protocol header. The address fields are
+ * only meaningful once the caller has checked htype, ptype, hlen and plen.
+ */
+class ArpHdrView : public HdrView<28> {
+ public:
+  static ArpHdrView parse(folly::io::Cursor* cursor, Scratch* scratch) {
+    return ArpHdrView(pull(cursor, MAX_SIZE, scratch->data()));
+  }
+
+  uint16_t htype() const {
+    return read16(0);
+  }
+  uint16_t ptype() const {
+    return read16(2);
+  }
+  uint8_t hlen() const {
+    return read8(4);
+  }
+  uint8_t plen() const {
+    return read8(5);
+  }
+  uint16_t oper() const {
+    return read16(6);
+  }
+  folly::MacAddress sha() const {
+    return readMac(8);
+  }
+  folly::IPAddressV4 spa() const {
+    return readIPv4(14);
+  }
+  folly::MacAddress tha() const {
+    return readMac(18);
+  }
+  folly::IPAddressV4 tpa() const {
+    return readIPv4(24);
+  }
+
+ private:
+  explicit ArpHdrView(const uint8_t* data) : HdrView(data) {}
+};
+
+/*
+ * An IPv4 header. parse() rejects the same headers as IPv4Hdr's parsing
+ * constructor, and skips over any options.
+ */
+class IPv4HdrView : public HdrView<20> {
+ public:
+  static IPv4HdrView parse(folly::io::Cursor* cursor, Scratch* scratch) {
+    IPv4HdrView hdr(pull(cursor, MAX_SIZE, scratch->data()));
+    if (hdr.version() != 4) {
+      throw HdrParseError("IPv4: version != 4");
+    }
+    if (hdr.ihl() < 5) {
+      throw HdrParseError("IPv4: IHL < 5");
+    }
+    if (hdr.length() < hdr.size()) {
+      throw HdrParseError("IPv4: total length < ihl * 4");
+    }
+    if (hdr.ttl() == 0) {
+      throw HdrParseError("IPv4: TTL == 0");
+    }
+    if (UNLIKELY(hdr.ihl() > 5)) {
+      size_t optionsLen = (hdr.ihl() - 5) * sizeof(uint32_t);
+      if (!cursor->canAdvance(optionsLen)) {
+        throw HdrParseError("IPv4 header too small");
+      }
+      cursor->skip(optionsLen);
+    }
+    return hdr;
+  }
+
+  uint8_t version() const {
+    return read8(0) >> 4;
+  }
+  uint8_t ihl() const {
+    return read8(0) & 0x0F;
+  }
+  /*
+   * The size of the header in bytes, including options
+   */
+  size_t size() const {
+    return ihl() * sizeof(uint32_t);
+  }
+  uint8_t dscp() const {
+    return read8(1) >> 2;
+  }
+  uint8_t ecn() const {
+    return read8(1) & 0x03;
+  }
+  uint16_t length() const {
+    return read16(2);
+  }
+  uint16_t id() const {
+    return read16(4);
+  }
+  bool dontFragment() const {
+    return read8(6) & 0x40;
+  }
+  bool moreFragments() const {
+    return read8(6) & 0x20;
+  }
+  uint16_t fragmentOffset() const {
+    return read16(6) & 0x1FFF;
+  }
+  uint8_t ttl() const {
+    return read8(8);
+  }
+  uint8_t protocol() const {
+    return read8(9);
+  }
+  uint16_t csum() const {
+    return read16(10);
+  }
+  folly::IPAddressV4 srcAddr() const {
+    return readIPv4(12);
+  }
+  folly::IPAddressV4 dstAddr() const {
+    return readIPv4(16);
+  }
+
+ private:
+  explicit IPv4HdrView(const uint8_t* data) : HdrView(data) {}
+};
+
+/*
+ * An IPv6 header. Extension headers are not represented here.
+ */
+class IPv6HdrView : public HdrView<40> {
+ public:
+  static IPv6HdrView parse(folly::io::Cursor* cursor, Scratch* scratch) {
+    IPv6HdrView hdr(pull(cursor, MAX_SIZE, scratch->data()));
+    if (hdr.version() != 6) {
+      throw HdrParseError("IPv6: version != 6");
+    }
+    return hdr;
+  }
+
+  uint8_t version() const {
+    return read8(0) >> 4;
+  }
+  uint8_t trafficClass() const {
+    return (read16(0) >> 4) & 0xFF;
+  }
+  uint32_t flowLabel() const {
+    return read32(0) & 0xFFFFF;
+  }
+  uint16_t payloadLength() const {
+    return read16(4);
+  }
+  uint8_t nextHeader() const {
+    return read8(6);
+  }
+  uint8_t hopLimit() const {
+    return read8(7);
+  }
+  folly::IPAddressV6 srcAddr() const {
+    return readIPv6(8);
+  }
+  folly::IPAddressV6 dstAddr() const {
+    return readIPv6(24);
+  }
+
+ private:
+  explicit IPv6HdrView(const uint8_t* data) : HdrView(data) {}
+};
+
+/*
+ * The ICMP (v4 or v6) header common to all message types.
+ */
+class ICMPHdrView : public HdrView<4> {
+ public:
+  static ICMPHdrView parse(folly::io::Cursor* cursor, Scratch* scratch) {
+    return ICMPHdrView(pull(cursor, MAX_SIZE, scratch->data()));
+  }
+
+  uint8_t type() const {
+    return read8(0);
+  }
+  uint8_t code() const {
+    return read8(1);
+  }
+  uint16_t csum() const {
+    return read16(2);
+  }
+
+ private:
+  explicit ICMPHdrView(const uint8_t* data) : HdrView(data) {}
+};
+
+class UDPHdrView : public HdrView<8> {
+ public:
+  static UDPHdrView parse(folly::io::Cursor* cursor, Scratch* scratch) {
+    return UDPHdrView(pull(cursor, MAX_SIZE, scratch->data()));
+  }
+
+  uint16_t srcPort() const {
+    return read16(0);
+  }
+  uint16_t dstPort() const {
+    return read16(2);
+  }
+  uint16_t length() const {
+    return read16(4);
+  }
+  uint16_t csum() const {
+    return read16(6);
+  }
+
+ private:
+  explicit UDPHdrView(const uint8_t* data) : HdrView(data) {}
+};
+
+} // namespace fboss
+} // namespace facebook
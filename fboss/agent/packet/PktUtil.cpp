@@ -14,8 +14,16 @@
 #include <folly/IPAddressV6.h>
 #include <folly/MacAddress.h>
 #include <folly/io/Cursor.h>
+#include <folly/lang/Bits.h>
 #include "fboss/agent/FbossError.h"
 
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 using folly::ByteRange;
 using folly::IOBuf;
 using folly::IPAddressV4;
@@ -26,6 +34,93 @@ using folly::io::Appender;
 using folly::io::Cursor;
 using std::string;
 
+namespace {
+
+#if defined(__AVX2__)
+using Vector = __m256i;
+#define VECTOR_ZERO _mm256_setzero_si256
+#define VECTOR_LOAD _mm256_loadu_si256
+#define VECTOR_STORE _mm256_storeu_si256
+#define VECTOR_ADD32 _mm256_add_epi32
+#define VECTOR_UNPACKLO16 _mm256_unpacklo_epi16
+#define VECTOR_UNPACKHI16 _mm256_unpackhi_epi16
+#elif defined(__SSE2__)
+using Vector = __m128i;
+#define VECTOR_ZERO _mm_setzero_si128
+#define VECTOR_LOAD _mm_loadu_si128
+#define VECTOR_STORE _mm_storeu_si128
+#define VECTOR_ADD32 _mm_add_epi32
+#define VECTOR_UNPACKLO16 _mm_unpacklo_epi16
+#define VECTOR_UNPACKHI16 _mm_unpackhi_epi16
+#endif
+
+#ifdef VECTOR_ZERO
+/*
+ * Each iteration adds up to 2 16 bit words to each 32 bit lane, so lanes
+ * are flushed before they can overflow.
+ */
+constexpr size_t kMaxVectorIterations = 32767;
+
+uint64_t sumVectors(const uint8_t** data, size_t* length) {
+  const Vector zero = VECTOR_ZERO();
+  uint64_t sum = 0;
+  while (*length >= sizeof(Vector)) {
+    auto iterations =
+        std::min(*length / sizeof(Vector), kMaxVectorIterations);
+    Vector lanes = zero;
+    for (size_t i = 0; i < iterations; ++i) {
+      auto words = VECTOR_LOAD(reinterpret_cast<const Vector*>(*data));
+      lanes = VECTOR_ADD32(lanes, VECTOR_UNPACKLO16(words, zero));
+      lanes = VECTOR_ADD32(lanes, VECTOR_UNPACKHI16(words, zero));
+      *data += sizeof(Vector);
+    }
+    *length -= iterations * sizeof(Vector);
+
+    uint32_t laneSums[sizeof(Vector) / sizeof(uint32_t)];
+    VECTOR_STORE(reinterpret_cast<Vector*>(laneSums), lanes);
+    for (auto laneSum : laneSums) {
+      sum += laneSum;
+    }
+  }
+  return sum;
+}
+#endif
+
+/*
+ * Ones' complement sum of the 16 bit words of a contiguous range with an even
+ * length, in network byte order.
+ *
+ * The words are added up in host byte order, several at a time: the sum is
+ * independent of byte order and word size once the carries are folded back in
+ * (RFC 1071 section 2).
+ */
+uint16_t sumWords(const uint8_t* data, size_t length) {
+  uint64_t sum = 0;
+#ifdef VECTOR_ZERO
+  sum += sumVectors(&data, &length);
+#endif
+  while (length >= sizeof(uint64_t)) {
+    uint64_t words;
+    memcpy(&words, data, sizeof(words));
+    sum += (words & 0xffffffff) + (words >> 32);
+    data += sizeof(words);
+    length -= sizeof(words);
+  }
+  while (length >= sizeof(uint16_t)) {
+    uint16_t word;
+    memcpy(&word, data, sizeof(word));
+    sum += word;
+    data += sizeof(word);
+    length -= sizeof(word);
+  }
+  while (sum >> 16) {
+    sum = (sum & 0xffff) + (sum >> 16);
+  }
+  return folly::Endian::big(static_cast<uint16_t>(sum));
+}
+
+} // namespace
+
 namespace facebook {
 namespace fboss {
 
@@ -81,10 +176,19 @@ uint32_t PktUtil::partialChecksumImpl(
     folly::io::Cursor cursor,
     uint64_t length,
     uint32_t value) {
-  // Checksum all the pairs of bytes first
+  // Checksum all the pairs of bytes first, one IOBuf at a time
   while (length > 1) {
-    value += cursor.readBE<uint16_t>();
-    length -= 2;
+    auto bytes = cursor.peekBytes();
+    auto contiguous = std::min<uint64_t>(bytes.size(), length) & ~1ULL;
+    if (contiguous == 0) {
+      // The next pair of bytes straddles two IOBufs
+      value += cursor.readBE<uint16_t>();
+      length -= 2;
+      continue;
+    }
+    value += sumWords(bytes.data(), contiguous);
+    cursor.skip(contiguous);
+    length -= contiguous;
   }
   if (length) {
     // Bytes are interpreted in n/w byte order
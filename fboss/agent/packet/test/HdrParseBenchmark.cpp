@@ -0,0 +1,162 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/packet/ArpHdr.h"
+#include "fboss/agent/packet/EthHdr.h"
+#include "fboss/agent/packet/HdrViews.h"
+#include "fboss/agent/packet/ICMPHdr.h"
+#include "fboss/agent/packet/IPv4Hdr.h"
+#include "fboss/agent/packet/IPv6Hdr.h"
+#include "fboss/agent/packet/PktUtil.h"
+#include "fboss/agent/packet/UDPHeader.h"
+
+#include <folly/Benchmark.h>
+#include <folly/io/Cursor.h>
+
+#include <gflags/gflags.h>
+
+using namespace facebook::fboss;
+using folly::io::Cursor;
+
+/*
+ * Compares parsing the headers of the packets most commonly trapped to the
+ * CPU into the owned header structs against parsing them into header views.
+ * Each benchmark reads the fields that the agent looks at to dispatch and
+ * handle the packet.
+ */
+
+namespace {
+
+// Just the headers of each frame, the payload is never looked at
+const folly::IOBuf kArpRequest = PktUtil::parseHexData(
+    // Ethernet Header
+    "ff ff ff ff ff ff 10 dd b1 bb 5a ef 81 00 00 05 08 06"
+    // ARP Header
+    "00 01 08 00 06 04 00 01 10 dd b1 bb 5a ef 0a 00 00 0f"
+    "00 00 00 00 00 00 0a 00 00 01");
+
+const folly::IOBuf kNeighborSolicitation = PktUtil::parseHexData(
+    // Ethernet Header
+    "33 33 ff 00 00 02 10 dd b1 bb 5a ef 81 00 00 05 86 dd"
+    // IPv6 Header
+    "60 00 00 00 00 20 3a ff"
+    "fe 80 00 00 00 00 00 00 00 00 00 00 00 00 00 01"
+    "ff 02 00 00 00 00 00 00 00 00 00 01 ff 00 00 02"
+    // ICMPv6 Header
+    "87 00 12 34");
+
+const folly::IOBuf kDhcpDiscover = PktUtil::parseHexData(
+    // Ethernet Header
+    "ff ff ff ff ff ff 10 dd b1 bb 5a ef 81 00 00 05 08 00"
+    // IPv4 Header
+    "45 00 01 48 00 00 00 00 40 11 00 00"
+    "00 00 00 00 ff ff ff ff"
+    // UDP Header
+    "00 44 00 43 01 34 00 00");
+
+} // namespace
+
+BENCHMARK(ArpOwned, numIters) {
+  for (size_t n = 0; n < numIters; ++n) {
+    Cursor cursor(&kArpRequest);
+    EthHdr ethHdr(cursor);
+    ArpHdr arpHdr(cursor);
+    folly::doNotOptimizeAway(ethHdr.etherType);
+    folly::doNotOptimizeAway(arpHdr.htype + arpHdr.ptype + arpHdr.oper);
+    folly::doNotOptimizeAway(arpHdr.sha);
+    folly::doNotOptimizeAway(arpHdr.spa);
+    folly::doNotOptimizeAway(arpHdr.tpa);
+  }
+}
+
+BENCHMARK_RELATIVE(ArpView, numIters) {
+  for (size_t n = 0; n < numIters; ++n) {
+    Cursor cursor(&kArpRequest);
+    EthHdrView::Scratch ethScratch;
+    auto ethHdr = EthHdrView::parse(&cursor, &ethScratch);
+    ArpHdrView::Scratch arpScratch;
+    auto arpHdr = ArpHdrView::parse(&cursor, &arpScratch);
+    folly::doNotOptimizeAway(ethHdr.etherType());
+    folly::doNotOptimizeAway(arpHdr.htype() + arpHdr.ptype() + arpHdr.oper());
+    folly::doNotOptimizeAway(arpHdr.sha());
+    folly::doNotOptimizeAway(arpHdr.spa());
+    folly::doNotOptimizeAway(arpHdr.tpa());
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(NdpOwned, numIters) {
+  for (size_t n = 0; n < numIters; ++n) {
+    Cursor cursor(&kNeighborSolicitation);
+    EthHdr ethHdr(cursor);
+    IPv6Hdr ipv6Hdr(cursor);
+    ICMPHdr icmpHdr(cursor);
+    folly::doNotOptimizeAway(ethHdr.etherType);
+    folly::doNotOptimizeAway(ipv6Hdr.nextHeader + ipv6Hdr.hopLimit);
+    folly::doNotOptimizeAway(ipv6Hdr.srcAddr);
+    folly::doNotOptimizeAway(ipv6Hdr.dstAddr);
+    folly::doNotOptimizeAway(icmpHdr.type);
+  }
+}
+
+BENCHMARK_RELATIVE(NdpView, numIters) {
+  for (size_t n = 0; n < numIters; ++n) {
+    Cursor cursor(&kNeighborSolicitation);
+    EthHdrView::Scratch ethScratch;
+    auto ethHdr = EthHdrView::parse(&cursor, &ethScratch);
+    IPv6HdrView::Scratch ipv6Scratch;
+    auto ipv6Hdr = IPv6HdrView::parse(&cursor, &ipv6Scratch);
+    ICMPHdrView::Scratch icmpScratch;
+    auto icmpHdr = ICMPHdrView::parse(&cursor, &icmpScratch);
+    folly::doNotOptimizeAway(ethHdr.etherType());
+    folly::doNotOptimizeAway(ipv6Hdr.nextHeader() + ipv6Hdr.hopLimit());
+    folly::doNotOptimizeAway(ipv6Hdr.srcAddr());
+    folly::doNotOptimizeAway(ipv6Hdr.dstAddr());
+    folly::doNotOptimizeAway(icmpHdr.type());
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(DhcpOwned, numIters) {
+  for (size_t n = 0; n < numIters; ++n) {
+    Cursor cursor(&kDhcpDiscover);
+    EthHdr ethHdr(cursor);
+    IPv4Hdr ipv4Hdr(cursor);
+    UDPHeader udpHdr;
+    udpHdr.parse(&cursor);
+    folly::doNotOptimizeAway(ethHdr.etherType);
+    folly::doNotOptimizeAway(ipv4Hdr.protocol + ipv4Hdr.ttl);
+    folly::doNotOptimizeAway(ipv4Hdr.dstAddr);
+    folly::doNotOptimizeAway(udpHdr.srcPort + udpHdr.dstPort);
+  }
+}
+
+BENCHMARK_RELATIVE(DhcpView, numIters) {
+  for (size_t n = 0; n < numIters; ++n) {
+    Cursor cursor(&kDhcpDiscover);
+    EthHdrView::Scratch ethScratch;
+    auto ethHdr = EthHdrView::parse(&cursor, &ethScratch);
+    IPv4HdrView::Scratch ipv4Scratch;
+    auto ipv4Hdr = IPv4HdrView::parse(&cursor, &ipv4Scratch);
+    UDPHdrView::Scratch udpScratch;
+    auto udpHdr = UDPHdrView::parse(&cursor, &udpScratch);
+    folly::doNotOptimizeAway(ethHdr.etherType());
+    folly::doNotOptimizeAway(ipv4Hdr.protocol() + ipv4Hdr.ttl());
+    folly::doNotOptimizeAway(ipv4Hdr.dstAddr());
+    folly::doNotOptimizeAway(udpHdr.srcPort() + udpHdr.dstPort());
+  }
+}
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,205 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/packet/HdrViews.h"
+
+#include <gtest/gtest.h>
+
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+#include <folly/MacAddress.h>
+#include <folly/io/Cursor.h>
+#include <folly/io/IOBuf.h>
+
+#include "fboss/agent/packet/PktUtil.h"
+
+using namespace facebook::fboss;
+using folly::IPAddressV4;
+using folly::IPAddressV6;
+using folly::MacAddress;
+using folly::io::Cursor;
+
+namespace {
+
+const char* kArpRequest =
+    // Ethernet Header
+    "ff ff ff ff ff ff" // Destination MAC Address
+    "10 dd b1 bb 5a ef" // Source MAC Address
+    "81 00 00 05" // 802.1Q Tag: VLAN 5
+    "08 06" // EtherType: ARP
+    // ARP Header
+    "00 01" // HTYPE: Ethernet (1)
+    "08 00" // PTYPE: IPv4 (0x0800)
+    "06" // HLEN:  6
+    "04" // PLEN:  4
+    "00 01" // OPER:  Request
+    "10 dd b1 bb 5a ef" // Sender Hardware Address
+    "0a 00 00 0f" // Sender Protocol Address: 10.0.0.15
+    "00 00 00 00 00 00" // Target Hardware Address
+    "0a 00 00 01"; // Target Protocol Address: 10.0.0.1
+
+} // namespace
+
+TEST(HdrViewsTest, Arp) {
+  auto buf = PktUtil::parseHexData(kArpRequest);
+  Cursor cursor(&buf);
+  EthHdrView::Scratch ethScratch;
+  auto ethHdr = EthHdrView::parse(&cursor, &ethScratch);
+  EXPECT_EQ(MacAddress("ff:ff:ff:ff:ff:ff"), ethHdr.dstAddr());
+  EXPECT_EQ(MacAddress("10:dd:b1:bb:5a:ef"), ethHdr.srcAddr());
+  EXPECT_TRUE(ethHdr.tagged());
+  EXPECT_EQ(0x0806, ethHdr.etherType());
+  EXPECT_EQ(18, ethHdr.size());
+
+  ArpHdrView::Scratch arpScratch;
+  auto arpHdr = ArpHdrView::parse(&cursor, &arpScratch);
+  EXPECT_EQ(1, arpHdr.htype());
+  EXPECT_EQ(0x0800, arpHdr.ptype());
+  EXPECT_EQ(6, arpHdr.hlen());
+  EXPECT_EQ(4, arpHdr.plen());
+  EXPECT_EQ(1, arpHdr.oper());
+  EXPECT_EQ(MacAddress("10:dd:b1:bb:5a:ef"), arpHdr.sha());
+  EXPECT_EQ(IPAddressV4("10.0.0.15"), arpHdr.spa());
+  EXPECT_EQ(MacAddress("00:00:00:00:00:00"), arpHdr.tha());
+  EXPECT_EQ(IPAddressV4("10.0.0.1"), arpHdr.tpa());
+  EXPECT_TRUE(cursor.isAtEnd());
+}
+
+TEST(HdrViewsTest, IPv4Udp) {
+  auto buf = PktUtil::parseHexData(
+      // IPv4 Header
+      "46" // Version(4), IHL(6)
+      "b8" // DSCP(46), ECN(0)
+      "00 24" // Total Length: 36
+      "12 34" // Identification
+      "40 00" // Flags: DF, Fragment Offset: 0
+      "40" // TTL: 64
+      "11" // Protocol: UDP
+      "ab cd" // Checksum
+      "0a 00 00 0f" // Source Address: 10.0.0.15
+      "0a 00 00 01" // Destination Address: 10.0.0.1
+      "01 01 01 01" // Options
+      // UDP Header
+      "00 44" // Source Port: 68
+      "00 43" // Destination Port: 67
+      "00 08" // Length: 8
+      "12 34" // Checksum
+  );
+  Cursor cursor(&buf);
+  IPv4HdrView::Scratch ipScratch;
+  auto ipHdr = IPv4HdrView::parse(&cursor, &ipScratch);
+  EXPECT_EQ(4, ipHdr.version());
+  EXPECT_EQ(6, ipHdr.ihl());
+  EXPECT_EQ(46, ipHdr.dscp());
+  EXPECT_EQ(0, ipHdr.ecn());
+  EXPECT_EQ(36, ipHdr.length());
+  EXPECT_EQ(0x1234, ipHdr.id());
+  EXPECT_TRUE(ipHdr.dontFragment());
+  EXPECT_FALSE(ipHdr.moreFragments());
+  EXPECT_EQ(0, ipHdr.fragmentOffset());
+  EXPECT_EQ(64, ipHdr.ttl());
+  EXPECT_EQ(17, ipHdr.protocol());
+  EXPECT_EQ(0xabcd, ipHdr.csum());
+  EXPECT_EQ(IPAddressV4("10.0.0.15"), ipHdr.srcAddr());
+  EXPECT_EQ(IPAddressV4("10.0.0.1"), ipHdr.dstAddr());
+
+  // The options are skipped over
+  UDPHdrView::Scratch udpScratch;
+  auto udpHdr = UDPHdrView::parse(&cursor, &udpScratch);
+  EXPECT_EQ(68, udpHdr.srcPort());
+  EXPECT_EQ(67, udpHdr.dstPort());
+  EXPECT_EQ(8, udpHdr.length());
+  EXPECT_EQ(0x1234, udpHdr.csum());
+  EXPECT_TRUE(cursor.isAtEnd());
+}
+
+TEST(HdrViewsTest, IPv6Icmp) {
+  auto buf = PktUtil::parseHexData(
+      // IPv6 Header
+      "6e 01 23 45" // Version(6), Traffic Class(0xe0), Flow Label(0x12345)
+      "00 04" // Payload Length: 4
+      "3a" // Next Header: ICMPv6
+      "ff" // Hop Limit: 255
+      "fe 80 00 00 00 00 00 00 00 00 00 00 00 00 00 01" // Source Address
+      "ff 02 00 00 00 00 00 00 00 00 00 01 ff 00 00 02" // Destination Address
+      // ICMPv6 Header
+      "87" // Type: Neighbor Solicitation
+      "00" // Code
+      "12 34" // Checksum
+  );
+  Cursor cursor(&buf);
+  IPv6HdrView::Scratch ipScratch;
+  auto ipHdr = IPv6HdrView::parse(&cursor, &ipScratch);
+  EXPECT_EQ(6, ipHdr.version());
+  EXPECT_EQ(0xe0, ipHdr.trafficClass());
+  EXPECT_EQ(0x12345, ipHdr.flowLabel());
+  EXPECT_EQ(4, ipHdr.payloadLength());
+  EXPECT_EQ(58, ipHdr.nextHeader());
+  EXPECT_EQ(255, ipHdr.hopLimit());
+  EXPECT_EQ(IPAddressV6("fe80::1"), ipHdr.srcAddr());
+  EXPECT_EQ(IPAddressV6("ff02::1:ff00:2"), ipHdr.dstAddr());
+
+  ICMPHdrView::Scratch icmpScratch;
+  auto icmpHdr = ICMPHdrView::parse(&cursor, &icmpScratch);
+  EXPECT_EQ(135, icmpHdr.type());
+  EXPECT_EQ(0, icmpHdr.code());
+  EXPECT_EQ(0x1234, icmpHdr.csum());
+  EXPECT_TRUE(cursor.isAtEnd());
+}
+
+TEST(HdrViewsTest, SplitHeader) {
+  // Split the frame in the middle of the ethertype
+  auto frame = PktUtil::parseHexData(kArpRequest);
+  auto buf = frame.clone();
+  buf->prependChain(frame.clone());
+  buf->trimEnd(buf->length() - 17);
+  buf->next()->trimStart(17);
+
+  Cursor cursor(buf.get());
+  EthHdrView::Scratch ethScratch;
+  auto ethHdr = EthHdrView::parse(&cursor, &ethScratch);
+  EXPECT_EQ(MacAddress("10:dd:b1:bb:5a:ef"), ethHdr.srcAddr());
+  EXPECT_EQ(0x0806, ethHdr.etherType());
+
+  ArpHdrView::Scratch arpScratch;
+  auto arpHdr = ArpHdrView::parse(&cursor, &arpScratch);
+  EXPECT_EQ(IPAddressV4("10.0.0.1"), arpHdr.tpa());
+}
+
+TEST(HdrViewsTest, TooSmall) {
+  auto buf = PktUtil::parseHexData(kArpRequest);
+  buf.trimEnd(1);
+  Cursor cursor(&buf);
+  EthHdrView::Scratch ethScratch;
+  EthHdrView::parse(&cursor, &ethScratch);
+  ArpHdrView::Scratch arpScratch;
+  EXPECT_THROW(ArpHdrView::parse(&cursor, &arpScratch), HdrParseError);
+}
+
+TEST(HdrViewsTest, BadVersion) {
+  auto buf = PktUtil::parseHexData(
+      "45 00 00 14 00 00 00 00 40 11 00 00 0a 00 00 0f 0a 00 00 01");
+  Cursor cursor(&buf);
+  IPv6HdrView::Scratch scratch;
+  EXPECT_THROW(IPv6HdrView::parse(&cursor, &scratch), HdrParseError);
+}
+
+TEST(HdrViewsTest, BadIPv4) {
+  IPv4HdrView::Scratch scratch;
+  // Total length shorter than the header
+  auto shortBuf = PktUtil::parseHexData(
+      "45 00 00 10 00 00 00 00 40 11 00 00 0a 00 00 0f 0a 00 00 01");
+  Cursor shortCursor(&shortBuf);
+  EXPECT_THROW(IPv4HdrView::parse(&shortCursor, &scratch), HdrParseError);
+  // TTL of 0
+  auto ttlBuf = PktUtil::parseHexData(
+      "45 00 00 14 00 00 00 00 00 11 00 00 0a 00 00 0f 0a 00 00 01");
+  Cursor ttlCursor(&ttlBuf);
+  EXPECT_THROW(IPv4HdrView::parse(&ttlCursor, &scratch), HdrParseError);
+}
@@ -0,0 +1,71 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/packet/PktUtil.h"
+
+#include <folly/Benchmark.h>
+#include <folly/Random.h>
+#include <folly/io/IOBuf.h>
+
+#include <gflags/gflags.h>
+
+using namespace facebook::fboss;
+using folly::IOBuf;
+
+namespace {
+
+std::unique_ptr<IOBuf> randomPacket(uint32_t size) {
+  auto buf = IOBuf::create(size);
+  for (uint32_t i = 0; i < size; ++i) {
+    buf->writableData()[i] = folly::Random::rand32(256);
+  }
+  buf->append(size);
+  return buf;
+}
+
+void checksum(uint32_t numIters, uint32_t size) {
+  std::unique_ptr<IOBuf> buf;
+  BENCHMARK_SUSPEND {
+    buf = randomPacket(size);
+  }
+  for (uint32_t n = 0; n < numIters; ++n) {
+    folly::doNotOptimizeAway(PktUtil::internetChecksum(buf.get()));
+  }
+}
+
+/*
+ * A jumbo packet received in two IOBufs, the first of which ends in the
+ * middle of a 16 bit word.
+ */
+void checksumChained(uint32_t numIters, uint32_t size) {
+  std::unique_ptr<IOBuf> buf;
+  BENCHMARK_SUSPEND {
+    buf = randomPacket(size / 2 + 1);
+    buf->prependChain(randomPacket(size / 2 - 1));
+  }
+  for (uint32_t n = 0; n < numIters; ++n) {
+    folly::doNotOptimizeAway(PktUtil::internetChecksum(buf.get()));
+  }
+}
+
+} // namespace
+
+BENCHMARK_PARAM(checksum, 64)
+BENCHMARK_PARAM(checksum, 128)
+BENCHMARK_PARAM(checksum, 512)
+BENCHMARK_PARAM(checksum, 1500)
+BENCHMARK_PARAM(checksum, 4096)
+BENCHMARK_PARAM(checksum, 9000)
+BENCHMARK_PARAM(checksumChained, 9000)
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
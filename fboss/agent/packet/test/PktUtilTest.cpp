@@ -18,6 +18,8 @@
 #include <folly/logging/xlog.h>
 #include <gtest/gtest.h>
 
+#include <vector>
+
 using namespace facebook::fboss;
 using folly::IOBuf;
 using folly::IPAddressV4;
@@ -222,3 +224,24 @@ TEST(Checksum, TestKnownOdd) {
   expected = ~expected;
   EXPECT_EQ(expected, PktUtil::internetChecksum(bytes, 9));
 }
+
+TEST(Checksum, TestChained) {
+  // Large enough for the wide word loops, and split at odd offsets so that
+  // some 16 bit words straddle two IOBufs
+  constexpr uint32_t kSize = 9001;
+  std::vector<uint8_t> bytes(kSize);
+  for (auto& byte : bytes) {
+    byte = Random::rand32(std::numeric_limits<uint8_t>::max());
+  }
+  auto chain = IOBuf::copyBuffer(bytes.data(), 3);
+  chain->prependChain(IOBuf::copyBuffer(bytes.data() + 3, 1));
+  chain->prependChain(IOBuf::copyBuffer(bytes.data() + 4, 4097));
+  chain->prependChain(IOBuf::copyBuffer(bytes.data() + 4101, kSize - 4101));
+
+  EXPECT_EQ(
+      PktUtil::internetChecksum(bytes.data(), kSize),
+      PktUtil::internetChecksum(chain.get()));
+  EXPECT_EQ(
+      PktUtil::internetChecksum(bytes.data() + 1, kSize - 1),
+      PktUtil::internetChecksum(Cursor(chain.get()) + 1, kSize - 1));
+}
@@ -45,7 +45,8 @@ ConfigApplier::ConfigApplier(
 void ConfigApplier::updateRibAndFib() {
   RouteUpdater updater(v4NetworkToRoute_, v6NetworkToRoute_);
 
-  // Enable ALPM
+  // Enable ALPM. addRoute() leaves a route alone when the client already has
+  // the same entry for it, so reapplying config does not touch these.
   updater.addRoute(
       folly::IPAddressV4("0.0.0.0"),
       0,
@@ -59,9 +60,10 @@ void ConfigApplier::updateRibAndFib() {
       RouteNextHopEntry(
           RouteForwardAction::DROP, AdminDistance::MAX_ADMIN_DISTANCE));
 
-  // Update static routes
-  updater.removeAllRoutesForClient(ClientID::STATIC_ROUTE);
-
+  // Update static routes. Routes still in config are updated in place rather
+  // than removed and re-added, so that unchanged ones, and the routes
+  // resolved through them, are not re-resolved.
+  std::set<folly::CIDRNetwork> staticPrefixes;
   for (const auto& staticRoute : staticCpuRouteRange_) {
     if (RouterID(staticRoute.routerID) != vrf_) {
       continue;
@@ -73,6 +75,7 @@ void ConfigApplier::updateRibAndFib() {
         prefix.second,
         ClientID::STATIC_ROUTE,
         RouteNextHopEntry::createToCpu());
+    staticPrefixes.insert(prefix);
   }
   for (const auto& staticRoute : staticDropRouteRange_) {
     if (RouterID(staticRoute.routerID) != vrf_) {
@@ -85,6 +88,7 @@ void ConfigApplier::updateRibAndFib() {
         prefix.second,
         ClientID::STATIC_ROUTE,
         RouteNextHopEntry::createDrop());
+    staticPrefixes.insert(prefix);
   }
   for (const auto& staticRoute : staticRouteRange_) {
     if (RouterID(staticRoute.routerID) != vrf_) {
@@ -97,11 +101,17 @@ void ConfigApplier::updateRibAndFib() {
         prefix.second,
         ClientID::STATIC_ROUTE,
         RouteNextHopEntry::fromStaticRoute(staticRoute));
+    staticPrefixes.insert(prefix);
   }
 
+  updater.removeAllRoutesForClientExcept(
+      ClientID::STATIC_ROUTE, staticPrefixes);
+
   // Update interface routes
-  updater.removeAllRoutesForClient(ClientID::INTERFACE_ROUTE);
-  addInterfaceRoutes(&updater, directlyConnectedRouteRange_);
+  auto interfacePrefixes =
+      addInterfaceRoutes(&updater, directlyConnectedRouteRange_);
+  updater.removeAllRoutesForClientExcept(
+      ClientID::INTERFACE_ROUTE, interfacePrefixes);
 
   // Add link-local routes
   updater.addLinkLocalRoutes();
@@ -112,16 +122,19 @@ void ConfigApplier::updateRibAndFib() {
   fibUpdateCallback_(vrf_, *v4NetworkToRoute_, *v6NetworkToRoute_, cookie_);
 }
 
-void ConfigApplier::addInterfaceRoutes(
+std::set<folly::CIDRNetwork> ConfigApplier::addInterfaceRoutes(
     RouteUpdater* updater,
     folly::Range<DirectlyConnectedRouteIterator> directlyConnectedRoutesRange) {
+  std::set<folly::CIDRNetwork> prefixes;
   for (const auto& directlyConnectedRoute : directlyConnectedRoutesRange) {
     auto network = directlyConnectedRoute.first;
     auto interfaceID = directlyConnectedRoute.second.first;
     auto endpoint = directlyConnectedRoute.second.second;
     updater->addInterfaceRoute(
         network.first, network.second, endpoint, interfaceID);
+    prefixes.insert(network);
   }
+  return prefixes;
 }
 
 } // namespace rib
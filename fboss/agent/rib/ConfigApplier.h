@@ -14,6 +14,7 @@
 #include <folly/Range.h>
 #include <functional>
 #include <memory>
+#include <set>
 #include <utility>
 #include <vector>
 
@@ -58,7 +59,8 @@ class ConfigApplier {
   void updateRibAndFib();
 
  private:
-  void addInterfaceRoutes(
+  // Returns the prefixes of the interface routes
+  std::set<folly::CIDRNetwork> addInterfaceRoutes(
       RouteUpdater* updater,
       folly::Range<DirectlyConnectedRouteIterator>
           directlyConnectedRoutesRange);
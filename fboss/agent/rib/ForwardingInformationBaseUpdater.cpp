@@ -45,25 +45,85 @@ std::shared_ptr<SwitchState> ForwardingInformationBaseUpdater::operator()(
   auto previousFibContainer = state->getFibs()->getFibContainerIf(vrf_);
   CHECK(previousFibContainer);
 
-  auto nextFibContainer = previousFibContainer->modify(&nextState);
-
-  nextFibContainer->writableFields()->fibV4 =
-      std::shared_ptr<ForwardingInformationBaseV4>(createUpdatedFib(
-          v4NetworkToRoute_, previousFibContainer->getFibV4()));
+  auto previousFibV4 = previousFibContainer->getFibV4();
+  auto previousFibV6 = previousFibContainer->getFibV6();
+  auto nextFibV4 = createUpdatedFib(v4NetworkToRoute_, previousFibV4);
+  auto nextFibV6 = createUpdatedFib(v6NetworkToRoute_, previousFibV6);
+  if (nextFibV4 == previousFibV4 && nextFibV6 == previousFibV6) {
+    return nextState;
+  }
 
-  nextFibContainer->writableFields()->fibV6 =
-      std::shared_ptr<ForwardingInformationBaseV6>(createUpdatedFib(
-          v6NetworkToRoute_, previousFibContainer->getFibV6()));
+  auto nextFibContainer = previousFibContainer->modify(&nextState);
+  nextFibContainer->writableFields()->fibV4 = std::move(nextFibV4);
+  nextFibContainer->writableFields()->fibV6 = std::move(nextFibV6);
 
   return nextState;
 }
 
 template <typename AddressT>
-std::unique_ptr<typename facebook::fboss::ForwardingInformationBase<AddressT>>
+std::shared_ptr<typename facebook::fboss::ForwardingInformationBase<AddressT>>
 ForwardingInformationBaseUpdater::createUpdatedFib(
     const facebook::fboss::rib::NetworkToRouteMap<AddressT>& rib,
     const std::shared_ptr<facebook::fboss::ForwardingInformationBase<AddressT>>&
         fib) {
+  if (fib->getRibGeneration() == rib.generation()) {
+    return fib;
+  }
+  if (rib.changedPrefixes() &&
+      fib->getRibGeneration() == rib.previousGeneration()) {
+    return createIncrementalFib(rib, fib);
+  }
+  return createFullFib(rib, fib);
+}
+
+template <typename AddressT>
+std::shared_ptr<typename facebook::fboss::ForwardingInformationBase<AddressT>>
+ForwardingInformationBaseUpdater::createIncrementalFib(
+    const facebook::fboss::rib::NetworkToRouteMap<AddressT>& rib,
+    const std::shared_ptr<facebook::fboss::ForwardingInformationBase<AddressT>>&
+        fib) {
+  // Routes which did not change are shared with the previous FIB
+  auto updatedFib = fib->clone();
+
+  for (const auto& ribPrefix : *rib.changedPrefixes()) {
+    facebook::fboss::RoutePrefix<AddressT> fibPrefix{ribPrefix.network,
+                                                     ribPrefix.mask};
+    auto fibRoute = updatedFib->getNodeIf(fibPrefix);
+
+    auto ribRouteIt = rib.exactMatch(ribPrefix.network, ribPrefix.mask);
+    if (ribRouteIt == rib.end() || !ribRouteIt->value().isResolved()) {
+      if (fibRoute) {
+        updatedFib->removeNode(fibPrefix);
+      }
+      continue;
+    }
+
+    const auto& ribRoute = ribRouteIt->value();
+    if (fibRoute &&
+        toFibNextHop(ribRoute.getForwardInfo()) ==
+            fibRoute->getForwardInfo()) {
+      // Reuse prior FIB route
+      continue;
+    }
+    std::shared_ptr<facebook::fboss::Route<AddressT>> newFibRoute =
+        toFibRoute(ribRoute);
+    if (fibRoute) {
+      updatedFib->updateNode(newFibRoute);
+    } else {
+      updatedFib->addNode(newFibRoute);
+    }
+  }
+
+  updatedFib->setRibGeneration(rib.generation());
+  return updatedFib;
+}
+
+template <typename AddressT>
+std::shared_ptr<typename facebook::fboss::ForwardingInformationBase<AddressT>>
+ForwardingInformationBaseUpdater::createFullFib(
+    const facebook::fboss::rib::NetworkToRouteMap<AddressT>& rib,
+    const std::shared_ptr<facebook::fboss::ForwardingInformationBase<AddressT>>&
+        fib) {
   // TODO(samank): updateFib should have size equal to the number of resovled
   // routes in the rib
 
@@ -108,8 +168,10 @@ ForwardingInformationBaseUpdater::createUpdatedFib(
             return entry->value().isResolved();
           }));
 
-  return std::make_unique<ForwardingInformationBase<AddressT>>(
+  auto newFib = std::make_shared<ForwardingInformationBase<AddressT>>(
       std::move(updatedFib));
+  newFib->setRibGeneration(rib.generation());
+  return newFib;
 }
 
 facebook::fboss::RouteNextHopEntry
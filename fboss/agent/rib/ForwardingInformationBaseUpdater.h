@@ -30,6 +30,12 @@ namespace rib {
 
 class RouteNextHopEntry;
 
+/*
+ * ForwardingInformationBaseUpdater syncs the FIBs of a VRF with the routes
+ * of the standalone RIB. When a FIB was last synced from the previous
+ * generation of its RIB route map, only the prefixes changed since then are
+ * applied to a clone of the FIB, otherwise the FIB is rebuilt from scratch.
+ */
 class ForwardingInformationBaseUpdater {
  public:
   ForwardingInformationBaseUpdater(
@@ -47,12 +53,27 @@ class ForwardingInformationBaseUpdater {
       const Route<AddrT>& ribRoute);
 
  private:
+  /*
+   * Returns fib itself when it is already in sync with rib
+   */
   template <typename AddressT>
-  std::unique_ptr<typename facebook::fboss::ForwardingInformationBase<AddressT>>
+  std::shared_ptr<typename facebook::fboss::ForwardingInformationBase<AddressT>>
   createUpdatedFib(
       const facebook::fboss::rib::NetworkToRouteMap<AddressT>& rib,
       const std::shared_ptr<
           facebook::fboss::ForwardingInformationBase<AddressT>>& fib);
+  template <typename AddressT>
+  std::shared_ptr<typename facebook::fboss::ForwardingInformationBase<AddressT>>
+  createFullFib(
+      const facebook::fboss::rib::NetworkToRouteMap<AddressT>& rib,
+      const std::shared_ptr<
+          facebook::fboss::ForwardingInformationBase<AddressT>>& fib);
+  template <typename AddressT>
+  std::shared_ptr<typename facebook::fboss::ForwardingInformationBase<AddressT>>
+  createIncrementalFib(
+      const facebook::fboss::rib::NetworkToRouteMap<AddressT>& rib,
+      const std::shared_ptr<
+          facebook::fboss::ForwardingInformationBase<AddressT>>& fib);
 
   RouterID vrf_;
   const IPv4NetworkToRouteMap& v4NetworkToRoute_;
@@ -9,13 +9,17 @@
  */
 #pragma once
 
+#include "fboss/agent/rib/NextHopDependencyIndex.h"
 #include "fboss/agent/rib/Route.h"
 #include "fboss/lib/RadixTree.h"
 
 #include <folly/IPAddress.h>
 #include <folly/dynamic.h>
 
+#include <atomic>
 #include <memory>
+#include <optional>
+#include <vector>
 
 namespace facebook {
 namespace fboss {
@@ -23,10 +27,12 @@ namespace rib {
 
 template <typename AddressT>
 class NetworkToRouteMap
-    : public facebook::network::RadixTree<AddressT, Route<AddressT>> {
+    : public facebook::network::PooledRadixTree<AddressT, Route<AddressT>> {
   static constexpr auto kRoutes = "routes";
 
  public:
+  using ChangedPrefixes = std::vector<RoutePrefix<AddressT>>;
+
   folly::dynamic toFollyDynamic() const {
     folly::dynamic routesJson = folly::dynamic::array;
     for (const auto& route : *this) {
@@ -50,6 +56,50 @@ class NetworkToRouteMap
 
     return networkToRouteMap;
   }
+
+  /*
+   * How routes were resolved through next hops, maintained by RouteUpdater.
+   * Not serialized: a deserialized map starts with an invalid index.
+   */
+  NextHopDependencyIndex<AddressT>& dependencies() {
+    return dependencies_;
+  }
+  const NextHopDependencyIndex<AddressT>& dependencies() const {
+    return dependencies_;
+  }
+
+  /*
+   * Each RouteUpdater::updateDone() which changes routes moves the map to a
+   * new generation and records the prefixes whose routes may differ from the
+   * previous generation, so that the FIB can be synced by applying just
+   * those. Generations are unique across maps (of an address family).
+   */
+  uint64_t generation() const {
+    return generation_;
+  }
+  uint64_t previousGeneration() const {
+    return previousGeneration_;
+  }
+  // std::nullopt when any route may have changed
+  const std::optional<ChangedPrefixes>& changedPrefixes() const {
+    return changedPrefixes_;
+  }
+  void startGeneration(std::optional<ChangedPrefixes> changedPrefixes) {
+    previousGeneration_ = generation_;
+    generation_ = nextGeneration();
+    changedPrefixes_ = std::move(changedPrefixes);
+  }
+
+ private:
+  static uint64_t nextGeneration() {
+    static std::atomic<uint64_t> generation{0};
+    return ++generation;
+  }
+
+  NextHopDependencyIndex<AddressT> dependencies_;
+  uint64_t generation_{nextGeneration()};
+  uint64_t previousGeneration_{0};
+  std::optional<ChangedPrefixes> changedPrefixes_;
 };
 
 using IPv4NetworkToRouteMap = NetworkToRouteMap<folly::IPAddressV4>;
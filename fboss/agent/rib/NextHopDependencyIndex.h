@@ -0,0 +1,120 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/rib/RouteTypes.h"
+
+#include <boost/container/flat_set.hpp>
+#include <folly/IPAddress.h>
+
+#include <map>
+#include <vector>
+
+namespace facebook {
+namespace fboss {
+namespace rib {
+
+/*
+ * NextHopDependencyIndex records which routes were resolved through which
+ * next hops, so that RouteUpdater only needs to re-resolve the routes whose
+ * next hops may now resolve differently.
+ *
+ * The index of a NetworkToRouteMap<AddressT> holds:
+ * - for each AddressT next hop, the routes (of either address family) that
+ *   were resolved through it.
+ * - for each route of the map, the next hops (of either address family) it
+ *   was resolved through, i.e. the reverse edges, needed to unlink a route
+ *   whose next hops have since changed.
+ *
+ * The index starts out invalid (e.g. on an empty map or one restored on warm
+ * boot), in which case RouteUpdater falls back to resolving every route and
+ * (re)builds it.
+ */
+template <typename AddressT>
+class NextHopDependencyIndex {
+ public:
+  using Prefix = RoutePrefix<AddressT>;
+  using Dependents = boost::container::flat_set<folly::CIDRNetwork>;
+
+  void addDependent(
+      const AddressT& nextHop,
+      const folly::CIDRNetwork& dependent) {
+    nextHopToDependents_[nextHop].insert(dependent);
+  }
+
+  void removeDependent(
+      const AddressT& nextHop,
+      const folly::CIDRNetwork& dependent) {
+    auto it = nextHopToDependents_.find(nextHop);
+    if (it == nextHopToDependents_.end()) {
+      return;
+    }
+    it->second.erase(dependent);
+    if (it->second.empty()) {
+      nextHopToDependents_.erase(it);
+    }
+  }
+
+  /*
+   * Invoke fn on each route resolved through a next hop covered by prefix.
+   * prefix.network must be masked.
+   */
+  template <typename Fn>
+  void forEachDependent(const Prefix& prefix, Fn&& fn) const {
+    // Next hops covered by prefix are contiguous in the (ordered) map
+    for (auto it = nextHopToDependents_.lower_bound(prefix.network);
+         it != nextHopToDependents_.end() &&
+         it->first.inSubnet(prefix.network, prefix.mask);
+         ++it) {
+      for (const auto& dependent : it->second) {
+        fn(dependent);
+      }
+    }
+  }
+
+  void addNextHop(const Prefix& prefix, const folly::IPAddress& nextHop) {
+    prefixToNextHops_[prefix].push_back(nextHop);
+  }
+
+  /*
+   * Forget (and return) the next hops prefix was resolved through
+   */
+  std::vector<folly::IPAddress> removeNextHops(const Prefix& prefix) {
+    std::vector<folly::IPAddress> nextHops;
+    auto it = prefixToNextHops_.find(prefix);
+    if (it != prefixToNextHops_.end()) {
+      nextHops = std::move(it->second);
+      prefixToNextHops_.erase(it);
+    }
+    return nextHops;
+  }
+
+  void clear() {
+    nextHopToDependents_.clear();
+    prefixToNextHops_.clear();
+    valid_ = false;
+  }
+
+  bool isValid() const {
+    return valid_;
+  }
+  void setValid() {
+    valid_ = true;
+  }
+
+ private:
+  std::map<AddressT, Dependents> nextHopToDependents_;
+  std::map<Prefix, std::vector<folly::IPAddress>> prefixToNextHops_;
+  bool valid_{false};
+};
+
+} // namespace rib
+} // namespace fboss
+} // namespace facebook
@@ -67,8 +67,9 @@ std::vector<NextHopThrift> fromRouteNextHopSet(RouteNextHopSet const& nhs) {
 RouteNextHopEntry::RouteNextHopEntry(NextHopSet nhopSet, AdminDistance distance)
     : adminDistance_(distance),
       action_(Action::NEXTHOPS),
-      nhopSet_(std::move(nhopSet)) {
-  if (nhopSet_.size() == 0) {
+      nhopSet_(
+          NextHopSetInterner<NextHopSet>::get().intern(std::move(nhopSet))) {
+  if (nhopSet_->size() == 0) {
     throw FbossError("Empty nexthop set is passed to the RouteNextHopEntry");
   }
 }
@@ -101,7 +102,7 @@ std::string RouteNextHopEntry::str() const {
 bool operator==(const RouteNextHopEntry& a, const RouteNextHopEntry& b) {
   return (
       a.getAction() == b.getAction() and
-      a.getNextHopSet() == b.getNextHopSet() and
+      &a.getNextHopSet() == &b.getNextHopSet() and
       a.getAdminDistance() == b.getAdminDistance());
 }
 
@@ -109,9 +110,11 @@ bool operator<(const RouteNextHopEntry& a, const RouteNextHopEntry& b) {
   if (a.getAdminDistance() != b.getAdminDistance()) {
     return a.getAdminDistance() < b.getAdminDistance();
   }
-  return (
-      (a.getAction() == b.getAction()) ? (a.getNextHopSet() < b.getNextHopSet())
-                                       : a.getAction() < b.getAction());
+  if (a.getAction() != b.getAction()) {
+    return a.getAction() < b.getAction();
+  }
+  return &a.getNextHopSet() != &b.getNextHopSet() &&
+      a.getNextHopSet() < b.getNextHopSet();
 }
 
 // Methods for RouteNextHopEntry
@@ -150,7 +153,7 @@ folly::dynamic RouteNextHopEntry::toFollyDynamic() const {
   folly::dynamic entry = folly::dynamic::object;
   entry[kAction] = forwardActionStr(action_);
   folly::dynamic nhops = folly::dynamic::array;
-  for (const auto& nhop : nhopSet_) {
+  for (const auto& nhop : getNextHopSet()) {
     nhops.push_back(nhop.toFollyDynamic());
   }
   entry[kNexthops] = std::move(nhops);
@@ -167,9 +170,12 @@ RouteNextHopEntry RouteNextHopEntry::fromFollyDynamic(
       : AdminDistance(entryJson[kAdminDistance].asInt());
   RouteNextHopEntry entry(Action::DROP, adminDistance);
   entry.action_ = action;
+  NextHopSet nhopSet;
   for (const auto& nhop : entryJson[kNexthops]) {
-    entry.nhopSet_.insert(util::nextHopFromFollyDynamic(nhop));
+    nhopSet.insert(util::nextHopFromFollyDynamic(nhop));
   }
+  entry.nhopSet_ =
+      NextHopSetInterner<NextHopSet>::get().intern(std::move(nhopSet));
   return entry;
 }
 
@@ -198,7 +204,7 @@ bool RouteNextHopEntry::isValid(bool forMplsRoute) const {
   bool valid = true;
   if (!forMplsRoute) {
     /* for ip2mpls routes, next hop label forwarding action must be push */
-    for (const auto& nexthop : nhopSet_) {
+    for (const auto& nexthop : getNextHopSet()) {
       if (action_ != Action::NEXTHOPS) {
         continue;
       }
@@ -15,6 +15,7 @@
 
 #include "fboss/agent/rib/RouteNextHop.h"
 #include "fboss/agent/rib/RouteTypes.h"
+#include "fboss/agent/state/NextHopSetInterner.h"
 
 #include "fboss/agent/if/gen-cpp2/ctrl_types.h"
 
@@ -40,16 +41,19 @@ class RouteNextHopEntry {
   using NextHopSet = boost::container::flat_set<NextHop>;
 
   RouteNextHopEntry(Action action, AdminDistance distance)
-      : adminDistance_(distance), action_(action) {
+      : adminDistance_(distance),
+        action_(action),
+        nhopSet_(NextHopSetInterner<NextHopSet>::get().empty()) {
     CHECK_NE(action_, Action::NEXTHOPS);
   }
 
   RouteNextHopEntry(NextHopSet nhopSet, AdminDistance distance);
 
   RouteNextHopEntry(NextHop nhop, AdminDistance distance)
-      : adminDistance_(distance), action_(Action::NEXTHOPS) {
-    nhopSet_.emplace(std::move(nhop));
-  }
+      : adminDistance_(distance),
+        action_(Action::NEXTHOPS),
+        nhopSet_(NextHopSetInterner<NextHopSet>::get().intern(
+            NextHopSet{std::move(nhop)})) {}
 
   AdminDistance getAdminDistance() const {
     return adminDistance_;
@@ -59,8 +63,13 @@ class RouteNextHopEntry {
     return action_;
   }
 
+  /*
+   * Next hop sets are interned: all entries with the same next hops share
+   * the same (immutable) set, so comparing the addresses of two entries'
+   * sets is the same as comparing their contents.
+   */
   const NextHopSet& getNextHopSet() const {
-    return nhopSet_;
+    return *nhopSet_;
   }
 
   // Get the sum of the weights of all the nexthops in the entry
@@ -91,7 +100,7 @@ class RouteNextHopEntry {
 
   // Reset the NextHopSet
   void reset() {
-    nhopSet_.clear();
+    nhopSet_ = NextHopSetInterner<NextHopSet>::get().empty();
     action_ = Action::DROP;
   }
 
@@ -111,7 +120,7 @@ class RouteNextHopEntry {
  private:
   AdminDistance adminDistance_;
   Action action_{Action::DROP};
-  NextHopSet nhopSet_;
+  std::shared_ptr<const NextHopSet> nhopSet_;
 };
 
 /**
@@ -11,6 +11,7 @@
 #include "RouteUpdater.h"
 
 #include <numeric>
+#include <set>
 
 #include <boost/container/flat_map.hpp>
 #include <boost/container/flat_set.hpp>
@@ -42,6 +43,21 @@ RouteUpdater::RouteUpdater(
     IPv6NetworkToRouteMap* v6Routes)
     : v4Routes_(v4Routes), v6Routes_(v6Routes) {}
 
+template <>
+IPv4NetworkToRouteMap* RouteUpdater::getRoutes<IPAddressV4>() {
+  return v4Routes_;
+}
+
+template <>
+IPv6NetworkToRouteMap* RouteUpdater::getRoutes<IPAddressV6>() {
+  return v6Routes_;
+}
+
+template <typename AddressT>
+void RouteUpdater::markChanged(const Prefix<AddressT>& prefix) {
+  changedPrefixes_.emplace_back(IPAddress(prefix.network), prefix.mask);
+}
+
 template <typename AddressT>
 void RouteUpdater::addRouteImpl(
     const Prefix<AddressT>& prefix,
@@ -57,12 +73,14 @@ void RouteUpdater::addRouteImpl(
     }
 
     route->update(clientID, entry);
+    markChanged(prefix);
     return;
   }
 
   CHECK(it == routes->end());
   routes->insert(
       prefix.network, prefix.mask, Route<AddressT>(prefix, clientID, entry));
+  markChanged(prefix);
 }
 
 void RouteUpdater::addRoute(
@@ -123,6 +141,7 @@ void RouteUpdater::delRouteImpl(
 
   Route<AddressT>& route = it->value();
   route.delEntryForClient(clientID);
+  markChanged(prefix);
 
   XLOG(DBG3) << "Deleted next-hops for prefix " << prefix.str()
              << "from client " << folly::to<std::string>(clientID);
@@ -150,12 +169,21 @@ void RouteUpdater::delRoute(
 template <typename AddressT>
 void RouteUpdater::removeAllRoutesFromClientImpl(
     NetworkToRouteMap<AddressT>* routes,
-    ClientID clientID) {
+    ClientID clientID,
+    const std::set<CIDRNetwork>& keep) {
   std::vector<typename NetworkToRouteMap<AddressT>::Iterator> toDelete;
 
   for (auto it : *routes) {
     Route<AddressT>& route = it->value();
+    if (!route.getEntryForClient(clientID)) {
+      continue;
+    }
+    const auto& prefix = route.prefix();
+    if (keep.count(CIDRNetwork(IPAddress(prefix.network), prefix.mask))) {
+      continue;
+    }
     route.delEntryForClient(clientID);
+    markChanged(route.prefix());
     if (route.hasNoEntry()) {
       // The nexthops we removed was the only one.  Delete the route.
       toDelete.push_back(it);
@@ -169,8 +197,14 @@ void RouteUpdater::removeAllRoutesFromClientImpl(
 }
 
 void RouteUpdater::removeAllRoutesForClient(ClientID clientID) {
-  removeAllRoutesFromClientImpl<IPAddressV4>(v4Routes_, clientID);
-  removeAllRoutesFromClientImpl<IPAddressV6>(v6Routes_, clientID);
+  removeAllRoutesForClientExcept(clientID, {});
+}
+
+void RouteUpdater::removeAllRoutesForClientExcept(
+    ClientID clientID,
+    const std::set<CIDRNetwork>& keep) {
+  removeAllRoutesFromClientImpl<IPAddressV4>(v4Routes_, clientID, keep);
+  removeAllRoutesFromClientImpl<IPAddressV6>(v6Routes_, clientID, keep);
 }
 
 // Some helper functions for recursive weight resolution
@@ -475,6 +509,10 @@ void RouteUpdater::resolveOne(Route<AddressT>* route) {
         continue;
       }
 
+      // Whatever this next hop resolves to, the route needs to be
+      // re-resolved if routes covering the next hop change.
+      addDependency(route->prefix(), addr);
+
       if (addr.isV4()) {
         getFwdInfoFromNhop(
             v4Routes_,
@@ -529,17 +567,132 @@ void RouteUpdater::resolve(NetworkToRouteMap<AddressT>* routes) {
 }
 
 template <typename AddressT>
-void RouteUpdater::updateDoneImpl(NetworkToRouteMap<AddressT>* routes) {
+void RouteUpdater::clearForward(NetworkToRouteMap<AddressT>* routes) {
   for (auto it : *routes) {
     Route<AddressT>& route = it->value();
     route.clearForward();
   }
-  resolve(routes);
+}
+
+template <typename AddressT>
+void RouteUpdater::addDependency(
+    const Prefix<AddressT>& prefix,
+    const IPAddress& nextHop) {
+  CIDRNetwork dependent{IPAddress(prefix.network), prefix.mask};
+  if (nextHop.isV4()) {
+    v4Routes_->dependencies().addDependent(nextHop.asV4(), dependent);
+  } else {
+    v6Routes_->dependencies().addDependent(nextHop.asV6(), dependent);
+  }
+  getRoutes<AddressT>()->dependencies().addNextHop(prefix, nextHop);
+}
+
+template <typename AddressT>
+void RouteUpdater::unresolve(const Prefix<AddressT>& prefix) {
+  auto routes = getRoutes<AddressT>();
+  CIDRNetwork dependent{IPAddress(prefix.network), prefix.mask};
+  for (const auto& nextHop : routes->dependencies().removeNextHops(prefix)) {
+    if (nextHop.isV4()) {
+      v4Routes_->dependencies().removeDependent(nextHop.asV4(), dependent);
+    } else {
+      v6Routes_->dependencies().removeDependent(nextHop.asV6(), dependent);
+    }
+  }
+  auto it = routes->exactMatch(prefix.network, prefix.mask);
+  if (it != routes->end()) {
+    it->value().clearForward();
+  }
+}
+
+void RouteUpdater::resolveAll() {
+  changedPrefixes_.clear();
+  v4Routes_->dependencies().clear();
+  v6Routes_->dependencies().clear();
+
+  // Clear both address families before resolving either, v4 routes may
+  // resolve through v6 routes and vice versa.
+  clearForward(v4Routes_);
+  clearForward(v6Routes_);
+  resolve(v4Routes_);
+  resolve(v6Routes_);
+
+  v4Routes_->dependencies().setValid();
+  v6Routes_->dependencies().setValid();
+
+  v4Routes_->startGeneration(std::nullopt);
+  v6Routes_->startGeneration(std::nullopt);
+}
+
+void RouteUpdater::resolveChanged() {
+  // Collect the routes which might now resolve differently: the changed
+  // routes and, transitively, the routes resolved through a next hop covered
+  // by one of them.
+  std::set<CIDRNetwork> affected;
+  std::vector<CIDRNetwork> toVisit;
+  toVisit.swap(changedPrefixes_);
+  auto visit = [&toVisit](const CIDRNetwork& dependent) {
+    toVisit.push_back(dependent);
+  };
+  while (!toVisit.empty()) {
+    auto prefix = toVisit.back();
+    toVisit.pop_back();
+    if (!affected.insert(prefix).second) {
+      continue;
+    }
+    if (prefix.first.isV4()) {
+      v4Routes_->dependencies().forEachDependent(
+          PrefixV4{prefix.first.asV4(), prefix.second}, visit);
+    } else {
+      v6Routes_->dependencies().forEachDependent(
+          PrefixV6{prefix.first.asV6(), prefix.second}, visit);
+    }
+  }
+
+  // Unresolve all of them first, so that resolving one of them does not
+  // pick up the stale forwarding info of another.
+  for (const auto& prefix : affected) {
+    if (prefix.first.isV4()) {
+      unresolve(PrefixV4{prefix.first.asV4(), prefix.second});
+    } else {
+      unresolve(PrefixV6{prefix.first.asV6(), prefix.second});
+    }
+  }
+
+  auto resolvePrefix = [this](auto* routes, const auto& network, uint8_t mask) {
+    auto it = routes->exactMatch(network, mask);
+    if (it != routes->end() && it->value().needResolve()) {
+      resolveOne(&(it->value()));
+    }
+  };
+  IPv4NetworkToRouteMap::ChangedPrefixes v4Changed;
+  IPv6NetworkToRouteMap::ChangedPrefixes v6Changed;
+  for (const auto& prefix : affected) {
+    if (prefix.first.isV4()) {
+      resolvePrefix(v4Routes_, prefix.first.asV4(), prefix.second);
+      v4Changed.push_back(PrefixV4{prefix.first.asV4(), prefix.second});
+    } else {
+      resolvePrefix(v6Routes_, prefix.first.asV6(), prefix.second);
+      v6Changed.push_back(PrefixV6{prefix.first.asV6(), prefix.second});
+    }
+  }
+
+  // Leave untouched maps in their current generation, the FIB is already in
+  // sync with those.
+  if (!v4Changed.empty()) {
+    v4Routes_->startGeneration(std::move(v4Changed));
+  }
+  if (!v6Changed.empty()) {
+    v6Routes_->startGeneration(std::move(v6Changed));
+  }
 }
 
 void RouteUpdater::updateDone() {
-  updateDoneImpl(v4Routes_);
-  updateDoneImpl(v6Routes_);
+  if (v4Routes_->dependencies().isValid() &&
+      v6Routes_->dependencies().isValid()) {
+    resolveChanged();
+  } else {
+    resolveAll();
+  }
 }
 
 } // namespace rib
@@ -20,6 +20,9 @@
 
 #include <folly/IPAddress.h>
 
+#include <set>
+#include <vector>
+
 namespace facebook {
 namespace fboss {
 namespace rib {
@@ -47,6 +50,14 @@ namespace rib {
  *    only IP nexthops will be in the final ECMP group.
  * 5. If and only if TO_CPU is the only nexthop (directly or indirectly) of
  *    a route, TO_CPU action will be only path in the resolved ECMP group.
+ *
+ * Resolution is incremental: RouteUpdater keeps track of the prefixes it
+ * modifies and updateDone() only re-resolves the routes that might resolve
+ * differently as a result, i.e. the modified routes and, transitively, the
+ * routes with a next hop covered by a modified route. The next hop to route
+ * dependencies are kept in each NetworkToRouteMap's NextHopDependencyIndex.
+ * When that index is not valid (new or deserialized maps) every route is
+ * resolved, which (re)builds the index.
  */
 class RouteUpdater {
  public:
@@ -71,12 +82,18 @@ class RouteUpdater {
   delRoute(const folly::IPAddress& network, uint8_t mask, ClientID clientID);
   void delLinkLocalRoutes();
   void removeAllRoutesForClient(ClientID clientID);
+  // Remove the client's routes to every prefix but the ones in keep
+  void removeAllRoutesForClientExcept(
+      ClientID clientID,
+      const std::set<folly::CIDRNetwork>& keep);
 
   void updateDone();
 
  private:
   IPv4NetworkToRouteMap* v4Routes_{nullptr};
   IPv6NetworkToRouteMap* v6Routes_{nullptr};
+  // Prefixes added, modified or deleted since the last updateDone()
+  std::vector<folly::CIDRNetwork> changedPrefixes_;
 
   // TODO(samank): rename in original file
   template <typename AddressT>
@@ -97,15 +114,30 @@ class RouteUpdater {
   template <typename AddressT>
   void removeAllRoutesFromClientImpl(
       NetworkToRouteMap<AddressT>* routes,
-      ClientID clientID);
+      ClientID clientID,
+      const std::set<folly::CIDRNetwork>& keep);
   template <typename AddressT>
-  void updateDoneImpl(NetworkToRouteMap<AddressT>* routes);
+  void clearForward(NetworkToRouteMap<AddressT>* routes);
 
   template <typename AddressT>
   void resolve(NetworkToRouteMap<AddressT>* routes);
   template <typename AddressT>
   void resolveOne(Route<AddressT>* route);
 
+  template <typename AddressT>
+  NetworkToRouteMap<AddressT>* getRoutes();
+
+  template <typename AddressT>
+  void markChanged(const Prefix<AddressT>& prefix);
+  void resolveAll();
+  void resolveChanged();
+  template <typename AddressT>
+  void unresolve(const Prefix<AddressT>& prefix);
+  template <typename AddressT>
+  void addDependency(
+      const Prefix<AddressT>& prefix,
+      const folly::IPAddress& nextHop);
+
   template <typename AddressT>
   void getFwdInfoFromNhop(
       NetworkToRouteMap<AddressT>* routes,
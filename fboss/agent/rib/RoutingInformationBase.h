@@ -18,6 +18,7 @@
 
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
@@ -41,13 +42,21 @@ class RoutingInformationBase {
     std::chrono::microseconds duration{0};
   };
 
+  RoutingInformationBase() {}
+  RoutingInformationBase(RoutingInformationBase&& other) noexcept
+      : synchronizedRouteTables_(std::move(other.synchronizedRouteTables_)) {}
+
   /*
-   * `update()` first acquires exclusive ownership of the RIB and executes the
-   * following sequence of actions:
+   * `update()` first acquires exclusive ownership of the VRF's RouteTable and
+   * executes the following sequence of actions:
    * 1. Injects and removes routes in `toAdd` and `toDelete`, respectively.
    * 2. Triggers recursive (IP) resolution.
    * 3. Updates the FIB synchronously.
    *
+   * Updates to different VRFs only share the RIB's VRF map in read mode and
+   * run concurrently. FIB updates remain serialized: fibUpdateCallback is
+   * never invoked by two updates at once.
+   *
    * If a UnicastRoute does not specify its admin distance, then we derive its
    * admin distance via its clientID.  This is accomplished by a mapping from
    * client IDs to admin distances provided in configuration. Unfortunately,
@@ -118,13 +127,16 @@ class RoutingInformationBase {
   };
 
   /*
-   * Currently, route updates to separate VRFs are made to be sequential. In the
-   * event FBOSS has to operate in a routing architecture with numerous VRFs,
-   * we can avoid a slow down by a factor of number of VRFs by parallelizing
-   * route updates across VRFs. This can be accomplished simply by associating
-   * the mutex implicit in folly::Synchronized with an individual RouteTable.
+   * Each RouteTable carries its own lock so that route updates to separate
+   * VRFs can proceed in parallel. The map from RouterID to RouteTable is
+   * only write locked when the set of VRFs changes (i.e. on reconfigure() and
+   * deserialization); update() read locks it and then write locks the
+   * RouteTable of the VRF being updated. Locks are always acquired in that
+   * order: VRF map, RouteTable, fibUpdateMutex_.
    */
-  using RouterIDToRouteTable = boost::container::flat_map<RouterID, RouteTable>;
+  using SynchronizedRouteTable = folly::Synchronized<RouteTable>;
+  using RouterIDToRouteTable = boost::container::
+      flat_map<RouterID, std::unique_ptr<SynchronizedRouteTable>>;
   using SynchronizedRouteTables = folly::Synchronized<RouterIDToRouteTable>;
 
   RouterIDToRouteTable constructRouteTables(
@@ -133,6 +145,8 @@ class RoutingInformationBase {
           configRouterIDToInterfaceRoutes) const;
 
   SynchronizedRouteTables synchronizedRouteTables_;
+  // Serializes FIB callbacks of concurrent update()s
+  std::mutex fibUpdateMutex_;
 };
 
 } // namespace rib
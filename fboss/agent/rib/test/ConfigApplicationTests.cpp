@@ -354,3 +354,48 @@ TEST(ConfigApplication, MultiVrfColdBoot) {
   fibContainer = fibMap->getFibContainer(RouterID(1));
   EXPECT_NE(nullptr, fibContainer);
 }
+
+TEST(ConfigApplication, ReapplyUnchangedConfig) {
+  rib::RoutingInformationBase rib;
+
+  rib::RoutingInformationBase::RouterIDAndNetworkToInterfaceRoutes
+      interfaceRoutes;
+  folly::IPAddress intfAddr("1.1.1.1");
+  interfaceRoutes[RouterID(0)].emplace(
+      folly::CIDRNetwork(intfAddr.mask(24), 24),
+      std::make_pair(InterfaceID(1), intfAddr));
+  std::vector<cfg::StaticRouteWithNextHops> staticRoutesWithNextHops(1);
+  staticRoutesWithNextHops[0].prefix = "20.20.20.0/24";
+  staticRoutesWithNextHops[0].nexthops = {"1.1.1.3"};
+  std::vector<cfg::StaticRouteNoNextHops> staticRoutesToNull(1);
+  staticRoutesToNull[0].prefix = "2.2.0.0/16";
+
+  // RIB generations handed to the FIB, v4 then v6, for each reconfigure()
+  std::vector<std::pair<uint64_t, uint64_t>> generations;
+  auto reconfigure = [&]() {
+    rib.reconfigure(
+        interfaceRoutes,
+        staticRoutesWithNextHops,
+        staticRoutesToNull,
+        {} /* staticRoutesToCpu */,
+        [&generations](
+            RouterID, const auto& v4Routes, const auto& v6Routes, void*) {
+          generations.emplace_back(
+              v4Routes.generation(), v6Routes.generation());
+        },
+        nullptr);
+  };
+
+  reconfigure();
+  reconfigure();
+  ASSERT_EQ(2, generations.size());
+  // Nothing changed, so no route was re-resolved and the FIB is left as is
+  EXPECT_EQ(generations[0], generations[1]);
+
+  // Dropping a static route still removes it
+  staticRoutesToNull.clear();
+  reconfigure();
+  ASSERT_EQ(3, generations.size());
+  EXPECT_NE(generations[1].first, generations[2].first);
+  EXPECT_EQ(generations[1].second, generations[2].second);
+}
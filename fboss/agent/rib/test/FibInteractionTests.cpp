@@ -18,6 +18,7 @@
 #include "fboss/agent/rib/RouteNextHop.h"
 #include "fboss/agent/rib/RouteNextHopEntry.h"
 #include "fboss/agent/rib/RouteTypes.h"
+#include "fboss/agent/rib/RouteUpdater.h"
 #include "fboss/agent/state/ForwardingInformationBase.h"
 #include "fboss/agent/state/ForwardingInformationBaseContainer.h"
 #include "fboss/agent/state/ForwardingInformationBaseMap.h"
@@ -313,6 +314,90 @@ void EXPECT_FIB_SIZE(
 
 } // namespace
 
+TEST(ForwardingInformationBaseUpdater, IncrementalUpdate) {
+  using namespace facebook::fboss;
+
+  auto vrfOne = RouterID(1);
+  auto makeState = [vrfOne]() {
+    auto fibContainer =
+        std::make_shared<ForwardingInformationBaseContainer>(vrfOne);
+    fibContainer->writableFields()->fibV4 =
+        std::make_shared<ForwardingInformationBaseV4>();
+    fibContainer->writableFields()->fibV6 =
+        std::make_shared<ForwardingInformationBaseV6>();
+    auto fibMap = std::make_shared<ForwardingInformationBaseMap>();
+    fibMap->addNode(fibContainer);
+    auto state = std::make_shared<SwitchState>();
+    state->resetForwardingInformationBases(fibMap);
+    return state;
+  };
+  auto addRoute = [](rib::RouteUpdater* updater,
+                     const std::string& network,
+                     const std::string& nexthop) {
+    rib::RouteNextHopSet nexthops{
+        rib::UnresolvedNextHop(folly::IPAddress(nexthop), rib::ECMP_WEIGHT)};
+    updater->addRoute(
+        folly::IPAddress(network),
+        8,
+        ClientID(10),
+        rib::RouteNextHopEntry(nexthops, kDefaultAdminDistance));
+  };
+
+  rib::IPv4NetworkToRouteMap v4NetworkToRoute;
+  rib::IPv6NetworkToRouteMap v6NetworkToRoute;
+  {
+    rib::RouteUpdater updater(&v4NetworkToRoute, &v6NetworkToRoute);
+    updater.addInterfaceRoute(
+        folly::IPAddress("10.0.0.1"),
+        24,
+        folly::IPAddress("10.0.0.1"),
+        InterfaceID(1));
+    addRoute(&updater, "20.0.0.0", "10.0.0.5");
+    addRoute(&updater, "30.0.0.0", "10.0.0.6");
+    updater.updateDone();
+  }
+  auto state1 = rib::ForwardingInformationBaseUpdater(
+      vrfOne, v4NetworkToRoute, v6NetworkToRoute)(makeState());
+  state1->publish();
+  EXPECT_FIB_SIZE(state1, vrfOne, 3, 0);
+
+  {
+    rib::RouteUpdater updater(&v4NetworkToRoute, &v6NetworkToRoute);
+    addRoute(&updater, "40.0.0.0", "10.0.0.7");
+    updater.updateDone();
+  }
+  auto state2 = rib::ForwardingInformationBaseUpdater(
+      vrfOne, v4NetworkToRoute, v6NetworkToRoute)(state1);
+  EXPECT_FIB_SIZE(state2, vrfOne, 4, 0);
+  EXPECT_ROUTE(state2, vrfOne, folly::IPAddressV4("40.0.0.0"), 8);
+
+  // Unchanged routes and FIBs are carried over as is
+  EXPECT_EQ(
+      getRoute(state1, vrfOne, folly::IPAddressV4("20.0.0.0"), 8),
+      getRoute(state2, vrfOne, folly::IPAddressV4("20.0.0.0"), 8));
+  EXPECT_EQ(
+      state1->getFibs()->getFibContainer(vrfOne)->getFibV6(),
+      state2->getFibs()->getFibContainer(vrfOne)->getFibV6());
+
+  // Syncing an up to date FIB is a no-op
+  state2->publish();
+  auto state3 = rib::ForwardingInformationBaseUpdater(
+      vrfOne, v4NetworkToRoute, v6NetworkToRoute)(state2);
+  EXPECT_EQ(state2, state3);
+
+  // A FIB the RIB knows nothing about gets rebuilt from scratch
+  auto fullState = rib::ForwardingInformationBaseUpdater(
+      vrfOne, v4NetworkToRoute, v6NetworkToRoute)(makeState());
+  for (const auto& route :
+       *state2->getFibs()->getFibContainer(vrfOne)->getFibV4()) {
+    auto fullRoute = getRoute(
+        fullState, vrfOne, route->prefix().network, route->prefix().mask);
+    ASSERT_NE(nullptr, fullRoute);
+    EXPECT_EQ(route->getForwardInfo(), fullRoute->getForwardInfo());
+  }
+  EXPECT_FIB_SIZE(fullState, vrfOne, 4, 0);
+}
+
 TEST(Rib, Update) {
   using namespace facebook::fboss;
 
@@ -0,0 +1,185 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "common/init/Init.h"
+#include "fboss/agent/AddressUtil.h"
+#include "fboss/agent/rib/RoutingInformationBase.h"
+
+#include <folly/Benchmark.h>
+#include <folly/IPAddress.h>
+#include <folly/IPAddressV6.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace facebook::fboss;
+
+DEFINE_int32(routes_per_vrf, 10000, "Number of routes each client programs");
+DEFINE_int32(routes_per_update, 500, "Number of routes per update() call");
+
+namespace {
+
+const ClientID kBgpClient(10);
+
+/*
+ * Each VRF gets an interface route to 2401:db00:<vrf>::/64 and BGP routes
+ * resolving over next hops in that subnet.
+ */
+folly::IPAddressV6 vrfInterfaceAddress(uint32_t vrf) {
+  folly::ByteArray16 bytes{};
+  bytes[0] = 0x24;
+  bytes[1] = 0x01;
+  bytes[2] = 0xdb;
+  bytes[4] = vrf >> 8;
+  bytes[5] = vrf & 0xff;
+  bytes[15] = 1;
+  return folly::IPAddressV6(bytes);
+}
+
+std::unique_ptr<rib::RoutingInformationBase> makeRib(uint32_t numVrfs) {
+  auto rib = std::make_unique<rib::RoutingInformationBase>();
+  rib::RoutingInformationBase::RouterIDAndNetworkToInterfaceRoutes
+      interfaceRoutes;
+  for (uint32_t vrf = 0; vrf < numVrfs; ++vrf) {
+    folly::IPAddress intfAddr(vrfInterfaceAddress(vrf));
+    interfaceRoutes[RouterID(vrf)].emplace(
+        folly::CIDRNetwork(intfAddr.mask(64), 64),
+        std::make_pair(InterfaceID(vrf + 1), intfAddr));
+  }
+  rib->reconfigure(
+      interfaceRoutes,
+      {} /* staticRoutesWithNextHops */,
+      {} /* staticRoutesToNull */,
+      {} /* staticRoutesToCpu */,
+      [](RouterID, const auto&, const auto&, void*) {},
+      nullptr);
+  return rib;
+}
+
+std::vector<std::vector<UnicastRoute>> makeUpdates(uint32_t vrf) {
+  std::vector<NextHopThrift> nextHops;
+  auto intfBytes = vrfInterfaceAddress(vrf).toByteArray();
+  for (uint8_t i = 2; i < 6; ++i) {
+    intfBytes[15] = i;
+    NextHopThrift nextHop;
+    nextHop.address =
+        facebook::network::toBinaryAddress(folly::IPAddressV6(intfBytes));
+    nextHop.weight = 0;
+    nextHops.push_back(std::move(nextHop));
+  }
+
+  std::vector<std::vector<UnicastRoute>> updates;
+  for (int i = 0; i < FLAGS_routes_per_vrf; ++i) {
+    if (i % FLAGS_routes_per_update == 0) {
+      updates.emplace_back();
+    }
+    folly::ByteArray16 bytes{};
+    bytes[0] = 0x20;
+    bytes[1] = 0x01;
+    bytes[4] = i >> 16;
+    bytes[5] = (i >> 8) & 0xff;
+    bytes[6] = i & 0xff;
+    UnicastRoute route;
+    route.dest.ip =
+        facebook::network::toBinaryAddress(folly::IPAddressV6(bytes));
+    route.dest.prefixLength = 64;
+    route.nextHops = nextHops;
+    updates.back().push_back(std::move(route));
+  }
+  return updates;
+}
+
+/*
+ * Program FLAGS_routes_per_vrf routes into each of numVrfs VRFs, either from
+ * a single client walking the VRFs one after the other, or from one client
+ * thread per VRF.
+ */
+void runUpdates(unsigned int iters, uint32_t numVrfs, bool parallel) {
+  for (unsigned int iter = 0; iter < iters; ++iter) {
+    std::unique_ptr<rib::RoutingInformationBase> rib;
+    std::vector<std::vector<std::vector<UnicastRoute>>> vrfUpdates;
+    BENCHMARK_SUSPEND {
+      rib = makeRib(numVrfs);
+      for (uint32_t vrf = 0; vrf < numVrfs; ++vrf) {
+        vrfUpdates.push_back(makeUpdates(vrf));
+      }
+    }
+
+    std::atomic<bool> inFibUpdate{false};
+    auto fibUpdate = [&inFibUpdate](
+                         RouterID,
+                         const rib::IPv4NetworkToRouteMap&,
+                         const rib::IPv6NetworkToRouteMap& v6NetworkToRoute,
+                         void*) {
+      // FIB updates must stay serialized even when clients are not
+      CHECK(!inFibUpdate.exchange(true));
+      folly::doNotOptimizeAway(v6NetworkToRoute.size());
+      inFibUpdate = false;
+    };
+    auto programVrf = [&](uint32_t vrf) {
+      for (const auto& update : vrfUpdates[vrf]) {
+        rib->update(
+            RouterID(vrf),
+            kBgpClient,
+            AdminDistance::EBGP,
+            update,
+            {} /* toDelete */,
+            false /* resetClientsRoutes */,
+            "multi-VRF benchmark",
+            fibUpdate,
+            nullptr);
+      }
+    };
+
+    if (parallel) {
+      std::vector<std::thread> clients;
+      for (uint32_t vrf = 0; vrf < numVrfs; ++vrf) {
+        clients.emplace_back(programVrf, vrf);
+      }
+      for (auto& client : clients) {
+        client.join();
+      }
+    } else {
+      for (uint32_t vrf = 0; vrf < numVrfs; ++vrf) {
+        programVrf(vrf);
+      }
+    }
+
+    BENCHMARK_SUSPEND {
+      rib.reset();
+    }
+  }
+}
+
+void sequentialVrfUpdates(unsigned int iters, uint32_t numVrfs) {
+  runUpdates(iters, numVrfs, false);
+}
+
+void parallelVrfUpdates(unsigned int iters, uint32_t numVrfs) {
+  runUpdates(iters, numVrfs, true);
+}
+
+} // namespace
+
+BENCHMARK_PARAM(sequentialVrfUpdates, 1)
+BENCHMARK_RELATIVE_PARAM(parallelVrfUpdates, 1)
+BENCHMARK_PARAM(sequentialVrfUpdates, 4)
+BENCHMARK_RELATIVE_PARAM(parallelVrfUpdates, 4)
+BENCHMARK_PARAM(sequentialVrfUpdates, 16)
+BENCHMARK_RELATIVE_PARAM(parallelVrfUpdates, 16)
+BENCHMARK_PARAM(sequentialVrfUpdates, 32)
+BENCHMARK_RELATIVE_PARAM(parallelVrfUpdates, 32)
+
+int main(int argc, char** argv) {
+  facebook::initFacebook(&argc, &argv);
+  folly::runBenchmarks();
+  return EXIT_SUCCESS;
+}
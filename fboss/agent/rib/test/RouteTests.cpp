@@ -1575,6 +1575,81 @@ TEST(Route, withNoLabelForwardingAction) {
   EXPECT_EQ(*entry.second, routeNextHopEntry);
 }
 
+// Routes resolving through a changed route get re-resolved, across address
+// families, and the end result matches resolving the table from scratch.
+TEST(Route, incrementalResolve) {
+  auto addChain = [](RouteUpdater* updater) {
+    updater->addRoute(
+        IPAddress("10.0.0.0"),
+        8,
+        kClientA,
+        RouteNextHopEntry(makeNextHops({"1.1.1.10"}), kDistance));
+    updater->addRoute(
+        IPAddress("20.0.0.0"),
+        8,
+        kClientA,
+        RouteNextHopEntry(makeNextHops({"10.1.1.1"}), kDistance));
+    updater->addRoute(
+        IPAddress("2001::"),
+        64,
+        kClientA,
+        RouteNextHopEntry(makeNextHops({"20.1.1.1"}), kDistance));
+  };
+
+  IPv4NetworkToRouteMap v4Routes;
+  IPv6NetworkToRouteMap v6Routes;
+  configRoutes(&v4Routes, &v6Routes);
+  {
+    RouteUpdater u1(&v4Routes, &v6Routes);
+    addChain(&u1);
+    u1.updateDone();
+  }
+  EXPECT_FWD_INFO(getRoute(v4Routes, "20.0.0.0/8"), InterfaceID(1), "1.1.1.10");
+  EXPECT_FWD_INFO(getRoute(v6Routes, "2001::/64"), InterfaceID(1), "1.1.1.10");
+
+  // A more specific route for 10.1.1.1 changes how the chain resolves
+  {
+    RouteUpdater u2(&v4Routes, &v6Routes);
+    u2.addRoute(
+        IPAddress("10.1.1.0"),
+        24,
+        kClientA,
+        RouteNextHopEntry(makeNextHops({"2.2.2.10"}), kDistance));
+    u2.updateDone();
+  }
+  EXPECT_FWD_INFO(getRoute(v4Routes, "10.0.0.0/8"), InterfaceID(1), "1.1.1.10");
+  EXPECT_FWD_INFO(getRoute(v4Routes, "20.0.0.0/8"), InterfaceID(2), "2.2.2.10");
+  EXPECT_FWD_INFO(getRoute(v6Routes, "2001::/64"), InterfaceID(2), "2.2.2.10");
+
+  // Removing the interface route the chain ends in makes it unresolvable
+  {
+    RouteUpdater u3(&v4Routes, &v6Routes);
+    u3.delRoute(IPAddress("2.2.2.0"), 24, ClientID::INTERFACE_ROUTE);
+    u3.updateDone();
+  }
+  EXPECT_RESOLVED(getRoute(v4Routes, "10.0.0.0/8"));
+  EXPECT_TRUE(getRoute(v4Routes, "20.0.0.0/8")->isUnresolvable());
+  EXPECT_TRUE(getRoute(v6Routes, "2001::/64")->isUnresolvable());
+
+  // Same routes, resolved in a single batch
+  IPv4NetworkToRouteMap v4RoutesFull;
+  IPv6NetworkToRouteMap v6RoutesFull;
+  configRoutes(&v4RoutesFull, &v6RoutesFull);
+  {
+    RouteUpdater u4(&v4RoutesFull, &v6RoutesFull);
+    addChain(&u4);
+    u4.addRoute(
+        IPAddress("10.1.1.0"),
+        24,
+        kClientA,
+        RouteNextHopEntry(makeNextHops({"2.2.2.10"}), kDistance));
+    u4.delRoute(IPAddress("2.2.2.0"), 24, ClientID::INTERFACE_ROUTE);
+    u4.updateDone();
+  }
+  EXPECT_ROUTES_MATCH(&v4Routes, &v4RoutesFull);
+  EXPECT_ROUTES_MATCH(&v6Routes, &v6RoutesFull);
+}
+
 TEST(Route, withInvalidLabelForwardingAction) {
   std::array<folly::IPAddressV4, 5> nextHopAddrs{
       folly::IPAddressV4("1.1.1.0"),
@@ -0,0 +1,300 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "common/init/Init.h"
+#include "fboss/agent/rib/NetworkToRouteMap.h"
+#include "fboss/agent/rib/RouteNextHopEntry.h"
+#include "fboss/agent/rib/RouteUpdater.h"
+#include "fboss/agent/state/NextHopSetInterner.h"
+
+#include <folly/Benchmark.h>
+#include <folly/IPAddressV4.h>
+
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace facebook::fboss;
+
+DEFINE_int32(num_routes, 100000, "Number of BGP routes");
+DEFINE_int32(num_ecmp_groups, 50, "Number of distinct ECMP groups");
+DEFINE_int32(ecmp_width_per_group, 64, "Number of next hops per ECMP group");
+
+namespace {
+
+const ClientID kBgpClient(10);
+const InterfaceID kInterface(1);
+
+/*
+ * BGP routes 100.0.0.0/24, 100.0.1.0/24, ... spread over ECMP groups of next
+ * hops in the 10.0.0.0/8 interface subnet.
+ */
+std::vector<rib::RouteNextHopSet> makeEcmpGroups() {
+  std::vector<rib::RouteNextHopSet> groups(FLAGS_num_ecmp_groups);
+  for (int group = 0; group < FLAGS_num_ecmp_groups; ++group) {
+    for (int i = 0; i < FLAGS_ecmp_width_per_group; ++i) {
+      auto addr = folly::IPAddressV4::fromLongHBO(
+          (10 << 24) | ((group + 1) << 8) | (i + 1));
+      groups[group].emplace(
+          rib::UnresolvedNextHop(folly::IPAddress(addr), rib::ECMP_WEIGHT));
+    }
+  }
+  return groups;
+}
+
+void addRoutes(
+    rib::IPv4NetworkToRouteMap* v4Routes,
+    rib::IPv6NetworkToRouteMap* v6Routes) {
+  auto groups = makeEcmpGroups();
+  rib::RouteUpdater updater(v4Routes, v6Routes);
+  updater.addInterfaceRoute(
+      folly::IPAddress("10.0.0.1"),
+      8,
+      folly::IPAddress("10.0.0.1"),
+      kInterface);
+  for (int i = 0; i < FLAGS_num_routes; ++i) {
+    auto network = folly::IPAddressV4::fromLongHBO((100 << 24) + (i << 8));
+    updater.addRoute(
+        folly::IPAddress(network),
+        24,
+        kBgpClient,
+        rib::RouteNextHopEntry(
+            groups[i % groups.size()], AdminDistance::EBGP));
+  }
+  updater.updateDone();
+}
+
+/*
+ * Builds and drops route next hop entries on numThreads threads at once, as
+ * parallel state deserialization does. Each entry interns its next hop set,
+ * which is usually interned already, and the last entry using a set
+ * releases it.
+ */
+void internConcurrently(unsigned int iters, unsigned int numThreads) {
+  std::vector<rib::RouteNextHopSet> groups;
+  BENCHMARK_SUSPEND {
+    groups = makeEcmpGroups();
+  }
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < numThreads; ++t) {
+    threads.emplace_back([&groups, iters, numThreads, t]() {
+      std::vector<rib::RouteNextHopEntry> entries;
+      for (unsigned int i = t; i < iters; i += numThreads) {
+        entries.emplace_back(groups[i % groups.size()], AdminDistance::EBGP);
+        if (entries.size() == groups.size()) {
+          entries.clear();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+/*
+ * What each route entry used to do with its next hops: hold a copy of them.
+ * As in a route table, the client's next hops and the resolved ones.
+ */
+std::vector<rib::RouteNextHopSet> copyNextHopSets(
+    const std::vector<rib::RouteNextHopSet>& groups) {
+  std::vector<rib::RouteNextHopSet> sets;
+  sets.reserve(2 * FLAGS_num_routes);
+  for (int i = 0; i < 2 * FLAGS_num_routes; ++i) {
+    sets.push_back(groups[i % groups.size()]);
+  }
+  return sets;
+}
+
+std::vector<rib::RouteNextHopEntry> makeEntries(
+    const std::vector<rib::RouteNextHopSet>& groups) {
+  std::vector<rib::RouteNextHopEntry> entries;
+  entries.reserve(2 * FLAGS_num_routes);
+  for (int i = 0; i < 2 * FLAGS_num_routes; ++i) {
+    entries.emplace_back(groups[i % groups.size()], AdminDistance::EBGP);
+  }
+  return entries;
+}
+
+/*
+ * Compares each entry with the one num_ecmp_groups further, i.e. with the
+ * same next hops, as computing a delta between two route tables does.
+ */
+template <typename T>
+size_t countEqual(const std::vector<T>& items) {
+  size_t equal = 0;
+  for (size_t i = 0; i + FLAGS_num_ecmp_groups < items.size(); ++i) {
+    equal += items[i] == items[i + FLAGS_num_ecmp_groups];
+  }
+  return equal;
+}
+
+/*
+ * The forwarding next hops of every resolved route, as resolveOne() builds
+ * them from scratch when updateDone() resolves the route.
+ */
+std::vector<rib::RouteNextHopSet> resolvedNextHopSets() {
+  rib::IPv4NetworkToRouteMap v4Routes;
+  rib::IPv6NetworkToRouteMap v6Routes;
+  addRoutes(&v4Routes, &v6Routes);
+  std::vector<rib::RouteNextHopSet> sets;
+  sets.reserve(v4Routes.size());
+  for (const auto& route : v4Routes) {
+    sets.push_back(route.value().getForwardInfo().getNextHopSet());
+  }
+  return sets;
+}
+
+} // namespace
+
+BENCHMARK(NextHopSetsCopy) {
+  std::vector<rib::RouteNextHopSet> groups;
+  BENCHMARK_SUSPEND {
+    groups = makeEcmpGroups();
+  }
+  auto sets = copyNextHopSets(groups);
+  folly::doNotOptimizeAway(sets.size());
+  BENCHMARK_SUSPEND {
+    sets.clear();
+  }
+}
+
+BENCHMARK_RELATIVE(NextHopSetsIntern) {
+  std::vector<rib::RouteNextHopSet> groups;
+  BENCHMARK_SUSPEND {
+    groups = makeEcmpGroups();
+  }
+  auto entries = makeEntries(groups);
+  folly::doNotOptimizeAway(entries.size());
+  BENCHMARK_SUSPEND {
+    entries.clear();
+  }
+}
+
+BENCHMARK(NextHopSetsCompareCopies) {
+  folly::BenchmarkSuspender suspender;
+  auto sets = copyNextHopSets(makeEcmpGroups());
+  suspender.dismiss();
+  folly::doNotOptimizeAway(countEqual(sets));
+  // Not timing their destruction
+  suspender.rehire();
+}
+
+BENCHMARK_RELATIVE(NextHopSetsCompareInterned) {
+  folly::BenchmarkSuspender suspender;
+  auto entries = makeEntries(makeEcmpGroups());
+  suspender.dismiss();
+  folly::doNotOptimizeAway(countEqual(entries));
+  // Not timing their destruction
+  suspender.rehire();
+}
+
+BENCHMARK_DRAW_LINE();
+
+/*
+ * What updateDone() does with the next hops resolveOne() built for each
+ * route: store them in the route's forwarding entry, then compare that with
+ * the entry of the previous resolution. Without interning, the entry holds
+ * the set itself and the comparison is by contents.
+ */
+BENCHMARK(RouteUpdaterNextHopsCopied) {
+  folly::BenchmarkSuspender suspender;
+  auto resolved = resolvedNextHopSets();
+  const auto previous = resolved;
+  std::vector<rib::RouteNextHopSet> entries;
+  entries.reserve(resolved.size());
+  suspender.dismiss();
+
+  size_t unchanged = 0;
+  for (size_t i = 0; i < resolved.size(); ++i) {
+    entries.push_back(std::move(resolved[i]));
+    unchanged += entries.back() == previous[i];
+  }
+  folly::doNotOptimizeAway(unchanged);
+  // Not timing their destruction
+  suspender.rehire();
+}
+
+BENCHMARK_RELATIVE(RouteUpdaterNextHopsInterned) {
+  folly::BenchmarkSuspender suspender;
+  auto resolved = resolvedNextHopSets();
+  std::vector<rib::RouteNextHopEntry> previous;
+  previous.reserve(resolved.size());
+  for (const auto& nhops : resolved) {
+    previous.emplace_back(nhops, AdminDistance::MAX_ADMIN_DISTANCE);
+  }
+  std::vector<rib::RouteNextHopEntry> entries;
+  entries.reserve(resolved.size());
+  suspender.dismiss();
+
+  size_t unchanged = 0;
+  for (size_t i = 0; i < resolved.size(); ++i) {
+    entries.emplace_back(
+        std::move(resolved[i]), AdminDistance::MAX_ADMIN_DISTANCE);
+    unchanged += entries.back() == previous[i];
+  }
+  folly::doNotOptimizeAway(unchanged);
+  // Not timing their destruction
+  suspender.rehire();
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(RouteUpdaterAddAndResolve) {
+  rib::IPv4NetworkToRouteMap v4Routes;
+  rib::IPv6NetworkToRouteMap v6Routes;
+  addRoutes(&v4Routes, &v6Routes);
+  folly::doNotOptimizeAway(v4Routes.size());
+}
+
+BENCHMARK(RouteUpdaterResolveAll) {
+  folly::BenchmarkSuspender suspender;
+  rib::IPv4NetworkToRouteMap v4Routes;
+  rib::IPv6NetworkToRouteMap v6Routes;
+  addRoutes(&v4Routes, &v6Routes);
+  // Deserialized maps have no dependency index, so updateDone() resolves
+  // every route
+  auto restored =
+      rib::IPv4NetworkToRouteMap::fromFollyDynamic(v4Routes.toFollyDynamic());
+  suspender.dismiss();
+
+  rib::RouteUpdater updater(&restored, &v6Routes);
+  updater.updateDone();
+  folly::doNotOptimizeAway(restored.size());
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_PARAM(internConcurrently, 1)
+BENCHMARK_PARAM(internConcurrently, 2)
+BENCHMARK_PARAM(internConcurrently, 4)
+BENCHMARK_PARAM(internConcurrently, 8)
+
+int main(int argc, char* argv[]) {
+  facebook::initFacebook(&argc, &argv);
+  folly::runBenchmarks();
+
+  // Next hop set storage with and without interning. This only counts the
+  // flat_set storage, not the NextHop objects folly::Poly puts on the heap.
+  rib::IPv4NetworkToRouteMap v4Routes;
+  rib::IPv6NetworkToRouteMap v6Routes;
+  addRoutes(&v4Routes, &v6Routes);
+  size_t setBytes = sizeof(rib::NextHop) * FLAGS_ecmp_width_per_group;
+  // Each route holds its client's next hops and the resolved ones
+  size_t perRouteCopies = 2 * FLAGS_num_routes;
+  size_t internedSets =
+      NextHopSetInterner<rib::RouteNextHopSet>::get().size();
+  std::cout << "Next hop sets: " << internedSets << " interned for "
+            << perRouteCopies << " route entries, "
+            << internedSets * setBytes / 1024 << " KiB vs "
+            << perRouteCopies * setBytes / 1024 << " KiB without interning"
+            << std::endl;
+  return 0;
+}
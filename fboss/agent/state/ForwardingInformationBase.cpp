@@ -17,6 +17,16 @@ namespace fboss {
 template <typename AddressT>
 ForwardingInformationBase<AddressT>::ForwardingInformationBase() {}
 
+template <typename AddressT>
+ForwardingInformationBase<AddressT>::ForwardingInformationBase(
+    NodeContainer routes)
+    : Base(std::move(routes)) {
+  auto& lpmIndex = Base::writableExtraFields().lpmIndex;
+  for (const auto& prefixAndRoute : Base::getAllNodes()) {
+    lpmIndex.insert(prefixAndRoute.first, prefixAndRoute.second);
+  }
+}
+
 template <typename AddressT>
 ForwardingInformationBase<AddressT>::~ForwardingInformationBase() {}
 
@@ -31,32 +41,25 @@ template <typename AddressT>
 std::shared_ptr<Route<AddressT>>
 ForwardingInformationBase<AddressT>::longestMatch(
     const AddressT& address) const {
-  std::shared_ptr<Route<AddressT>> longestMatchRoute = nullptr;
-  // longestCommonLength must be wider than int8_t because it needs to hold
-  // values in the range [-1, 128].
-  int16_t longestCommonLength = -1;
-
-  uint8_t currentCommonLength;
-  for (const auto& prefixAndRoute : Base::getAllNodes()) {
-    const auto& currentNetwork = prefixAndRoute.first.network;
-    const auto currentMask = prefixAndRoute.first.mask;
-
-    if (!address.inSubnet(currentNetwork, currentMask)) {
-      continue;
-    }
+  return getLpmIndex().longestMatch(address);
+}
 
-    auto currentCommonPrefixAndLength = folly::IPAddress::longestCommonPrefix(
-        {address, address.bitCount()},
-        {prefixAndRoute.first.network, prefixAndRoute.first.mask});
+template <typename AddressT>
+void ForwardingInformationBase<AddressT>::nodeAdded(
+    const std::shared_ptr<Route<AddressT>>& route) {
+  Base::writableExtraFields().lpmIndex.insert(route->prefix(), route);
+}
 
-    currentCommonLength = currentCommonPrefixAndLength.second;
-    if (currentCommonLength > longestCommonLength) {
-      longestCommonLength = currentCommonLength;
-      longestMatchRoute = prefixAndRoute.second;
-    }
-  }
+template <typename AddressT>
+void ForwardingInformationBase<AddressT>::nodeUpdated(
+    const std::shared_ptr<Route<AddressT>>& route) {
+  Base::writableExtraFields().lpmIndex.insert(route->prefix(), route);
+}
 
-  return longestMatchRoute;
+template <typename AddressT>
+void ForwardingInformationBase<AddressT>::nodeRemoved(
+    const std::shared_ptr<Route<AddressT>>& route) {
+  Base::writableExtraFields().lpmIndex.erase(route->prefix());
 }
 
 FBOSS_INSTANTIATE_NODE_MAP(
@@ -9,9 +9,11 @@
  */
 #pragma once
 
+#include "fboss/agent/state/ForwardingInformationBaseIndex.h"
 #include "fboss/agent/state/NodeMap.h"
 #include "fboss/agent/state/Route.h"
 #include "fboss/agent/state/RouteTypes.h"
+#include "fboss/lib/PersistentMap.h"
 
 #include <folly/IPAddressV4.h>
 #include <folly/IPAddressV6.h>
@@ -19,9 +21,39 @@
 namespace facebook {
 namespace fboss {
 
+/*
+ * The LPM index is kept in the extra fields of the node map so that it is
+ * carried over by clone() along with the routes. It is derived from the
+ * routes, hence it is neither serialized nor deserialized.
+ *
+ * ribGeneration is the generation of the standalone RIB route map the FIB
+ * was last synced from (see rib::NetworkToRouteMap::generation()). It is
+ * not serialized either, after a warm boot the FIB is fully resynced.
+ */
+template <typename AddressT>
+struct ForwardingInformationBaseExtraFields {
+  template <typename Fn>
+  void forEachChild(Fn /*fn*/) {}
+
+  folly::dynamic toFollyDynamic() const {
+    return folly::dynamic::object;
+  }
+
+  static ForwardingInformationBaseExtraFields fromFollyDynamic(
+      const folly::dynamic& /*json*/) {
+    return ForwardingInformationBaseExtraFields();
+  }
+
+  ForwardingInformationBaseIndex<AddressT> lpmIndex;
+  uint64_t ribGeneration{0};
+};
+
 template <typename AddressT>
-using ForwardingInformationBaseTraits =
-    NodeMapTraits<RoutePrefix<AddressT>, Route<AddressT>>;
+using ForwardingInformationBaseTraits = NodeMapTraits<
+    RoutePrefix<AddressT>,
+    Route<AddressT>,
+    ForwardingInformationBaseExtraFields<AddressT>,
+    PersistentMap<RoutePrefix<AddressT>, std::shared_ptr<Route<AddressT>>>>;
 
 template <typename AddressT>
 class ForwardingInformationBase
@@ -29,21 +61,48 @@ class ForwardingInformationBase
           ForwardingInformationBase<AddressT>,
           ForwardingInformationBaseTraits<AddressT>> {
  public:
-  ForwardingInformationBase();
-  ~ForwardingInformationBase() override;
-
   using Base = NodeMapT<
       ForwardingInformationBase<AddressT>,
       ForwardingInformationBaseTraits<AddressT>>;
+  using NodeContainer = typename Base::NodeContainer;
+
+  ForwardingInformationBase();
+  explicit ForwardingInformationBase(NodeContainer routes);
+  ~ForwardingInformationBase() override;
 
   std::shared_ptr<Route<AddressT>> exactMatch(
       const RoutePrefix<AddressT>& prefix) const;
 
   std::shared_ptr<Route<AddressT>> longestMatch(const AddressT& address) const;
 
+  const ForwardingInformationBaseIndex<AddressT>& getLpmIndex() const {
+    return Base::getExtraFields().lpmIndex;
+  }
+
+  uint64_t getRibGeneration() const {
+    return Base::getExtraFields().ribGeneration;
+  }
+  void setRibGeneration(uint64_t generation) {
+    Base::writableExtraFields().ribGeneration = generation;
+  }
+
  private:
+  /*
+   * Routes are added, updated and removed with the NodeMapT functions, which
+   * call the following to keep the LPM index in sync with the routes.
+   */
+  void nodeAdded(const std::shared_ptr<Route<AddressT>>& route);
+  void nodeUpdated(const std::shared_ptr<Route<AddressT>>& route);
+  void nodeRemoved(const std::shared_ptr<Route<AddressT>>& route);
+
+  // Modifying the routes or the LPM index directly would bypass the above
+  using Base::writableExtraFields;
+  using Base::writableFields;
+  using Base::writableNodes;
+
   // Inherit the constructors required for clone()
   using Base::Base;
+  friend Base;
   friend class CloneAllocator;
 };
 
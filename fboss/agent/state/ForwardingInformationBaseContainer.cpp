@@ -8,6 +8,7 @@
  *
  */
 #include "fboss/agent/state/ForwardingInformationBaseContainer.h"
+#include "fboss/agent/Constants.h"
 #include "fboss/agent/state/NodeBase-defs.h"
 #include "fboss/agent/state/SwitchState.h"
 
@@ -42,14 +43,21 @@ ForwardingInformationBaseContainer::getFibV6() const {
 
 std::shared_ptr<ForwardingInformationBaseContainer>
 ForwardingInformationBaseContainer::fromFollyDynamic(
-    const folly::dynamic& /* json */) {
-  // TODO(samank)
-  return nullptr;
+    const folly::dynamic& json) {
+  auto fibContainer = std::make_shared<ForwardingInformationBaseContainer>(
+      RouterID(json[kVrf].asInt()));
+  auto fields = fibContainer->writableFields();
+  fields->fibV4 = ForwardingInformationBaseV4::fromFollyDynamic(json[kFibV4]);
+  fields->fibV6 = ForwardingInformationBaseV6::fromFollyDynamic(json[kFibV6]);
+  return fibContainer;
 }
 
 folly::dynamic ForwardingInformationBaseContainer::toFollyDynamic() const {
-  // TODO(samank)
-  return folly::dynamic::object;
+  folly::dynamic json = folly::dynamic::object;
+  json[kVrf] = static_cast<uint32_t>(getID());
+  json[kFibV4] = getFibV4()->toFollyDynamic();
+  json[kFibV6] = getFibV6()->toFollyDynamic();
+  return json;
 }
 
 ForwardingInformationBaseContainer* ForwardingInformationBaseContainer::modify(
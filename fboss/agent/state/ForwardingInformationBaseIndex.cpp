@@ -0,0 +1,182 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/state/ForwardingInformationBaseIndex.h"
+
+#include "fboss/agent/state/Route.h"
+
+namespace facebook {
+namespace fboss {
+
+template <typename AddressT>
+ForwardingInformationBaseIndex<AddressT>::ForwardingInformationBaseIndex() {}
+
+template <typename AddressT>
+ForwardingInformationBaseIndex<AddressT>::~ForwardingInformationBaseIndex() {}
+
+template <typename AddressT>
+void ForwardingInformationBaseIndex<AddressT>::insert(
+    const Prefix& prefix,
+    const std::shared_ptr<RouteT>& route) {
+  Prefix canonical{prefix.network.mask(prefix.mask), prefix.mask};
+  bool added = false;
+  root_ = insertImpl(root_, canonical, route, &added);
+  if (added) {
+    ++size_;
+  }
+}
+
+template <typename AddressT>
+bool ForwardingInformationBaseIndex<AddressT>::erase(const Prefix& prefix) {
+  Prefix canonical{prefix.network.mask(prefix.mask), prefix.mask};
+  bool erased = false;
+  root_ = eraseImpl(root_, canonical, &erased);
+  if (erased) {
+    --size_;
+  }
+  return erased;
+}
+
+template <typename AddressT>
+void ForwardingInformationBaseIndex<AddressT>::clear() {
+  root_.reset();
+  size_ = 0;
+}
+
+template <typename AddressT>
+std::shared_ptr<Route<AddressT>>
+ForwardingInformationBaseIndex<AddressT>::exactMatch(
+    const Prefix& prefix) const {
+  auto network = prefix.network.mask(prefix.mask);
+  const TrieNode* node = root_.get();
+  while (node && node->mask <= prefix.mask &&
+         network.inSubnet(node->network, node->mask)) {
+    if (node->mask == prefix.mask) {
+      return node->route;
+    }
+    node = node->children[network.getNthMSBit(node->mask)].get();
+  }
+  return nullptr;
+}
+
+template <typename AddressT>
+std::shared_ptr<Route<AddressT>>
+ForwardingInformationBaseIndex<AddressT>::longestMatch(
+    const AddressT& address) const {
+  // Walk down the trie remembering the deepest route seen so far. Only hold
+  // a raw pointer to it while walking to keep the lookup free of refcount
+  // updates.
+  const std::shared_ptr<RouteT>* longestMatchRoute = nullptr;
+  const TrieNode* node = root_.get();
+  while (node && address.inSubnet(node->network, node->mask)) {
+    if (node->route) {
+      longestMatchRoute = &node->route;
+    }
+    if (node->mask == address.bitCount()) {
+      break;
+    }
+    node = node->children[address.getNthMSBit(node->mask)].get();
+  }
+  return longestMatchRoute ? *longestMatchRoute : nullptr;
+}
+
+template <typename AddressT>
+typename ForwardingInformationBaseIndex<AddressT>::TrieNodePtr
+ForwardingInformationBaseIndex<AddressT>::insertImpl(
+    const TrieNodePtr& node,
+    const Prefix& prefix,
+    const std::shared_ptr<RouteT>& route,
+    bool* added) {
+  if (!node) {
+    auto leaf = std::make_shared<TrieNode>(prefix.network, prefix.mask);
+    leaf->route = route;
+    *added = true;
+    return leaf;
+  }
+
+  auto common = AddressT::longestCommonPrefix(
+      {prefix.network, prefix.mask}, {node->network, node->mask});
+
+  if (common.second == node->mask) {
+    auto copy = std::make_shared<TrieNode>(*node);
+    if (prefix.mask == node->mask) {
+      // Same prefix, (re)place the route
+      *added = !node->route;
+      copy->route = route;
+    } else {
+      // node covers prefix, descend
+      auto bit = prefix.network.getNthMSBit(node->mask);
+      copy->children[bit] =
+          insertImpl(node->children[bit], prefix, route, added);
+    }
+    return copy;
+  }
+
+  *added = true;
+  auto newNode = std::make_shared<TrieNode>(prefix.network, prefix.mask);
+  if (common.second == prefix.mask) {
+    // prefix covers node, insert above it
+    newNode->route = route;
+    newNode->children[node->network.getNthMSBit(prefix.mask)] = node;
+    return newNode;
+  }
+
+  // prefix and node diverge, join them under a route-less node
+  auto joint = std::make_shared<TrieNode>(common.first, common.second);
+  newNode->route = route;
+  auto bit = prefix.network.getNthMSBit(common.second);
+  joint->children[bit] = std::move(newNode);
+  joint->children[!bit] = node;
+  return joint;
+}
+
+template <typename AddressT>
+typename ForwardingInformationBaseIndex<AddressT>::TrieNodePtr
+ForwardingInformationBaseIndex<AddressT>::eraseImpl(
+    const TrieNodePtr& node,
+    const Prefix& prefix,
+    bool* erased) {
+  if (!node || node->mask > prefix.mask ||
+      !prefix.network.inSubnet(node->network, node->mask)) {
+    return node;
+  }
+
+  if (node->mask == prefix.mask) {
+    if (!node->route) {
+      return node;
+    }
+    *erased = true;
+    if (node->children[0] && node->children[1]) {
+      auto copy = std::make_shared<TrieNode>(*node);
+      copy->route.reset();
+      return copy;
+    }
+    // Splice the node out in favour of its only child (if any)
+    return node->children[0] ? node->children[0] : node->children[1];
+  }
+
+  auto bit = prefix.network.getNthMSBit(node->mask);
+  auto newChild = eraseImpl(node->children[bit], prefix, erased);
+  if (!*erased) {
+    return node;
+  }
+  if (!newChild && !node->route) {
+    // Route-less nodes always have two children, collapse this one
+    return node->children[!bit];
+  }
+  auto copy = std::make_shared<TrieNode>(*node);
+  copy->children[bit] = std::move(newChild);
+  return copy;
+}
+
+template class ForwardingInformationBaseIndex<folly::IPAddressV4>;
+template class ForwardingInformationBaseIndex<folly::IPAddressV6>;
+
+} // namespace fboss
+} // namespace facebook
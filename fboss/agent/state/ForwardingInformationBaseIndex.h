@@ -0,0 +1,102 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include "fboss/agent/state/RouteTypes.h"
+
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+
+#include <memory>
+
+namespace facebook {
+namespace fboss {
+
+template <typename AddrT>
+class Route;
+
+/*
+ * ForwardingInformationBaseIndex is a longest prefix match index over the
+ * routes of a ForwardingInformationBase.
+ *
+ * It is a path compressed binary trie whose nodes are immutable once they
+ * have been linked into the trie. Modifications copy the nodes on the path
+ * from the root to the modified node and share every other subtree with the
+ * previous version of the trie. Copying an index is therefore O(1), and
+ * insert()/erase() on the copy cost O(depth) allocations while leaving the
+ * original untouched. This is what lets the index live in the copy-on-write
+ * fields of a ForwardingInformationBase and survive clone().
+ *
+ * Prefixes are canonicalized (masked to their prefix length) before they
+ * are inserted.
+ */
+template <typename AddressT>
+class ForwardingInformationBaseIndex {
+ public:
+  using Prefix = RoutePrefix<AddressT>;
+  using RouteT = Route<AddressT>;
+
+  ForwardingInformationBaseIndex();
+  ~ForwardingInformationBaseIndex();
+
+  /*
+   * Insert a route for prefix, replacing any route already indexed for it.
+   */
+  void insert(const Prefix& prefix, const std::shared_ptr<RouteT>& route);
+
+  /*
+   * Remove the route indexed for prefix. Returns false if there was none.
+   */
+  bool erase(const Prefix& prefix);
+
+  std::shared_ptr<RouteT> exactMatch(const Prefix& prefix) const;
+  std::shared_ptr<RouteT> longestMatch(const AddressT& address) const;
+
+  void clear();
+
+  size_t size() const {
+    return size_;
+  }
+  bool empty() const {
+    return size_ == 0;
+  }
+
+ private:
+  struct TrieNode {
+    TrieNode(const AddressT& network, uint8_t mask)
+        : network(network), mask(mask) {}
+
+    AddressT network;
+    uint8_t mask;
+    // nullptr for the internal nodes created where two prefixes diverge
+    std::shared_ptr<RouteT> route;
+    std::shared_ptr<const TrieNode> children[2];
+  };
+  using TrieNodePtr = std::shared_ptr<const TrieNode>;
+
+  static TrieNodePtr insertImpl(
+      const TrieNodePtr& node,
+      const Prefix& prefix,
+      const std::shared_ptr<RouteT>& route,
+      bool* added);
+  static TrieNodePtr
+  eraseImpl(const TrieNodePtr& node, const Prefix& prefix, bool* erased);
+
+  TrieNodePtr root_;
+  size_t size_{0};
+};
+
+using ForwardingInformationBaseIndexV4 =
+    ForwardingInformationBaseIndex<folly::IPAddressV4>;
+using ForwardingInformationBaseIndexV6 =
+    ForwardingInformationBaseIndex<folly::IPAddressV6>;
+
+} // namespace fboss
+} // namespace facebook
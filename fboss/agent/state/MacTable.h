@@ -14,13 +14,18 @@
 #include "fboss/agent/state/NodeMapDelta.h"
 #include "fboss/agent/state/Vlan.h"
 #include "fboss/agent/types.h"
+#include "fboss/lib/PersistentMap.h"
 
 #include <folly/MacAddress.h>
 
 namespace facebook {
 namespace fboss {
 
-using MacTableTraits = NodeMapTraits<folly::MacAddress, MacEntry>;
+using MacTableTraits = NodeMapTraits<
+    folly::MacAddress,
+    MacEntry,
+    NodeMapNoExtraFields,
+    PersistentMap<folly::MacAddress, std::shared_ptr<MacEntry>>>;
 
 class MacTable : public NodeMapT<MacTable, MacTableTraits> {
  public:
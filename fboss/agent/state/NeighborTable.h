@@ -15,6 +15,7 @@
 #include "fboss/agent/state/NeighborEntry.h"
 #include "fboss/agent/state/NodeMap.h"
 #include "fboss/agent/state/PortDescriptor.h"
+#include "fboss/lib/PersistentMap.h"
 
 namespace {
 constexpr auto kNPending = "numPendingEntries";
@@ -31,6 +32,7 @@ struct NeighborTableTraits {
   typedef IPADDR KeyType;
   typedef ENTRY Node;
   typedef NodeMapNoExtraFields ExtraFields;
+  typedef PersistentMap<IPADDR, std::shared_ptr<ENTRY>> NodeContainer;
 
   static KeyType getKey(const std::shared_ptr<Node>& entry) {
     return entry->getIP();
@@ -40,12 +42,9 @@ struct NeighborTableTraits {
 /*
  * A map of IP --> MAC for the IP addresses of other nodes on a VLAN.
  *
- * TODO: We should switch from NodeMap to PrefixMap when the new PrefixMap
- * implementation is ready.
- *
- * Any change to a NodeMap is O(N), so it is really only suitable for small
- * maps that do not change frequently.  Our new PrefixMap implementation will
- * allow us to perform cheaper copy-on-write updates.
+ * The entries are kept in a PersistentMap, so adding, updating or removing an
+ * entry in a cloned table is O(log N) and shares the untouched entries with
+ * the previous table.
  */
 template <typename IPADDR, typename ENTRY, typename SUBCLASS>
 class NeighborTable
@@ -0,0 +1,157 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#pragma once
+
+#include <folly/Synchronized.h>
+#include <folly/hash/Hash.h>
+#include <folly/lang/Align.h>
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+
+namespace facebook {
+namespace fboss {
+
+/*
+ * NextHopSetInterner hands out shared, immutable copies of next hop sets:
+ * interning two sets with the same contents returns the same object for as
+ * long as one of them is alive. Large route tables typically only use a few
+ * distinct ECMP groups, so routes end up sharing a handful of sets instead of
+ * holding a copy each, and two interned sets are equal iff they are the same
+ * object.
+ *
+ * NextHopSet is a set of NextHop (folly::Poly<INextHop>), i.e. either
+ * RouteNextHopEntry::NextHopSet or rib::RouteNextHopEntry::NextHopSet. There
+ * is a single interner per NextHopSet type, see get().
+ *
+ * Every RouteNextHopEntry built from a set goes through the interner, from
+ * whichever thread updates or deserializes routes, so the table is split in
+ * shards by set hash. Sets are usually interned already, and are looked up
+ * under a shared lock first.
+ */
+template <typename NextHopSet>
+class NextHopSetInterner {
+ public:
+  using Handle = std::shared_ptr<const NextHopSet>;
+
+  static NextHopSetInterner& get() {
+    // Leaked, so that handles held by other statics can outlive it
+    static auto* interner = new NextHopSetInterner();
+    return *interner;
+  }
+
+  Handle intern(NextHopSet nhops) {
+    if (nhops.empty()) {
+      return empty_;
+    }
+    Key key{&nhops, hashOf(nhops)};
+    auto& shard = shards_[key.hash % kNumShards];
+    {
+      auto sets = shard.sets.rlock();
+      auto it = sets->find(key);
+      if (it != sets->end()) {
+        if (auto existing = it->second.lock()) {
+          return existing;
+        }
+      }
+    }
+    auto sets = shard.sets.wlock();
+    auto it = sets->find(key);
+    if (it != sets->end()) {
+      if (auto existing = it->second.lock()) {
+        return existing;
+      }
+      // The last handle is being released, it will leave the entry alone
+      // once we've replaced it.
+      sets->erase(it);
+    }
+    auto* raw = new NextHopSet(std::move(nhops));
+    Handle handle(raw, [this, hash = key.hash](const NextHopSet* nhops) {
+      release(nhops, hash);
+    });
+    sets->emplace(Key{raw, key.hash}, handle);
+    return handle;
+  }
+
+  const Handle& empty() const {
+    return empty_;
+  }
+
+  // Number of distinct non empty sets currently alive
+  size_t size() const {
+    size_t size = 0;
+    for (const auto& shard : shards_) {
+      size += shard.sets.rlock()->size();
+    }
+    return size;
+  }
+
+ private:
+  static constexpr size_t kNumShards = 64;
+
+  NextHopSetInterner() : empty_(std::make_shared<const NextHopSet>()) {}
+
+  static size_t hashOf(const NextHopSet& nhops) {
+    size_t hash = nhops.size();
+    for (const auto& nhop : nhops) {
+      auto intf = nhop.intfID();
+      hash = folly::hash::hash_combine(
+          hash,
+          nhop.addr().hash(),
+          nhop.weight(),
+          intf ? static_cast<uint32_t>(*intf) + 1 : 0);
+    }
+    return hash;
+  }
+
+  // A set, and the hash of its contents
+  struct Key {
+    const NextHopSet* nhops;
+    size_t hash;
+  };
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      return key.hash;
+    }
+  };
+  struct KeyEqual {
+    bool operator()(const Key& lhs, const Key& rhs) const {
+      return lhs.hash == rhs.hash && *lhs.nhops == *rhs.nhops;
+    }
+  };
+
+  void release(const NextHopSet* nhops, size_t hash) {
+    {
+      auto sets = shards_[hash % kNumShards].sets.wlock();
+      auto it = sets->find(Key{nhops, hash});
+      // The entry may already belong to a new set with the same contents
+      if (it != sets->end() && it->first.nhops == nhops) {
+        sets->erase(it);
+      }
+    }
+    delete nhops;
+  }
+
+  struct alignas(folly::hardware_destructive_interference_size) Shard {
+    folly::Synchronized<std::unordered_map<
+        Key,
+        std::weak_ptr<const NextHopSet>,
+        KeyHash,
+        KeyEqual>>
+        sets;
+  };
+
+  std::array<Shard, kNumShards> shards_;
+  const Handle empty_;
+};
+
+} // namespace fboss
+} // namespace facebook
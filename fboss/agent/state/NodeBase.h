@@ -148,7 +148,8 @@ class NodeBase {
  *
  * Fields structures must provided a forEachChild() template method, which
  * calls the specified function on child node stored in the fields.  This is
- * used to implement publish().
+ * used to implement publish(), so children that are already published may be
+ * skipped.
  *
  * For an example of how to use NodeBaseT, see Vlan.h or Port.h.
  */
@@ -55,6 +55,7 @@ void NodeMapT<MapTypeT, TraitsT>::addNode(const std::shared_ptr<Node>& node) {
   if (!ret.second) {
     throw FbossError("duplicate node ID ", TraitsT::getKey(node));
   }
+  static_cast<MapTypeT*>(this)->nodeAdded(node);
 }
 
 template <typename MapTypeT, typename TraitsT>
@@ -66,6 +67,7 @@ void NodeMapT<MapTypeT, TraitsT>::updateNode(
     throw FbossError("node ID ", TraitsT::getKey(node), " does not exist");
   }
   it->second = node;
+  static_cast<MapTypeT*>(this)->nodeUpdated(node);
 }
 
 template <typename MapTypeT, typename TraitsT>
@@ -76,7 +78,9 @@ void NodeMapT<MapTypeT, TraitsT>::removeNode(
   if (it == nodes.end()) {
     throw FbossError("node ID ", TraitsT::getKey(node), " does not exist");
   }
+  std::shared_ptr<Node> removed = it->second;
   nodes.erase(it);
+  static_cast<MapTypeT*>(this)->nodeRemoved(removed);
 }
 
 template <typename MapTypeT, typename TraitsT>
@@ -99,6 +103,7 @@ NodeMapT<MapTypeT, TraitsT>::removeNodeIf(const KeyType& key) {
   }
   std::shared_ptr<Node> node = it->second;
   nodes.erase(it);
+  static_cast<MapTypeT*>(this)->nodeRemoved(node);
   return node;
 }
 
@@ -118,12 +123,13 @@ template <typename MapTypeT, typename TraitsT>
 std::shared_ptr<MapTypeT> NodeMapT<MapTypeT, TraitsT>::fromFollyDynamic(
     const folly::dynamic& nodesJson) {
   auto nodeMap = std::make_shared<MapTypeT>();
-  auto entries = nodesJson[kEntries];
-  for (const auto& entry : entries) {
-    nodeMap->addNode(Node::fromFollyDynamic(entry));
-  }
+  // Extra fields go first, so that map types which derive extra fields from
+  // their nodes in addNode() do not have them overwritten.
   nodeMap->writableExtraFields() =
       ExtraFields::fromFollyDynamic(nodesJson[kExtraFields]);
+  for (const auto& entry : nodesJson[kEntries]) {
+    nodeMap->addNode(Node::fromFollyDynamic(entry));
+  }
   return nodeMap;
 }
 
@@ -11,12 +11,50 @@
 
 #include <boost/container/flat_map.hpp>
 
+#include <type_traits>
+#include <utility>
+
 #include "fboss/agent/state/NodeBase.h"
 #include "fboss/agent/state/NodeMapIterator.h"
+#include "fboss/lib/PersistentMap.h"
 
 namespace facebook {
 namespace fboss {
 
+namespace detail {
+/*
+ * The container holding a NodeMap's nodes is a flat_map, unless the traits
+ * specify a NodeContainer (e.g. a PersistentMap, for large maps that change
+ * often).
+ */
+template <typename TraitsT, typename = void>
+struct NodeMapContainer {
+  using type = boost::container::flat_map<
+      typename TraitsT::KeyType,
+      std::shared_ptr<typename TraitsT::Node>>;
+};
+
+template <typename TraitsT>
+struct NodeMapContainer<
+    TraitsT,
+    std::void_t<typename TraitsT::NodeContainer>> {
+  using type = typename TraitsT::NodeContainer;
+};
+
+template <typename NodeContainerT, typename Fn>
+void forEachUnpublishedNode(const NodeContainerT& nodes, Fn& fn) {
+  for (const auto& nodePtr : nodes) {
+    fn(nodePtr.second.get());
+  }
+}
+
+// Only visits the nodes added or replaced since the map was last published
+template <typename K, typename V, typename Compare, typename Fn>
+void forEachUnpublishedNode(PersistentMap<K, V, Compare>& nodes, Fn& fn) {
+  nodes.publish([&fn](const auto& nodePtr) { fn(nodePtr.second.get()); });
+}
+} // namespace detail
+
 /*
  * NodeMapFields defines the fields contained inside a NodeMapT instantiation
  */
@@ -25,19 +63,21 @@ struct NodeMapFields {
   using KeyType = typename TraitsT::KeyType;
   using Node = typename TraitsT::Node;
   using ExtraFields = typename TraitsT::ExtraFields;
-  using NodeContainer =
-      boost::container::flat_map<KeyType, std::shared_ptr<Node>>;
+  using NodeContainer = typename detail::NodeMapContainer<TraitsT>::type;
 
   NodeMapFields() {}
   NodeMapFields(NodeContainer nodes) : nodes(std::move(nodes)) {}
   NodeMapFields(const NodeMapFields& other, NodeContainer nodes)
       : nodes(std::move(nodes)), extra(other.extra) {}
 
+  /*
+   * Nodes that are known to be published already may be skipped, so that
+   * publishing a modified clone of a map held in a PersistentMap doesn't
+   * walk all of its nodes.
+   */
   template <typename Fn>
   void forEachChild(Fn fn) {
-    for (const auto& nodePtr : nodes) {
-      fn(nodePtr.second.get());
-    }
+    detail::forEachUnpublishedNode(nodes, fn);
     extra.forEachChild(fn);
   }
 
@@ -58,11 +98,17 @@ struct NodeMapNoExtraFields {
   }
 };
 
-template <typename KeyT, typename NodeT, typename ExtraT = NodeMapNoExtraFields>
+template <
+    typename KeyT,
+    typename NodeT,
+    typename ExtraT = NodeMapNoExtraFields,
+    typename NodeContainerT =
+        boost::container::flat_map<KeyT, std::shared_ptr<NodeT>>>
 struct NodeMapTraits {
   using KeyType = KeyT;
   using Node = NodeT;
   using ExtraFields = ExtraT;
+  using NodeContainer = NodeContainerT;
 
   static KeyType getKey(const std::shared_ptr<Node>& node) {
     return node->getID();
@@ -75,7 +121,9 @@ struct NodeMapTraits {
  *
  * The TraitsT class specifies the Node type, and how to get the map key from a
  * Node object.  The default Traits implementation calls the getID() method on
- * the Node.
+ * the Node.  Traits may also pick the NodeContainer holding the nodes; maps
+ * that are large and updated often should use a PersistentMap, so that
+ * cloning them doesn't copy all of their nodes.
  */
 template <typename MapTypeT, typename TraitsT>
 class NodeMapT : public NodeBaseT<MapTypeT, NodeMapFields<TraitsT>> {
@@ -152,6 +200,17 @@ class NodeMapT : public NodeBaseT<MapTypeT, NodeMapFields<TraitsT>> {
    */
   static std::shared_ptr<MapTypeT> fromFollyDynamic(const folly::dynamic& json);
 
+ protected:
+  /*
+   * Called on MapTypeT by the functions modifying the nodes above, once the
+   * node has been added, replaced or removed. Map types that derive extra
+   * fields from their nodes shadow these to keep them in sync, which then
+   * also holds when the map is modified through its NodeMapT base.
+   */
+  void nodeAdded(const std::shared_ptr<Node>& /*node*/) {}
+  void nodeUpdated(const std::shared_ptr<Node>& /*node*/) {}
+  void nodeRemoved(const std::shared_ptr<Node>& /*node*/) {}
+
  private:
   // Inherit the constructor required for clone()
   using NodeBaseT<MapTypeT, NodeMapFields<TraitsT>>::NodeBaseT;
@@ -33,8 +33,7 @@ NodeMapDelta<MAP, VALUE, MAPPOINTERTRAITS>::Iterator::Iterator(
   // Advance to the first difference
   while (oldIt_ != oldMap_->end() && newIt_ != newMap_->end() &&
          *oldIt_ == *newIt_) {
-    ++oldIt_;
-    ++newIt_;
+    oldIt_.skipShared(newIt_);
   }
   updateValue();
 }
@@ -51,24 +50,24 @@ template <typename MAP, typename VALUE, typename MAPPOINTERTRAITS>
 void NodeMapDelta<MAP, VALUE, MAPPOINTERTRAITS>::Iterator::updateValue() {
   if (oldIt_ == oldMap_->end()) {
     if (newIt_ == newMap_->end()) {
-      value_.reset(nullNode_, nullNode_);
+      value_.resetUnowned(nullNode_, nullNode_);
     } else {
-      value_.reset(nullNode_, *newIt_);
+      value_.resetUnowned(nullNode_, *newIt_);
     }
     return;
   }
   if (newIt_ == newMap_->end()) {
-    value_.reset(*oldIt_, nullNode_);
+    value_.resetUnowned(*oldIt_, nullNode_);
     return;
   }
   auto oldKey = Traits::getKey(*oldIt_);
   auto newKey = Traits::getKey(*newIt_);
   if (oldKey < newKey) {
-    value_.reset(*oldIt_, nullNode_);
+    value_.resetUnowned(*oldIt_, nullNode_);
   } else if (newKey < oldKey) {
-    value_.reset(nullNode_, *newIt_);
+    value_.resetUnowned(nullNode_, *newIt_);
   } else {
-    value_.reset(*oldIt_, *newIt_);
+    value_.resetUnowned(*oldIt_, *newIt_);
   }
 }
 
@@ -104,8 +103,7 @@ void NodeMapDelta<MAP, VALUE, MAPPOINTERTRAITS>::Iterator::advance() {
   // Advance past any unchanged nodes.
   while (oldIt_ != oldMap_->end() && newIt_ != newMap_->end() &&
          *oldIt_ == *newIt_) {
-    ++oldIt_;
-    ++newIt_;
+    oldIt_.skipShared(newIt_);
   }
   updateValue();
 }
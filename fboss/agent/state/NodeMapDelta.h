@@ -56,6 +56,10 @@ class MapUniquePointerTraits {
  *
  * The main function of this class is the Iterator that it provides.  This
  * allows caller to walk over the changed, added, and removed nodes.
+ *
+ * For maps whose nodes are kept in a PersistentMap, the Iterator skips the
+ * subtrees the two maps share, so walking the delta costs
+ * O(changes * log N) rather than O(N).
  */
 template <
     typename MAP,
@@ -103,36 +107,64 @@ class NodeMapDelta {
   MapPointerType new_;
 };
 
+/*
+ * DeltaValue holds the old and new versions of a node.
+ *
+ * A DeltaValue constructed (or copied) from shared_ptrs holds a reference on
+ * both nodes. The DeltaValue handed out while iterating over a NodeMapDelta
+ * however only points at the shared_ptrs held by the two NodeMaps, so
+ * walking a delta doesn't touch any reference count. getOld()/getNew()
+ * return a reference to the shared_ptr either way: callers only pay for a
+ * reference count increment when they copy it, i.e. when they need a node
+ * to outlive the SwitchStates being compared.
+ */
 template <typename NODE>
 class DeltaValue {
  public:
   using Node = NODE;
   DeltaValue(const std::shared_ptr<Node>& o, const std::shared_ptr<Node>& n)
-      : old_(o), new_(n) {}
+      : ownedOld_(o), ownedNew_(n) {}
+
+  DeltaValue(const DeltaValue& other)
+      : ownedOld_(other.getOld()), ownedNew_(other.getNew()) {}
+  DeltaValue& operator=(const DeltaValue& other) {
+    if (this != &other) {
+      reset(other.getOld(), other.getNew());
+    }
+    return *this;
+  }
 
   void reset(const std::shared_ptr<Node>& o, const std::shared_ptr<Node>& n) {
-    old_ = o;
-    new_ = n;
+    ownedOld_ = o;
+    ownedNew_ = n;
+    old_ = &ownedOld_;
+    new_ = &ownedNew_;
+  }
+
+  /*
+   * Point at o and n without taking a reference on the nodes. o and n must
+   * outlive this DeltaValue, or the next reset.
+   */
+  void resetUnowned(
+      const std::shared_ptr<Node>& o,
+      const std::shared_ptr<Node>& n) {
+    old_ = &o;
+    new_ = &n;
   }
 
   const std::shared_ptr<Node>& getOld() const {
-    return old_;
+    return *old_;
   }
   const std::shared_ptr<Node>& getNew() const {
-    return new_;
+    return *new_;
   }
 
  private:
-  // TODO: We should probably change this to store raw pointers.
-  // Storing shared_ptrs means a lot of unnecessary reference count increments
-  // and decrements as we iterate through the changes.
-  //
-  // It should be sufficient for users to receive raw pointers rather than
-  // shared_ptrs.  Callers should always maintain a shared_ptr to the top-level
-  // SwitchState object, so they should never need the shared_ptr reference
-  // count on individual nodes.
-  std::shared_ptr<Node> old_;
-  std::shared_ptr<Node> new_;
+  // Set by (copy) construction and reset(), unused while unowned
+  std::shared_ptr<Node> ownedOld_;
+  std::shared_ptr<Node> ownedNew_;
+  const std::shared_ptr<Node>* old_{&ownedOld_};
+  const std::shared_ptr<Node>* new_{&ownedNew_};
 };
 
 /*
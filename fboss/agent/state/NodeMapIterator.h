@@ -11,6 +11,8 @@
 
 #include <boost/container/flat_map.hpp>
 
+#include <utility>
+
 /*
  * NodeMapIterator is a very small wrapper around flat_map::const_iterator.
  *
@@ -52,7 +54,34 @@ class NodeMapIterator
     return it_ != other.it_;
   }
 
+  /*
+   * Advance this iterator and other, which point to the same node in two
+   * maps, past the nodes both maps share.  Containers that share structure
+   * between copies (see PersistentMap) can skip whole shared subtrees, others
+   * only skip the current node.
+   */
+  void skipShared(NodeMapIterator& other) {
+    skipSharedImpl(other, 0);
+  }
+
  private:
+  template <typename Container = NodeContainer>
+  auto skipSharedImpl(NodeMapIterator& other, int)
+      -> decltype(
+          Container::skipShared(
+              std::declval<typename Container::const_iterator&>(),
+              std::declval<typename Container::const_iterator&>()),
+          void()) {
+    if (!Container::skipShared(it_, other.it_)) {
+      ++it_;
+      ++other.it_;
+    }
+  }
+  void skipSharedImpl(NodeMapIterator& other, long) {
+    ++it_;
+    ++other.it_;
+  }
+
   typename NodeContainer::const_iterator it_;
 };
 
@@ -13,6 +13,7 @@
 
 #include <folly/dynamic.h>
 
+#include "fboss/agent/state/NextHopSetInterner.h"
 #include "fboss/agent/state/RouteNextHop.h"
 #include "fboss/agent/state/RouteTypes.h"
 
@@ -27,16 +28,19 @@ class RouteNextHopEntry {
   using NextHopSet = boost::container::flat_set<NextHop>;
 
   RouteNextHopEntry(Action action, AdminDistance distance)
-      : adminDistance_(distance), action_(action) {
+      : adminDistance_(distance),
+        action_(action),
+        nhopSet_(NextHopSetInterner<NextHopSet>::get().empty()) {
     CHECK_NE(action_, Action::NEXTHOPS);
   }
 
   RouteNextHopEntry(NextHopSet nhopSet, AdminDistance distance);
 
   RouteNextHopEntry(NextHop nhop, AdminDistance distance)
-      : adminDistance_(distance), action_(Action::NEXTHOPS) {
-    nhopSet_.emplace(std::move(nhop));
-  }
+      : adminDistance_(distance),
+        action_(Action::NEXTHOPS),
+        nhopSet_(NextHopSetInterner<NextHopSet>::get().intern(
+            NextHopSet{std::move(nhop)})) {}
 
   AdminDistance getAdminDistance() const {
     return adminDistance_;
@@ -46,8 +50,13 @@ class RouteNextHopEntry {
     return action_;
   }
 
+  /*
+   * Next hop sets are interned: all entries with the same next hops share
+   * the same (immutable) set, so comparing the addresses of two entries'
+   * sets is the same as comparing their contents.
+   */
   const NextHopSet& getNextHopSet() const {
-    return nhopSet_;
+    return *nhopSet_;
   }
 
   NextHopSet normalizedNextHops() const;
@@ -80,7 +89,7 @@ class RouteNextHopEntry {
 
   // Reset the NextHopSet
   void reset() {
-    nhopSet_.clear();
+    nhopSet_ = NextHopSetInterner<NextHopSet>::get().empty();
     action_ = Action::DROP;
   }
 
@@ -89,7 +98,7 @@ class RouteNextHopEntry {
  private:
   AdminDistance adminDistance_;
   Action action_{Action::DROP};
-  NextHopSet nhopSet_;
+  std::shared_ptr<const NextHopSet> nhopSet_;
 };
 
 /**
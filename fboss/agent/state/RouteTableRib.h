@@ -14,6 +14,7 @@
 #include "fboss/agent/state/NodeMap.h"
 #include "fboss/agent/state/RouteTypes.h"
 #include "fboss/agent/types.h"
+#include "fboss/lib/PersistentMap.h"
 #include "fboss/lib/RadixTree.h"
 
 namespace facebook {
@@ -27,8 +28,11 @@ template <typename AddrT>
 class RouteTableRib;
 
 template <typename AddrT>
-using RouteTableRibNodeMapTraits =
-    NodeMapTraits<RoutePrefix<AddrT>, Route<AddrT>>;
+using RouteTableRibNodeMapTraits = NodeMapTraits<
+    RoutePrefix<AddrT>,
+    Route<AddrT>,
+    NodeMapNoExtraFields,
+    PersistentMap<RoutePrefix<AddrT>, std::shared_ptr<Route<AddrT>>>>;
 
 template <typename AddrT>
 class RouteTableRibNodeMap : public NodeMapT<
@@ -78,8 +82,8 @@ class RouteTableRib : public NodeBase {
 
   using Prefix = RoutePrefix<AddrT>;
   using RouteType = Route<AddrT>;
-  using RoutesRadixTree =
-      facebook::network::RadixTree<AddrT, std::shared_ptr<Route<AddrT>>>;
+  using RoutesRadixTree = facebook::network::
+      PooledRadixTree<AddrT, std::shared_ptr<Route<AddrT>>>;
 
   bool empty() const {
     return nodeMap_->empty();
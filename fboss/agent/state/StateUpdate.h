@@ -30,11 +30,21 @@ class SwitchState;
  * single update notification to the HwSwitch and other update subscribers.
  * Therefore the applyUpdate() may be called with an unpublished SwitchState in
  * some cases.
+ *
+ * Updates that don't allow coalescing are always sent to the HwSwitch before
+ * any later update is applied. If they have a merge key, consecutive updates
+ * with different merge keys may still be sent to the HwSwitch together: only
+ * a later update with the same key (e.g. for the same port) needs to wait.
  */
 class StateUpdate {
  public:
-  explicit StateUpdate(folly::StringPiece name, bool allowCoalesce = true)
-      : name_(name.str()), allowCoalesce_(allowCoalesce) {}
+  explicit StateUpdate(
+      folly::StringPiece name,
+      bool allowCoalesce = true,
+      folly::StringPiece mergeKey = folly::StringPiece())
+      : name_(name.str()),
+        allowCoalesce_(allowCoalesce),
+        mergeKey_(mergeKey.str()) {}
   virtual ~StateUpdate() {}
 
   const std::string& getName() const {
@@ -45,6 +55,14 @@ class StateUpdate {
     return allowCoalesce_;
   }
 
+  bool isMergeable() const {
+    return !allowCoalesce_ && !mergeKey_.empty();
+  }
+
+  const std::string& getMergeKey() const {
+    return mergeKey_;
+  }
+
   /*
    * Apply the update, and return a new SwitchState.
    *
@@ -85,6 +103,7 @@ class StateUpdate {
 
   std::string name_;
   bool allowCoalesce_;
+  std::string mergeKey_;
 
   // An intrusive list hook for maintaining the list of pending updates.
   folly::IntrusiveListHook listHook_;
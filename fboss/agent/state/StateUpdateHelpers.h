@@ -33,8 +33,9 @@ class FunctionStateUpdate : public StateUpdate {
   FunctionStateUpdate(
       folly::StringPiece name,
       StateUpdateFn fn,
-      bool allowCoalesce = true)
-      : StateUpdate(name, allowCoalesce), function_(fn) {}
+      bool allowCoalesce = true,
+      folly::StringPiece mergeKey = folly::StringPiece())
+      : StateUpdate(name, allowCoalesce, mergeKey), function_(fn) {}
 
   std::shared_ptr<SwitchState> applyUpdate(
       const std::shared_ptr<SwitchState>& origState) override {
@@ -9,12 +9,14 @@
  */
 #include "fboss/agent/state/SwitchState.h"
 
+#include "fboss/agent/Constants.h"
 #include "fboss/agent/FbossError.h"
 #include "fboss/agent/state/AclEntry.h"
 #include "fboss/agent/state/AclMap.h"
 #include "fboss/agent/state/AggregatePort.h"
 #include "fboss/agent/state/AggregatePortMap.h"
 #include "fboss/agent/state/ControlPlane.h"
+#include "fboss/agent/state/ForwardingInformationBaseMap.h"
 #include "fboss/agent/state/Interface.h"
 #include "fboss/agent/state/InterfaceMap.h"
 #include "fboss/agent/state/LabelForwardingInformationBase.h"
@@ -30,10 +32,26 @@
 
 #include "fboss/agent/state/NodeBase-defs.h"
 
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/InlineExecutor.h>
+#include <folly/futures/Future.h>
+
 using std::make_shared;
 using std::shared_ptr;
 using std::chrono::seconds;
 
+DEFINE_uint32(
+    state_deserialization_threads,
+    8,
+    "Number of threads used to deserialize the switch state (e.g. on warm "
+    "boot). 0 or 1 deserializes it on the calling thread.");
+
+DEFINE_uint32(
+    state_deserialization_min_routes,
+    10000,
+    "Switch states with fewer routes than this are deserialized on the "
+    "calling thread.");
+
 namespace {
 constexpr auto kInterfaces = "interfaces";
 constexpr auto kPorts = "ports";
@@ -55,6 +73,90 @@ constexpr auto kAggregatePorts = "aggregatePorts";
 constexpr auto kLabelForwardingInformationBase = "labelFib";
 constexpr auto kSwitchSettings = "switchSettings";
 constexpr auto kDefaultDataplaneQosPolicy = "defaultDataPlaneQosPolicy";
+constexpr auto kFibs = "fibs";
+// The routes of a serialized RouteTableRib
+constexpr auto kRoutes = "routes";
+
+/*
+ * The routes of the legacy route tables, plus the FIB routes programmed from
+ * the standalone RIB.
+ */
+size_t numRoutes(const folly::dynamic& swJson) {
+  using facebook::fboss::kEntries;
+  size_t routes = 0;
+  for (const auto& routeTable : swJson[kRouteTables][kEntries]) {
+    for (auto rib : {facebook::fboss::kRibV4, facebook::fboss::kRibV6}) {
+      routes += routeTable[rib][kRoutes].size();
+    }
+  }
+  if (auto fibsJson = swJson.get_ptr(kFibs)) {
+    for (const auto& fibContainer : (*fibsJson)[kEntries]) {
+      for (auto fib : {facebook::fboss::kFibV4, facebook::fboss::kFibV6}) {
+        routes += fibContainer[fib][kEntries].size();
+      }
+    }
+  }
+  return routes;
+}
+
+/*
+ * The executor to deserialize a state with numRoutes routes on.
+ *
+ * Small states (tests, thrift driven state loads) are deserialized inline,
+ * handing their few nodes to other threads would cost more than it saves.
+ * Large ones (i.e. warm boot at scale) are deserialized on a thread pool,
+ * which is created on first use and then kept for later calls.
+ */
+folly::Executor* deserializationExecutor(size_t numRoutes) {
+  if (FLAGS_state_deserialization_threads <= 1 ||
+      numRoutes < FLAGS_state_deserialization_min_routes) {
+    return &folly::InlineExecutor::instance();
+  }
+  // Leaked, so that it is never joined during static destruction
+  static auto* threadPool =
+      new folly::CPUThreadPoolExecutor(FLAGS_state_deserialization_threads);
+  return threadPool;
+}
+
+/*
+ * Deserialize a state node on executor
+ */
+template <typename NodeT>
+folly::Future<std::shared_ptr<NodeT>> fromFollyDynamicVia(
+    folly::Executor* executor,
+    const folly::dynamic& json) {
+  return folly::via(
+      executor, [&json]() { return NodeT::fromFollyDynamic(json); });
+}
+
+/*
+ * Deserialize a NodeMap, each of its nodes in a separate task on executor.
+ * Used for the maps whose nodes are expensive to deserialize, e.g. route
+ * tables and VLANs (with their neighbor tables).
+ */
+template <typename MapT>
+folly::Future<std::shared_ptr<MapT>> nodeMapFromFollyDynamicVia(
+    folly::Executor* executor,
+    const folly::dynamic& json) {
+  using facebook::fboss::kEntries;
+  using facebook::fboss::kExtraFields;
+  using NodePtr = std::shared_ptr<typename MapT::Node>;
+  std::vector<folly::Future<NodePtr>> nodes;
+  for (const auto& entry : json[kEntries]) {
+    nodes.push_back(fromFollyDynamicVia<typename MapT::Node>(executor, entry));
+  }
+  return folly::collect(std::move(nodes))
+      .via(executor)
+      .thenValue([&json](std::vector<NodePtr> mapNodes) {
+        auto nodeMap = std::make_shared<MapT>();
+        nodeMap->writableExtraFields() =
+            MapT::ExtraFields::fromFollyDynamic(json[kExtraFields]);
+        for (const auto& node : mapNodes) {
+          nodeMap->addNode(node);
+        }
+        return nodeMap;
+      });
+}
 } // namespace
 
 // TODO: it might be worth splitting up limits for ecmp/ucmp
@@ -96,6 +198,7 @@ folly::dynamic SwitchStateFields::toFollyDynamic() const {
   switchState[kMirrors] = mirrors->toFollyDynamic();
   switchState[kAggregatePorts] = aggPorts->toFollyDynamic();
   switchState[kLabelForwardingInformationBase] = labelFib->toFollyDynamic();
+  switchState[kFibs] = fibs->toFollyDynamic();
   switchState[kSwitchSettings] = switchSettings->toFollyDynamic();
   if (defaultDataPlaneQosPolicy) {
     switchState[kDefaultDataplaneQosPolicy] =
@@ -117,12 +220,31 @@ folly::dynamic SwitchStateFields::toFollyDynamic() const {
 SwitchStateFields SwitchStateFields::fromFollyDynamic(
     const folly::dynamic& swJson) {
   SwitchStateFields switchState;
-  switchState.interfaces = InterfaceMap::fromFollyDynamic(swJson[kInterfaces]);
-  switchState.ports = PortMap::fromFollyDynamic(swJson[kPorts]);
-  switchState.vlans = VlanMap::fromFollyDynamic(swJson[kVlans]);
-  switchState.routeTables =
-      RouteTableMap::fromFollyDynamic(swJson[kRouteTables]);
-  switchState.acls = AclMap::fromFollyDynamic(swJson[kAcls]);
+  // The big sections, and each route table, FIB and VLAN within them, are
+  // deserialized in parallel.
+  auto executor = deserializationExecutor(numRoutes(swJson));
+  // States saved before FIBs were serialized have none
+  auto fibsFuture = swJson.count(kFibs) > 0
+      ? nodeMapFromFollyDynamicVia<ForwardingInformationBaseMap>(
+            executor, swJson[kFibs])
+      : folly::makeFuture(switchState.fibs);
+  auto [interfaces, ports, vlans, routeTables, fibs, acls] =
+      folly::collectAll(
+          fromFollyDynamicVia<InterfaceMap>(executor, swJson[kInterfaces]),
+          fromFollyDynamicVia<PortMap>(executor, swJson[kPorts]),
+          nodeMapFromFollyDynamicVia<VlanMap>(executor, swJson[kVlans]),
+          nodeMapFromFollyDynamicVia<RouteTableMap>(
+              executor, swJson[kRouteTables]),
+          std::move(fibsFuture),
+          fromFollyDynamicVia<AclMap>(executor, swJson[kAcls]))
+          .get();
+  // Rethrows the first deserialization error, if any
+  switchState.interfaces = std::move(interfaces).value();
+  switchState.ports = std::move(ports).value();
+  switchState.vlans = std::move(vlans).value();
+  switchState.routeTables = std::move(routeTables).value();
+  switchState.fibs = std::move(fibs).value();
+  switchState.acls = std::move(acls).value();
   if (swJson.count(kSflowCollectors) > 0) {
     switchState.sFlowCollectors =
         SflowCollectorMap::fromFollyDynamic(swJson[kSflowCollectors]);
@@ -0,0 +1,212 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "common/init/Init.h"
+#include "fboss/agent/state/ForwardingInformationBase.h"
+#include "fboss/agent/state/NodeBase-defs.h"
+#include "fboss/agent/state/Route.h"
+#include "fboss/agent/state/RouteTypes.h"
+
+#include <folly/Benchmark.h>
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+#include <folly/Random.h>
+
+#include <map>
+#include <type_traits>
+#include <vector>
+
+using namespace facebook::fboss;
+
+DEFINE_int32(
+    lookup_count,
+    1000,
+    "The number of addresses to look up on each lookup iteration");
+
+namespace {
+
+template <typename AddressT>
+AddressT randomAddress();
+
+template <>
+folly::IPAddressV4 randomAddress() {
+  return folly::IPAddressV4::fromLongHBO(folly::Random::rand32());
+}
+
+template <>
+folly::IPAddressV6 randomAddress() {
+  folly::ByteArray16 bytes;
+  *reinterpret_cast<uint64_t*>(&bytes[0]) = folly::Random::rand64();
+  *reinterpret_cast<uint64_t*>(&bytes[8]) = folly::Random::rand64();
+  return folly::IPAddressV6(bytes);
+}
+
+template <typename AddressT>
+uint8_t randomMask() {
+  // Roughly match production route tables: mostly /24 (v4) and /64 (v6)
+  // prefixes with a sprinkling of shorter aggregates.
+  if (std::is_same<AddressT, folly::IPAddressV4>::value) {
+    return folly::Random::oneIn(8) ? 8 + folly::Random::rand32(16) : 24;
+  }
+  return folly::Random::oneIn(8) ? 16 + folly::Random::rand32(48) : 64;
+}
+
+template <typename AddressT>
+std::shared_ptr<ForwardingInformationBase<AddressT>> makeFib(
+    unsigned int numPrefixes) {
+  std::map<RoutePrefix<AddressT>, std::shared_ptr<Route<AddressT>>> routes;
+  while (routes.size() < numPrefixes) {
+    auto mask = randomMask<AddressT>();
+    RoutePrefix<AddressT> prefix{randomAddress<AddressT>().mask(mask), mask};
+    routes.emplace(prefix, std::make_shared<Route<AddressT>>(prefix));
+  }
+  typename ForwardingInformationBase<AddressT>::NodeContainer nodes(
+      routes.begin(), routes.end());
+  return std::make_shared<ForwardingInformationBase<AddressT>>(
+      std::move(nodes));
+}
+
+template <typename AddressT>
+std::vector<AddressT> makeLookups(
+    const ForwardingInformationBase<AddressT>& fib) {
+  // Half of the lookups hit an installed route, the rest are random.
+  std::vector<AddressT> lookups;
+  auto it = fib.begin();
+  while (lookups.size() < FLAGS_lookup_count) {
+    if (lookups.size() % 2 == 0 && it != fib.end()) {
+      lookups.push_back((*it++)->prefix().network);
+    } else {
+      lookups.push_back(randomAddress<AddressT>());
+    }
+  }
+  return lookups;
+}
+
+// Linear scan over the routes, i.e. what longestMatch() used to do before
+// the FIB carried an LPM index.
+template <typename AddressT>
+std::shared_ptr<Route<AddressT>> linearScanLongestMatch(
+    const ForwardingInformationBase<AddressT>& fib,
+    const AddressT& address) {
+  std::shared_ptr<Route<AddressT>> longestMatchRoute;
+  int16_t longestCommonLength = -1;
+  for (const auto& prefixAndRoute : fib.getAllNodes()) {
+    const auto& prefix = prefixAndRoute.first;
+    if (prefix.mask > longestCommonLength &&
+        address.inSubnet(prefix.network, prefix.mask)) {
+      longestCommonLength = prefix.mask;
+      longestMatchRoute = prefixAndRoute.second;
+    }
+  }
+  return longestMatchRoute;
+}
+
+template <typename AddressT>
+void runLookups(
+    unsigned int iters,
+    unsigned int numPrefixes,
+    bool linearScan) {
+  std::shared_ptr<ForwardingInformationBase<AddressT>> fib;
+  std::vector<AddressT> lookups;
+  BENCHMARK_SUSPEND {
+    fib = makeFib<AddressT>(numPrefixes);
+    lookups = makeLookups(*fib);
+  }
+  for (unsigned int i = 0; i < iters; ++i) {
+    for (const auto& address : lookups) {
+      if (linearScan) {
+        folly::doNotOptimizeAway(linearScanLongestMatch(*fib, address));
+      } else {
+        folly::doNotOptimizeAway(fib->longestMatch(address));
+      }
+    }
+  }
+}
+
+void linearScanV4(unsigned int iters, unsigned int numPrefixes) {
+  runLookups<folly::IPAddressV4>(iters, numPrefixes, true);
+}
+
+void lpmIndexV4(unsigned int iters, unsigned int numPrefixes) {
+  runLookups<folly::IPAddressV4>(iters, numPrefixes, false);
+}
+
+void linearScanV6(unsigned int iters, unsigned int numPrefixes) {
+  runLookups<folly::IPAddressV6>(iters, numPrefixes, true);
+}
+
+void lpmIndexV6(unsigned int iters, unsigned int numPrefixes) {
+  runLookups<folly::IPAddressV6>(iters, numPrefixes, false);
+}
+
+/*
+ * What each route update costs the state update thread: clone the published
+ * FIB, replace one route and publish the result.
+ */
+template <typename AddressT>
+void runUpdates(unsigned int iters, unsigned int numPrefixes) {
+  std::shared_ptr<ForwardingInformationBase<AddressT>> fib;
+  std::vector<RoutePrefix<AddressT>> prefixes;
+  BENCHMARK_SUSPEND {
+    fib = makeFib<AddressT>(numPrefixes);
+    fib->publish();
+    for (const auto& route : *fib) {
+      prefixes.push_back(route->prefix());
+    }
+  }
+  for (unsigned int i = 0; i < iters; ++i) {
+    const auto& prefix = prefixes[i % prefixes.size()];
+    auto newFib = fib->clone();
+    newFib->updateNode(std::make_shared<Route<AddressT>>(prefix));
+    newFib->publish();
+    fib = std::move(newFib);
+  }
+}
+
+void cloneUpdatePublishV4(unsigned int iters, unsigned int numPrefixes) {
+  runUpdates<folly::IPAddressV4>(iters, numPrefixes);
+}
+
+void cloneUpdatePublishV6(unsigned int iters, unsigned int numPrefixes) {
+  runUpdates<folly::IPAddressV6>(iters, numPrefixes);
+}
+
+} // namespace
+
+BENCHMARK_PARAM(linearScanV4, 10000)
+BENCHMARK_RELATIVE_PARAM(lpmIndexV4, 10000)
+BENCHMARK_PARAM(linearScanV4, 100000)
+BENCHMARK_RELATIVE_PARAM(lpmIndexV4, 100000)
+BENCHMARK_PARAM(linearScanV4, 1000000)
+BENCHMARK_RELATIVE_PARAM(lpmIndexV4, 1000000)
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_PARAM(linearScanV6, 10000)
+BENCHMARK_RELATIVE_PARAM(lpmIndexV6, 10000)
+BENCHMARK_PARAM(linearScanV6, 100000)
+BENCHMARK_RELATIVE_PARAM(lpmIndexV6, 100000)
+BENCHMARK_PARAM(linearScanV6, 1000000)
+BENCHMARK_RELATIVE_PARAM(lpmIndexV6, 1000000)
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_PARAM(cloneUpdatePublishV4, 10000)
+BENCHMARK_PARAM(cloneUpdatePublishV4, 100000)
+BENCHMARK_PARAM(cloneUpdatePublishV4, 1000000)
+BENCHMARK_PARAM(cloneUpdatePublishV6, 10000)
+BENCHMARK_PARAM(cloneUpdatePublishV6, 100000)
+BENCHMARK_PARAM(cloneUpdatePublishV6, 1000000)
+
+int main(int argc, char** argv) {
+  facebook::initFacebook(&argc, &argv);
+  folly::runBenchmarks();
+  return EXIT_SUCCESS;
+}
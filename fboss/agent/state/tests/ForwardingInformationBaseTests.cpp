@@ -9,15 +9,22 @@
  */
 #include "fboss/agent/state/DeltaFunctions.h"
 #include "fboss/agent/state/ForwardingInformationBaseMap.h"
+#include "fboss/agent/state/NodeMapDelta-defs.h"
 #include "fboss/agent/state/NodeMapDelta.h"
 #include "fboss/agent/state/Route.h"
 #include "fboss/agent/state/RouteTypes.h"
+#include "fboss/agent/state/SwitchState.h"
 
 #include <folly/IPAddressV4.h>
 #include <folly/IPAddressV6.h>
+#include <gflags/gflags.h>
 #include <gtest/gtest.h>
 #include <array>
 #include <memory>
+#include <vector>
+
+DECLARE_uint32(state_deserialization_threads);
+DECLARE_uint32(state_deserialization_min_routes);
 
 namespace {
 
@@ -190,6 +197,83 @@ TEST_F(ForwardingInformationBaseV6Test, DecreasingLPMSequence) {
   }
 }
 
+TEST_F(ForwardingInformationBaseV4Test, RemoveNodeUpdatesLPM) {
+  folly::IPAddressV4 address("72.1.1.1");
+  CHECK_LPM(fib.longestMatch(address), ip4_72, 6);
+
+  fib.removeNode(RoutePrefixV4{ip4_72, 6});
+  CHECK_LPM(fib.longestMatch(address), ip4_64, 3);
+
+  EXPECT_NE(nullptr, fib.removeNodeIf(RoutePrefixV4{ip4_64, 3}));
+  CHECK_LPM(fib.longestMatch(address), ip4_0, 1);
+}
+
+TEST_F(ForwardingInformationBaseV6Test, RemoveNodeUpdatesLPM) {
+  folly::IPAddressV6 address("4801::1");
+  CHECK_LPM(fib.longestMatch(address), ip6_72, 6);
+
+  fib.removeNode(RoutePrefixV6{ip6_72, 6});
+  CHECK_LPM(fib.longestMatch(address), ip6_64, 3);
+
+  EXPECT_NE(nullptr, fib.removeNodeIf(RoutePrefixV6{ip6_64, 3}));
+  CHECK_LPM(fib.longestMatch(address), ip6_0, 1);
+}
+
+TEST(ForwardingInformationBaseV4, NodeMapModificationsUpdateLPM) {
+  auto fib = std::make_shared<ForwardingInformationBaseV4>();
+  auto& nodeMap = static_cast<ForwardingInformationBaseV4::Base&>(*fib);
+
+  nodeMap.addNode(createRouteFromPrefix(ip4_64, 3));
+  nodeMap.addNode(createRouteFromPrefix(ip4_72, 6));
+  CHECK_LPM(fib->longestMatch(ip4_72), ip4_72, 6);
+
+  auto route = createRouteFromPrefix(ip4_64, 3);
+  nodeMap.updateNode(route);
+  EXPECT_EQ(route, fib->longestMatch(ip4_64));
+
+  nodeMap.removeNode(RoutePrefixV4{ip4_72, 6});
+  CHECK_LPM(fib->longestMatch(ip4_72), ip4_64, 3);
+
+  nodeMap.removeNode(route);
+  EXPECT_EQ(nullptr, fib->longestMatch(ip4_72));
+  EXPECT_EQ(0, fib->getLpmIndex().size());
+}
+
+TEST(ForwardingInformationBaseV4, CloneSharesLPMIndex) {
+  auto fib = std::make_shared<ForwardingInformationBaseV4>();
+  fib->addNode(createRouteFromPrefix(ip4_64, 3));
+  fib->publish();
+
+  auto clonedFib = fib->clone();
+  EXPECT_EQ(1, clonedFib->getLpmIndex().size());
+  CHECK_LPM(clonedFib->longestMatch(ip4_72), ip4_64, 3);
+
+  clonedFib->addNode(createRouteFromPrefix(ip4_72, 6));
+  CHECK_LPM(clonedFib->longestMatch(ip4_72), ip4_72, 6);
+  clonedFib->removeNode(RoutePrefixV4{ip4_64, 3});
+  EXPECT_EQ(nullptr, clonedFib->longestMatch(ip4_64));
+
+  // The published FIB must not observe modifications of its clone
+  EXPECT_EQ(1, fib->getLpmIndex().size());
+  CHECK_LPM(fib->longestMatch(ip4_72), ip4_64, 3);
+  CHECK_LPM(fib->longestMatch(ip4_64), ip4_64, 3);
+}
+
+TEST(ForwardingInformationBaseV6, ConstructFromRoutesBuildsLPMIndex) {
+  ForwardingInformationBaseV6::NodeContainer routes;
+  for (const auto& prefix : {RoutePrefixV6{ip6_0, 1},
+                             RoutePrefixV6{ip6_64, 3},
+                             RoutePrefixV6{ip6_72, 6}}) {
+    routes.emplace(prefix, createRouteFromPrefix(prefix));
+  }
+  ForwardingInformationBaseV6 fib(std::move(routes));
+
+  EXPECT_EQ(fib.size(), fib.getLpmIndex().size());
+  CHECK_LPM(fib.longestMatch(folly::IPAddressV6("4801::1")), ip6_72, 6);
+  CHECK_LPM(fib.longestMatch(folly::IPAddressV6("4001::1")), ip6_64, 3);
+  EXPECT_EQ(nullptr, fib.longestMatch(folly::IPAddressV6("8000::1")));
+}
+
 TEST(ForwardingInformationBaseV4, IPv4DefaultPrefixComparesSmallest) {
   ForwardingInformationBaseV4 oldFib;
   ForwardingInformationBaseV4 newFib;
@@ -277,5 +361,136 @@ TEST(ForwardingInformationBaseV6, IPv6DefaultPrefixComparesSmallest) {
   EXPECT_EQ(firstRouteObserved->prefix().mask, 0);
 }
 
+TEST(ForwardingInformationBaseV4, DeltaValuesPointIntoFibs) {
+  auto oldFib = std::make_shared<ForwardingInformationBaseV4>();
+  auto newFib = std::make_shared<ForwardingInformationBaseV4>();
+  oldFib->addNode(createRouteFromPrefix(ip4_64, 3));
+  newFib->addNode(createRouteFromPrefix(ip4_64, 3));
+  newFib->addNode(createRouteFromPrefix(ip4_72, 6));
+
+  std::vector<DeltaValue<RouteV4>> copies;
+  {
+    NodeMapDelta<ForwardingInformationBaseV4> delta(
+        oldFib.get(), newFib.get());
+    auto routeDelta = delta.begin();
+    // Iterating doesn't take references on the routes
+    ASSERT_NE(delta.end(), routeDelta);
+    EXPECT_EQ(&routeDelta->getOld(), &oldFib->getNode({ip4_64, 3}));
+    EXPECT_EQ(&routeDelta->getNew(), &newFib->getNode({ip4_64, 3}));
+    EXPECT_EQ(1, routeDelta->getOld().use_count());
+    copies.push_back(*routeDelta);
+
+    ++routeDelta;
+    ASSERT_NE(delta.end(), routeDelta);
+    EXPECT_EQ(nullptr, routeDelta->getOld());
+    EXPECT_EQ(1, routeDelta->getNew().use_count());
+    copies.push_back(*routeDelta);
+    EXPECT_EQ(delta.end(), ++routeDelta);
+  }
+
+  // Copies own their routes
+  oldFib.reset();
+  newFib.reset();
+  EXPECT_EQ(ip4_64, copies[0].getOld()->prefix().network);
+  EXPECT_EQ(ip4_64, copies[0].getNew()->prefix().network);
+  EXPECT_EQ(nullptr, copies[1].getOld());
+  EXPECT_EQ(ip4_72, copies[1].getNew()->prefix().network);
+}
+
+TEST(ForwardingInformationBaseV4, DeltaOfClonedFibOnlyHasChanges) {
+  auto oldFib = std::make_shared<ForwardingInformationBaseV4>();
+  for (uint32_t i = 0; i < 10000; ++i) {
+    auto network = folly::IPAddressV4::fromLongHBO((10 << 24) + (i << 8));
+    oldFib->addNode(createRouteFromPrefix(network, 24));
+  }
+  oldFib->publish();
+
+  auto newFib = oldFib->clone();
+  auto updated = folly::IPAddressV4("10.0.100.0");
+  auto removed = folly::IPAddressV4("10.1.0.0");
+  auto added = folly::IPAddressV4("11.0.0.0");
+  newFib->updateNode(createRouteFromPrefix(updated, 24));
+  newFib->removeNode(RoutePrefixV4{removed, 24});
+  newFib->addNode(createRouteFromPrefix(added, 24));
+
+  std::vector<std::pair<RouteV4*, RouteV4*>> changes;
+  for (const auto& routeDelta :
+       NodeMapDelta<ForwardingInformationBaseV4>(oldFib.get(), newFib.get())) {
+    changes.emplace_back(
+        routeDelta.getOld().get(), routeDelta.getNew().get());
+  }
+  ASSERT_EQ(3, changes.size());
+  EXPECT_EQ(oldFib->exactMatch({updated, 24}).get(), changes[0].first);
+  EXPECT_EQ(newFib->exactMatch({updated, 24}).get(), changes[0].second);
+  EXPECT_EQ(oldFib->exactMatch({removed, 24}).get(), changes[1].first);
+  EXPECT_EQ(nullptr, changes[1].second);
+  EXPECT_EQ(nullptr, changes[2].first);
+  EXPECT_EQ(newFib->exactMatch({added, 24}).get(), changes[2].second);
+}
+
+namespace {
+template <typename AddressT>
+void checkSameLpmIndex(
+    const std::shared_ptr<ForwardingInformationBase<AddressT>>& expected,
+    const std::shared_ptr<ForwardingInformationBase<AddressT>>& actual) {
+  const auto& expectedIndex = expected->getLpmIndex();
+  const auto& actualIndex = actual->getLpmIndex();
+  EXPECT_EQ(expectedIndex.size(), actualIndex.size());
+  for (const auto& route : *expected) {
+    auto expectedRoute = expectedIndex.exactMatch(route->prefix());
+    auto actualRoute = actualIndex.exactMatch(route->prefix());
+    ASSERT_NE(nullptr, expectedRoute);
+    ASSERT_NE(nullptr, actualRoute);
+    EXPECT_TRUE(expectedRoute->isSame(actualRoute.get()));
+    EXPECT_EQ(
+        expectedIndex.longestMatch(route->prefix().network)->prefix(),
+        actualIndex.longestMatch(route->prefix().network)->prefix());
+  }
+}
+} // namespace
+
+TEST(ForwardingInformationBaseMap, DeserializeFibsInParallel) {
+  auto fibContainer = std::make_shared<ForwardingInformationBaseContainer>(
+      RouterID(0));
+  auto fields = fibContainer->writableFields();
+  for (uint32_t i = 0; i < 100; ++i) {
+    fields->fibV4->addNode(createRouteFromPrefix(
+        folly::IPAddressV4::fromLongHBO((10 << 24) + (i << 8)), 24));
+  }
+  fields->fibV6->addNode(createRouteFromPrefix(ip6_64, 3));
+  auto fibs = std::make_shared<ForwardingInformationBaseMap>();
+  fibs->addNode(fibContainer);
+  auto state = std::make_shared<SwitchState>();
+  state->resetForwardingInformationBases(fibs);
+  auto stateJson = state->toFollyDynamic();
+
+  gflags::FlagSaver flagSaver;
+  FLAGS_state_deserialization_threads = 1;
+  auto serialState = SwitchState::fromFollyDynamic(stateJson);
+  // Well below the 101 FIB routes, so they go through the thread pool
+  FLAGS_state_deserialization_threads = 8;
+  FLAGS_state_deserialization_min_routes = 10;
+  auto parallelState = SwitchState::fromFollyDynamic(stateJson);
+
+  for (const auto& deserialized : {serialState, parallelState}) {
+    EXPECT_EQ(stateJson, deserialized->toFollyDynamic());
+    auto fib = deserialized->getFibs()->getFibContainer(RouterID(0));
+    EXPECT_EQ(100, fib->getFibV4()->getLpmIndex().size());
+    CHECK_LPM(
+        fib->getFibV4()->longestMatch(folly::IPAddressV4("10.0.99.1")),
+        folly::IPAddressV4("10.0.99.0"),
+        24);
+    CHECK_LPM(
+        fib->getFibV6()->longestMatch(folly::IPAddressV6("4801::1")),
+        ip6_64,
+        3);
+  }
+
+  auto serialFib = serialState->getFibs()->getFibContainer(RouterID(0));
+  auto parallelFib = parallelState->getFibs()->getFibContainer(RouterID(0));
+  checkSameLpmIndex(serialFib->getFibV4(), parallelFib->getFibV4());
+  checkSameLpmIndex(serialFib->getFibV6(), parallelFib->getFibV6());
+}
+
 } // namespace fboss
 } // namespace facebook
@@ -15,6 +15,7 @@
 #include "fboss/agent/state/DeltaFunctions.h"
 #include "fboss/agent/state/Interface.h"
 #include "fboss/agent/state/InterfaceMap.h"
+#include "fboss/agent/state/NextHopSetInterner.h"
 #include "fboss/agent/state/NodeMapDelta-defs.h"
 #include "fboss/agent/state/NodeMapDelta.h"
 #include "fboss/agent/state/Route.h"
@@ -33,6 +34,9 @@
 #include <gtest/gtest.h>
 #include <optional>
 
+DECLARE_uint32(state_deserialization_threads);
+DECLARE_uint32(state_deserialization_min_routes);
+
 using namespace facebook::fboss;
 using folly::IPAddress;
 using folly::IPAddressV4;
@@ -1736,6 +1740,42 @@ TEST(Route, deepCopy) {
   EXPECT_TRUE(nhm2.isSame(CLIENT_A, RouteNextHopEntry(origHops, DISTANCE)));
 }
 
+// Test that entries with the same next hops share a single interned set
+TEST(Route, internedNextHopSets) {
+  auto& interner = NextHopSetInterner<RouteNextHopSet>::get();
+  auto initialSize = interner.size();
+
+  auto entry1 = std::make_unique<RouteNextHopEntry>(
+      newNextHops(3, "100.1.1."), DISTANCE);
+  auto entry2 = std::make_unique<RouteNextHopEntry>(
+      newNextHops(3, "100.1.1."), DISTANCE);
+  RouteNextHopEntry entry3(newNextHops(2, "100.1.1."), DISTANCE);
+  EXPECT_EQ(&entry1->getNextHopSet(), &entry2->getNextHopSet());
+  EXPECT_NE(&entry1->getNextHopSet(), &entry3.getNextHopSet());
+  EXPECT_EQ(*entry1, *entry2);
+  EXPECT_FALSE(*entry1 == entry3);
+  EXPECT_FALSE(*entry1 < *entry2);
+  EXPECT_FALSE(*entry2 < *entry1);
+  EXPECT_EQ(initialSize + 2, interner.size());
+
+  // Deserialized entries are interned too
+  auto entry4 = RouteNextHopEntry::fromFollyDynamic(entry1->toFollyDynamic());
+  EXPECT_EQ(&entry1->getNextHopSet(), &entry4.getNextHopSet());
+
+  // DROP and TO_CPU entries share the empty set
+  RouteNextHopEntry drop(RouteForwardAction::DROP, DISTANCE);
+  RouteNextHopEntry toCpu(RouteForwardAction::TO_CPU, DISTANCE);
+  EXPECT_EQ(&drop.getNextHopSet(), &toCpu.getNextHopSet());
+  EXPECT_EQ(initialSize + 2, interner.size());
+
+  // A set is released along with the last entry using it
+  entry1.reset();
+  EXPECT_EQ(initialSize + 2, interner.size());
+  entry2.reset();
+  entry4.reset();
+  EXPECT_EQ(initialSize + 1, interner.size());
+}
+
 // Test serialization of RouteNextHopsMulti.
 TEST(Route, serializeRouteNextHopsMulti) {
   // This function tests [de]serialization of:
@@ -2154,6 +2194,49 @@ TEST(Route, serializeRouteTable) {
   EXPECT_ROUTETABLERIB_MATCH(origRt->getRibV6(), desRt->getRibV6());
 }
 
+TEST(Route, serializeSwitchStateInParallel) {
+  auto state = testStateA();
+  auto routeTables = state->getRouteTables()->clone();
+  routeTables->addRouteTable(std::make_shared<RouteTable>(RouterID(1)));
+  state->resetRouteTables(routeTables);
+  RouteUpdater updater(state->getRouteTables());
+  RouteNextHopSet nhop1 = makeNextHops({"10.0.0.22"});
+  RouteNextHopSet nhop2 = makeNextHops({"192.168.0.22"});
+  for (auto rid : {RouterID(0), RouterID(1)}) {
+    for (int i = 0; i < 64; ++i) {
+      auto network = IPAddressV4::fromLongHBO((100 << 24) + (i << 8));
+      updater.addRoute(
+          rid,
+          network,
+          24,
+          CLIENT_A,
+          RouteNextHopEntry(i % 2 ? nhop1 : nhop2, DISTANCE));
+    }
+  }
+  state->resetRouteTables(updater.updateDone());
+  auto stateJson = state->toFollyDynamic();
+
+  auto savedThreads = FLAGS_state_deserialization_threads;
+  auto savedMinRoutes = FLAGS_state_deserialization_min_routes;
+  FLAGS_state_deserialization_threads = 1;
+  auto serialState = SwitchState::fromFollyDynamic(stateJson);
+  // Small enough to be deserialized inline by default
+  FLAGS_state_deserialization_threads = 8;
+  auto inlineState = SwitchState::fromFollyDynamic(stateJson);
+  FLAGS_state_deserialization_min_routes = 0;
+  auto parallelState = SwitchState::fromFollyDynamic(stateJson);
+  auto parallelState2 = SwitchState::fromFollyDynamic(stateJson);
+  FLAGS_state_deserialization_threads = savedThreads;
+  FLAGS_state_deserialization_min_routes = savedMinRoutes;
+
+  EXPECT_EQ(stateJson, serialState->toFollyDynamic());
+  EXPECT_EQ(stateJson, inlineState->toFollyDynamic());
+  EXPECT_EQ(stateJson, parallelState->toFollyDynamic());
+  EXPECT_NODEMAP_MATCH(parallelState->getRouteTables());
+  // The thread pool is reused
+  EXPECT_EQ(stateJson, parallelState2->toFollyDynamic());
+}
+
 // Test utility functions for converting RouteNextHopSet to thrift and back
 TEST(RouteTypes, toFromRouteNextHops) {
   RouteNextHopSet nhs;
@@ -0,0 +1,122 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "common/init/Init.h"
+#include "fboss/agent/state/ForwardingInformationBase.h"
+#include "fboss/agent/state/NodeMapDelta-defs.h"
+#include "fboss/agent/state/NodeMapDelta.h"
+#include "fboss/agent/state/Route.h"
+#include "fboss/agent/state/RouteTypes.h"
+
+#include <folly/Benchmark.h>
+#include <folly/IPAddressV4.h>
+
+using namespace facebook::fboss;
+
+DEFINE_int32(num_routes, 100000, "Number of routes in the FIB delta");
+
+namespace {
+
+using FibV4Delta = NodeMapDelta<ForwardingInformationBaseV4>;
+
+/*
+ * Two FIBs with the same prefixes but different Route objects, so that every
+ * route shows up in the delta as changed.
+ */
+std::pair<
+    std::shared_ptr<ForwardingInformationBaseV4>,
+    std::shared_ptr<ForwardingInformationBaseV4>>
+makeFibs() {
+  ForwardingInformationBaseV4::NodeContainer oldRoutes;
+  ForwardingInformationBaseV4::NodeContainer newRoutes;
+  for (int i = 0; i < FLAGS_num_routes; ++i) {
+    RoutePrefixV4 prefix{
+        folly::IPAddressV4::fromLongHBO((10 << 24) + (i << 8)), 24};
+    oldRoutes.emplace_hint(
+        oldRoutes.end(), prefix, std::make_shared<RouteV4>(prefix));
+    newRoutes.emplace_hint(
+        newRoutes.end(), prefix, std::make_shared<RouteV4>(prefix));
+  }
+  return std::make_pair(
+      std::make_shared<ForwardingInformationBaseV4>(std::move(oldRoutes)),
+      std::make_shared<ForwardingInformationBaseV4>(std::move(newRoutes)));
+}
+
+} // namespace
+
+/*
+ * Walk the delta the way observers do, only looking at the nodes
+ */
+BENCHMARK(IterateFibDelta, iters) {
+  folly::BenchmarkSuspender suspender;
+  auto [oldFib, newFib] = makeFibs();
+  FibV4Delta delta(oldFib.get(), newFib.get());
+  suspender.dismiss();
+
+  while (iters--) {
+    size_t changed = 0;
+    for (const auto& routeDelta : delta) {
+      changed += routeDelta.getOld() != routeDelta.getNew();
+    }
+    folly::doNotOptimizeAway(changed);
+  }
+}
+
+/*
+ * Same, with each DeltaValue holding a reference on its nodes, which is what
+ * delta iteration used to do
+ */
+BENCHMARK_RELATIVE(IterateFibDeltaOwningValues, iters) {
+  folly::BenchmarkSuspender suspender;
+  auto [oldFib, newFib] = makeFibs();
+  FibV4Delta delta(oldFib.get(), newFib.get());
+  suspender.dismiss();
+
+  while (iters--) {
+    size_t changed = 0;
+    for (const auto& routeDelta : delta) {
+      DeltaValue<RouteV4> owningDelta(routeDelta);
+      changed += owningDelta.getOld() != owningDelta.getNew();
+    }
+    folly::doNotOptimizeAway(changed);
+  }
+}
+
+/*
+ * The common case of a FIB cloned from the previous state with a couple of
+ * routes changed. The delta skips the routes both FIBs share.
+ */
+BENCHMARK(IterateClonedFibDeltaTwoChanges, iters) {
+  folly::BenchmarkSuspender suspender;
+  auto oldFib = makeFibs().first;
+  oldFib->publish();
+  auto newFib = oldFib->clone();
+  for (auto i : {FLAGS_num_routes / 3, 2 * FLAGS_num_routes / 3}) {
+    RoutePrefixV4 prefix{
+        folly::IPAddressV4::fromLongHBO((10 << 24) + (i << 8)), 24};
+    newFib->updateNode(std::make_shared<RouteV4>(prefix));
+  }
+  FibV4Delta delta(oldFib.get(), newFib.get());
+  suspender.dismiss();
+
+  while (iters--) {
+    size_t changed = 0;
+    for (const auto& routeDelta : delta) {
+      changed += routeDelta.getOld() != routeDelta.getNew();
+    }
+    folly::doNotOptimizeAway(changed);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  facebook::initFacebook(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -41,6 +41,7 @@
 #include <array>
 #include <future>
 #include <string>
+#include <vector>
 
 using namespace facebook::fboss;
 using facebook::network::toBinaryAddress;
@@ -685,6 +686,53 @@ TEST(ArpTest, NotMine) {
   counters.checkDelta(SwitchStats::kCounterPrefix + "trapped.error.sum", 0);
 }
 
+TEST(ArpTest, NotMineBatch) {
+  auto handle = setupTestHandle();
+  auto sw = handle->getSw();
+
+  // ARP requests for 10.1.2.3
+  auto hex =
+      // dst mac, src mac
+      "ff ff ff ff ff ff  00 02 00 01 02 03"
+      // 802.1q, VLAN 1
+      "81 00  00 01"
+      // ARP, htype: ethernet, ptype: IPv4, hlen: 6, plen: 4
+      "08 06  00 01  08 00  06  04"
+      // ARP Request
+      "00 01"
+      // Sender MAC
+      "00 02 00 01 02 03"
+      // Sender IP: 10.1.2.15
+      "0a 01 02 0f"
+      // Target MAC
+      "00 00 00 00 00 00"
+      // Target IP: 10.1.2.3
+      "0a 01 02 03";
+  std::vector<std::unique_ptr<RxPacket>> pkts;
+  for (int i = 0; i < 3; ++i) {
+    auto pkt = MockRxPacket::fromHex(hex);
+    pkt->padToLength(68);
+    pkt->setSrcPort(PortID(1));
+    pkt->setSrcVlan(VlanID(1));
+    pkts.push_back(std::move(pkt));
+  }
+
+  // Cache the current stats
+  CounterCache counters(sw);
+
+  // Inform the SwSwitch of the ARP requests, as a single batch
+  sw->packetsReceived(folly::range(pkts));
+  sw->getNeighborUpdater()->waitForPendingUpdates();
+
+  // Every packet of the batch is counted and handled
+  counters.update();
+  counters.checkDelta(SwitchStats::kCounterPrefix + "trapped.pkts.sum", 3);
+  counters.checkDelta(SwitchStats::kCounterPrefix + "trapped.arp.sum", 3);
+  counters.checkDelta(SwitchStats::kCounterPrefix + "arp.not_mine.sum", 3);
+  counters.checkDelta(SwitchStats::kCounterPrefix + "trapped.drops.sum", 3);
+  counters.checkDelta(SwitchStats::kCounterPrefix + "trapped.error.sum", 0);
+}
+
 TEST(ArpTest, BadHlen) {
   auto handle = setupTestHandle();
   auto sw = handle->getSw();
@@ -0,0 +1,79 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/L2Entry.h"
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/test/HwTestHandle.h"
+#include "fboss/agent/test/TestUtils.h"
+
+#include <folly/Benchmark.h>
+#include <folly/MacAddress.h>
+
+using namespace facebook::fboss;
+
+namespace {
+
+// A second worth of learning during a rack reboot
+constexpr int kNumMacs = 10000;
+
+// Global state used by the benchmarks
+std::unique_ptr<HwTestHandle> handle;
+
+void sendL2LearningUpdates(L2EntryUpdateType l2EntryUpdateType) {
+  auto sw = handle->getSw();
+  for (int i = 0; i < kNumMacs; ++i) {
+    sw->l2LearningUpdateReceived(
+        L2Entry(
+            folly::MacAddress::fromHBO(0x020000000000 + i),
+            VlanID(1),
+            PortDescriptor(PortID(1 + i % 10)),
+            L2Entry::L2EntryType::L2_ENTRY_TYPE_PENDING),
+        l2EntryUpdateType);
+  }
+  waitForStateUpdates(sw);
+}
+
+} // namespace
+
+/*
+ * Learns kNumMacs MACs, on a MockHwSwitch. The agent keeps up with
+ * kNumMacs MACs per second as long as an iteration takes less than a second.
+ */
+BENCHMARK(MacLearning10k, numIters) {
+  for (size_t n = 0; n < numIters; ++n) {
+    sendL2LearningUpdates(L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_ADD);
+
+    BENCHMARK_SUSPEND {
+      sendL2LearningUpdates(L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_DELETE);
+    }
+  }
+}
+
+BENCHMARK(MacAging10k, numIters) {
+  for (size_t n = 0; n < numIters; ++n) {
+    BENCHMARK_SUSPEND {
+      sendL2LearningUpdates(L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_ADD);
+    }
+
+    sendL2LearningUpdates(L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_DELETE);
+  }
+}
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  // Setting up the switch is fairly expensive, do it once for all benchmarks
+  handle = createTestHandle(testStateA());
+
+  folly::runBenchmarks();
+  handle.reset();
+  return 0;
+}
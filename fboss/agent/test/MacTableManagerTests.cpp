@@ -18,6 +18,9 @@
 #include "fboss/agent/test/TestUtils.h"
 
 #include <folly/MacAddress.h>
+#include <folly/synchronization/Baton.h>
+
+using ::testing::_;
 
 namespace facebook {
 namespace fboss {
@@ -78,6 +81,43 @@ class MacTableManagerTest : public ::testing::Test {
     });
   }
 
+  /*
+   * Learns numMacs MACs while the update thread is busy, and checks they are
+   * programmed with a single hw update.
+   */
+  void triggerMacLearnedCbBurst(int numMacs) {
+    folly::Baton<> queued;
+    sw_->getUpdateEvb()->runInEventBaseThread([&queued]() { queued.wait(); });
+    for (int i = 0; i < numMacs; ++i) {
+      sw_->l2LearningUpdateReceived(
+          L2Entry(
+              burstMacAddress(i),
+              kVlan(),
+              PortDescriptor(kPortID()),
+              L2Entry::L2EntryType::L2_ENTRY_TYPE_PENDING),
+          L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_ADD);
+    }
+    EXPECT_HW_CALL(sw_, stateChanged(_)).Times(1);
+    queued.post();
+
+    waitForBackgroundThread(sw_);
+    waitForStateUpdates(sw_);
+  }
+
+  folly::MacAddress burstMacAddress(int i) const {
+    return MacAddress::fromHBO(0x020000000000 + i);
+  }
+
+  void verifyBurstMacsAreAdded(int numMacs) {
+    verifyStateUpdate([=]() {
+      auto vlan = sw_->getState()->getVlans()->getVlan(kVlan());
+      auto* macTable = vlan->getMacTable().get();
+      for (int i = 0; i < numMacs; ++i) {
+        EXPECT_NE(nullptr, macTable->getNodeIf(burstMacAddress(i)));
+      }
+    });
+  }
+
   void verifyMacIsDeleted() {
     verifyStateUpdate([=]() {
       auto vlan = sw_->getState()->getVlans()->getVlan(kVlan());
@@ -143,5 +183,11 @@ TEST_F(MacTableManagerTest, SameMacAgedCbTwice) {
   verifyMacIsDeleted();
 }
 
+TEST_F(MacTableManagerTest, MacLearnedCbBurst) {
+  triggerMacLearnedCbBurst(100);
+
+  verifyBurstMacsAreAdded(100);
+}
+
 } // namespace fboss
 } // namespace facebook
@@ -10,6 +10,7 @@
 
 #include <gtest/gtest.h>
 
+#include "fboss/agent/FbossError.h"
 #include "fboss/agent/L2Entry.h"
 #include "fboss/agent/MacTableUtils.h"
 #include "fboss/agent/state/Port.h"
@@ -165,5 +166,37 @@ TEST_F(MacTableUtilsTest, VerifyRemoveClassIDForAbsentEntry) {
   auto state = testStateA();
   verifyRemoveClassIDHelper(state, false /* macPresent */);
 }
+
+TEST_F(MacTableUtilsTest, VerifyBatchSkipsFailedUpdate) {
+  auto otherMac = MacAddress("01:02:03:04:05:07");
+  auto l2Entry = [this](MacAddress mac, VlanID vlan) {
+    return L2Entry(
+        mac,
+        vlan,
+        PortDescriptor(kPortID()),
+        L2Entry::L2EntryType::L2_ENTRY_TYPE_VALIDATED);
+  };
+  // The second update is for a VLAN that does not exist
+  std::vector<std::pair<L2Entry, L2EntryUpdateType>> l2Updates{
+      {l2Entry(kMacAddress(), kVlan()),
+       L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_ADD},
+      {l2Entry(kMacAddress(), VlanID(4000)),
+       L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_ADD},
+      {l2Entry(otherMac, kVlan()), L2EntryUpdateType::L2_ENTRY_UPDATE_TYPE_ADD},
+  };
+
+  auto state = testStateA();
+  EXPECT_THROW(
+      MacTableUtils::updateMacTable(
+          state, l2Updates[1].first, l2Updates[1].second),
+      FbossError);
+
+  auto newState = MacTableUtils::updateMacTable(state, l2Updates);
+  auto* macTable =
+      newState->getVlans()->getVlanIf(kVlan())->getMacTable().get();
+  EXPECT_NE(nullptr, macTable->getNodeIf(kMacAddress()));
+  EXPECT_NE(nullptr, macTable->getNodeIf(otherMac));
+  EXPECT_EQ(nullptr, newState->getVlans()->getVlanIf(VlanID(4000)));
+}
 } // namespace fboss
 } // namespace facebook
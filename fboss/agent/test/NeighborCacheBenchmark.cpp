@@ -0,0 +1,117 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include <folly/Benchmark.h>
+#include <folly/IPAddressV4.h>
+#include <folly/io/async/ScopedEventBaseThread.h>
+#include "fboss/agent/ArpCache.h"
+#include "fboss/agent/NeighborCacheEntry.h"
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/hw/sim/SimPlatform.h"
+#include "fboss/agent/state/ArpTable.h"
+#include "fboss/agent/state/SwitchState.h"
+
+using namespace facebook::fboss;
+using folly::IPAddressV4;
+using folly::MacAddress;
+using std::make_unique;
+using std::unique_ptr;
+
+namespace {
+
+using Entry = NeighborCacheEntry<ArpTable>;
+
+constexpr uint32_t kNumEntries = 100000;
+
+// Global state used by the benchmarks
+unique_ptr<SwSwitch> sw;
+unique_ptr<ArpCache> cache;
+unique_ptr<folly::ScopedEventBaseThread> neighborThread;
+
+void init() {
+  MacAddress localMac("02:00:01:00:00:01");
+  sw = make_unique<SwSwitch>(make_unique<SimPlatform>(localMac, 10));
+  sw->init(nullptr /* No custom TunManager */);
+  cache = make_unique<ArpCache>(
+      sw.get(), sw->getState().get(), VlanID(1), "Vlan1", InterfaceID(1));
+  neighborThread = make_unique<folly::ScopedEventBaseThread>();
+}
+
+/*
+ * Creates kNumEntries REACHABLE entries, and waits for the neighbor thread to
+ * schedule their aging timeouts.
+ */
+std::vector<std::shared_ptr<Entry>> createEntries() {
+  auto evb = neighborThread->getEventBase();
+  std::vector<std::shared_ptr<Entry>> entries;
+  entries.reserve(kNumEntries);
+  // 10.0.0.0/15 has room for all the entries
+  uint32_t firstIP = IPAddressV4("10.0.0.0").toLongHBO();
+  for (uint32_t i = 0; i < kNumEntries; ++i) {
+    entries.push_back(std::make_shared<Entry>(
+        IPAddressV4::fromLongHBO(firstIP + i),
+        MacAddress::fromHBO(0x020000000000 + i),
+        PortDescriptor(PortID(1)),
+        InterfaceID(1),
+        evb,
+        cache.get(),
+        NeighborEntryState::REACHABLE));
+  }
+  // Entries schedule their timeouts from the neighbor thread's queue, which
+  // is processed in order
+  evb->runInEventBaseThreadAndWait([]() {});
+  return entries;
+}
+
+void destroyEntries(std::vector<std::shared_ptr<Entry>> entries) {
+  // Cancelling the timeouts must happen on the neighbor thread
+  neighborThread->getEventBase()->runInEventBaseThreadAndWait(
+      [&entries]() { entries.clear(); });
+}
+
+} // unnamed namespace
+
+BENCHMARK(NeighborEntriesCreateAndFlush100k) {
+  auto entries = createEntries();
+  destroyEntries(std::move(entries));
+}
+
+BENCHMARK(NeighborEntriesRefresh100k, numIters) {
+  std::vector<std::shared_ptr<Entry>> entries;
+  BENCHMARK_SUSPEND {
+    entries = createEntries();
+  }
+
+  // Each refresh reschedules the entry's aging timeout, as receiving an ARP
+  // reply for a REACHABLE entry does
+  auto evb = neighborThread->getEventBase();
+  for (size_t n = 0; n < numIters; ++n) {
+    for (auto& entry : entries) {
+      entry->updateState(NeighborEntryState::REACHABLE);
+    }
+    evb->runInEventBaseThreadAndWait([]() {});
+  }
+
+  BENCHMARK_SUSPEND {
+    destroyEntries(std::move(entries));
+  }
+}
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  // Set up the switch and the cache once, outside of the benchmarks
+  init();
+
+  folly::runBenchmarks();
+
+  cache.reset();
+  neighborThread.reset();
+  return 0;
+}
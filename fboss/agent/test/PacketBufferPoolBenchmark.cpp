@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include <folly/Benchmark.h>
+#include <folly/io/IOBuf.h>
+#include "fboss/agent/PacketBufferPool.h"
+
+#include <gflags/gflags.h>
+
+#include <memory>
+#include <vector>
+
+using namespace facebook::fboss;
+using folly::IOBuf;
+
+namespace {
+
+// Packets built before any of them is freed, as in a flood of ARP or NDP
+// packets waiting to be sent
+constexpr size_t kBurstSize = 64;
+
+/*
+ * What the packets used before the pool: a single allocation up to 1KB, the
+ * IOBuf and its buffer allocated separately above that.
+ */
+void unpooled(uint32_t size, size_t numIters, bool separate) {
+  std::vector<std::unique_ptr<IOBuf>> bufs;
+  bufs.reserve(kBurstSize);
+  for (size_t n = 0; n < numIters; ++n) {
+    for (size_t i = 0; i < kBurstSize; ++i) {
+      bufs.push_back(
+          separate ? IOBuf::createSeparate(size) : IOBuf::create(size));
+      bufs.back()->append(size);
+    }
+    bufs.clear();
+  }
+}
+
+/*
+ * The packets' IOBufs come from the pool and are recycled when the packets
+ * are freed. Once the first burst has filled the pool, packets no longer
+ * allocate anything.
+ */
+void pooled(uint32_t size, size_t numIters) {
+  PacketBufferPool pool;
+  std::vector<std::unique_ptr<IOBuf>> bufs;
+  bufs.reserve(kBurstSize);
+  for (size_t n = 0; n < numIters; ++n) {
+    for (size_t i = 0; i < kBurstSize; ++i) {
+      bufs.push_back(pool.allocate(size));
+    }
+    for (auto& buf : bufs) {
+      pool.recycle(std::move(buf));
+    }
+    bufs.clear();
+  }
+}
+
+} // unnamed namespace
+
+// LACP and ARP sized packets
+BENCHMARK(Unpooled64, numIters) {
+  unpooled(64, numIters, false /* separate */);
+}
+
+BENCHMARK_RELATIVE(Pooled64, numIters) {
+  pooled(64, numIters);
+}
+
+// NDP and LLDP sized packets
+BENCHMARK(Unpooled512, numIters) {
+  unpooled(512, numIters, false /* separate */);
+}
+
+BENCHMARK_RELATIVE(Pooled512, numIters) {
+  pooled(512, numIters);
+}
+
+// MTU sized packets, sent as SaiTxPacket used to allocate them
+BENCHMARK(UnpooledSeparate1500, numIters) {
+  unpooled(1500, numIters, true /* separate */);
+}
+
+BENCHMARK_RELATIVE(Pooled1500, numIters) {
+  pooled(1500, numIters);
+}
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
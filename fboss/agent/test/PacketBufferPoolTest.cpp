@@ -0,0 +1,112 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/PacketBufferPool.h"
+#include "fboss/agent/test/CounterCache.h"
+
+#include <folly/io/IOBuf.h>
+#include <gtest/gtest.h>
+
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace facebook::fboss;
+using folly::IOBuf;
+
+TEST(PacketBufferPoolTest, RecyclesBuffers) {
+  PacketBufferPool pool;
+  CounterCache counters(nullptr);
+
+  auto buf = pool.allocate(100);
+  EXPECT_EQ(100, buf->length());
+  EXPECT_LE(128, buf->capacity());
+  auto ioBuf = buf.get();
+  buf->advance(10);
+  pool.recycle(std::move(buf));
+
+  // Any size of the same class gets the recycled IOBuf back, reset
+  buf = pool.allocate(65);
+  EXPECT_EQ(ioBuf, buf.get());
+  EXPECT_EQ(65, buf->length());
+  EXPECT_EQ(0, buf->headroom());
+
+  counters.update();
+  counters.checkDelta("packet_buffer_pool.hits.sum", 1);
+  counters.checkDelta("packet_buffer_pool.misses.sum", 1);
+}
+
+TEST(PacketBufferPoolTest, SizeClasses) {
+  PacketBufferPool pool;
+  auto checkClass = [&pool](uint32_t size, uint32_t sizeClass) {
+    auto buf = pool.allocate(size);
+    EXPECT_EQ(size, buf->length());
+    EXPECT_LE(sizeClass, buf->capacity());
+    EXPECT_GT(2 * sizeClass, buf->capacity());
+  };
+  checkClass(300, 512);
+  checkClass(1500, 2048);
+  checkClass(10240, 10240);
+
+  // Too large to be pooled
+  auto buf = pool.allocate(20000);
+  EXPECT_EQ(20000, buf->length());
+  EXPECT_LE(20000, buf->capacity());
+  auto ioBuf = buf.get();
+  pool.recycle(std::move(buf));
+  buf = pool.allocate(20000);
+  EXPECT_NE(ioBuf, buf.get());
+}
+
+TEST(PacketBufferPoolTest, SharedBuffers) {
+  PacketBufferPool pool;
+  auto buf = pool.allocate(64);
+  auto ioBuf = buf.get();
+  auto clone = buf->clone();
+
+  // The buffer is still in use by the clone, the IOBuf is freed instead
+  pool.recycle(std::move(buf));
+  buf = pool.allocate(64);
+  EXPECT_NE(ioBuf, buf.get());
+
+  // Once the clone is gone the buffer is no longer shared
+  clone.reset();
+  ioBuf = buf.get();
+  pool.recycle(std::move(buf));
+  EXPECT_EQ(ioBuf, pool.allocate(64).get());
+}
+
+TEST(PacketBufferPoolTest, RecycledOnOtherThread) {
+  PacketBufferPool pool;
+  const size_t kNumBuffers = 2 * PacketBufferPool::kThreadCacheSize;
+
+  std::vector<std::unique_ptr<IOBuf>> bufs;
+  std::set<const IOBuf*> ioBufs;
+  for (size_t i = 0; i < kNumBuffers; ++i) {
+    bufs.push_back(pool.allocate(1000));
+    ioBufs.insert(bufs.back().get());
+  }
+
+  // IOBufs recycled on a thread that doesn't allocate any end up in the depot
+  std::thread([&pool, &bufs]() {
+    for (auto& buf : bufs) {
+      pool.recycle(std::move(buf));
+    }
+  }).join();
+  bufs.clear();
+
+  CounterCache counters(nullptr);
+  for (size_t i = 0; i < kNumBuffers; ++i) {
+    bufs.push_back(pool.allocate(1000));
+    EXPECT_EQ(1, ioBufs.count(bufs.back().get()));
+  }
+  counters.update();
+  counters.checkDelta("packet_buffer_pool.hits.sum", kNumBuffers);
+  counters.checkDelta("packet_buffer_pool.misses.sum", 0);
+}
@@ -0,0 +1,243 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/RxPacketPipeline.h"
+#include "fboss/agent/SwSwitch.h"
+#include "fboss/agent/SwitchStats.h"
+#include "fboss/agent/hw/mock/MockHwSwitch.h"
+#include "fboss/agent/hw/mock/MockRxPacket.h"
+#include "fboss/agent/packet/PktUtil.h"
+#include "fboss/agent/state/ArpResponseTable.h"
+#include "fboss/agent/state/Interface.h"
+#include "fboss/agent/state/InterfaceMap.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/state/Vlan.h"
+#include "fboss/agent/state/VlanMap.h"
+#include "fboss/agent/test/CounterCache.h"
+#include "fboss/agent/test/HwTestHandle.h"
+#include "fboss/agent/test/TestUtils.h"
+
+#include <folly/Conv.h>
+#include <folly/Synchronized.h>
+#include <folly/synchronization/Baton.h>
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+DECLARE_uint32(rx_pipeline_threads);
+DECLARE_uint32(rx_pipeline_queue_size);
+
+using namespace facebook::fboss;
+using Queue = RxPacketPipeline::Queue;
+using ::testing::_;
+
+namespace {
+
+const std::string kIPv6Addresses =
+    "20 01 0d b8 00 00 00 00 00 00 00 00 00 00 00 01 "
+    "20 01 0d b8 00 00 00 00 00 00 00 00 00 00 00 02";
+
+std::unique_ptr<MockRxPacket> makePacket(const std::string& ethertype) {
+  auto pkt = MockRxPacket::fromHex(folly::to<std::string>(
+      "02 00 00 00 00 01 02 00 00 00 00 02 ", ethertype));
+  pkt->padToLength(64);
+  return pkt;
+}
+
+std::unique_ptr<MockRxPacket> makeIPv6Packet(const std::string& nextHeader) {
+  return makePacket(folly::to<std::string>(
+      "86 dd 60 00 00 00 00 20 ",
+      nextHeader,
+      " ff ",
+      kIPv6Addresses,
+      // ICMPv6 neighbor solicitation, or UDP source port
+      " 87 00"));
+}
+
+/*
+ * Records the queue of every packet it handles. The first packet blocks the
+ * (single) worker until release() is called.
+ */
+class BlockingHandler {
+ public:
+  void operator()(std::unique_ptr<RxPacket> pkt) {
+    bool first = handled_.wlock()->empty();
+    handled_.wlock()->push_back(RxPacketPipeline::classify(pkt.get()));
+    if (first) {
+      started_.post();
+      released_.wait();
+    }
+    if (handled_.rlock()->size() == expected_) {
+      done_.post();
+    }
+  }
+
+  void waitForFirstPacket() {
+    started_.wait();
+  }
+
+  void release(size_t expected) {
+    expected_ = expected;
+    released_.post();
+  }
+
+  std::vector<Queue> waitForPackets() {
+    done_.wait();
+    return handled_.copy();
+  }
+
+ private:
+  folly::Synchronized<std::vector<Queue>> handled_;
+  std::atomic<size_t> expected_{0};
+  folly::Baton<> started_;
+  folly::Baton<> released_;
+  folly::Baton<> done_;
+};
+
+} // namespace
+
+TEST(RxPacketPipelineTest, Classify) {
+  auto classify = [](std::unique_ptr<MockRxPacket> pkt) {
+    return RxPacketPipeline::classify(pkt.get());
+  };
+  EXPECT_EQ(Queue::LACP, classify(makePacket("88 09 01")));
+  EXPECT_EQ(Queue::LLDP, classify(makePacket("88 cc")));
+  EXPECT_EQ(Queue::ARP, classify(makePacket("08 06")));
+  EXPECT_EQ(Queue::ARP, classify(makePacket("81 00 00 05 08 06")));
+  EXPECT_EQ(Queue::IPV4, classify(makePacket("08 00")));
+  EXPECT_EQ(Queue::NDP, classify(makeIPv6Packet("3a")));
+  EXPECT_EQ(Queue::IPV6, classify(makeIPv6Packet("11")));
+  EXPECT_EQ(Queue::OTHER, classify(makePacket("88 47")));
+  // Too short for an ethertype
+  EXPECT_EQ(Queue::OTHER, classify(MockRxPacket::fromHex("02 00 00")));
+}
+
+TEST(RxPacketPipelineTest, ControlPacketsFirst) {
+  BlockingHandler handler;
+  RxPacketPipeline pipeline(1, 16, [&handler](std::unique_ptr<RxPacket> pkt) {
+    handler(std::move(pkt));
+  });
+  EXPECT_TRUE(pipeline.enqueue(makePacket("08 00")));
+  handler.waitForFirstPacket();
+
+  // An ARP flood queued ahead of LACP and LLDP doesn't delay them
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(pipeline.enqueue(makePacket("08 06")));
+  }
+  EXPECT_TRUE(pipeline.enqueue(makeIPv6Packet("11")));
+  EXPECT_TRUE(pipeline.enqueue(makePacket("88 cc")));
+  EXPECT_TRUE(pipeline.enqueue(makePacket("88 09 01")));
+  handler.release(7);
+
+  std::vector<Queue> expected{Queue::IPV4,
+                              Queue::LACP,
+                              Queue::LLDP,
+                              Queue::ARP,
+                              Queue::ARP,
+                              Queue::ARP,
+                              Queue::IPV6};
+  EXPECT_EQ(expected, handler.waitForPackets());
+}
+
+TEST(RxPacketPipelineTest, FullQueuesDrop) {
+  BlockingHandler handler;
+  RxPacketPipeline pipeline(1, 2, [&handler](std::unique_ptr<RxPacket> pkt) {
+    handler(std::move(pkt));
+  });
+  EXPECT_TRUE(pipeline.enqueue(makePacket("08 06")));
+  handler.waitForFirstPacket();
+
+  EXPECT_TRUE(pipeline.enqueue(makePacket("08 06")));
+  EXPECT_TRUE(pipeline.enqueue(makePacket("08 06")));
+  EXPECT_FALSE(pipeline.enqueue(makePacket("08 06")));
+  // Other protocols have their own queues
+  EXPECT_TRUE(pipeline.enqueue(makePacket("88 09 01")));
+  EXPECT_EQ(1, pipeline.getDrops(Queue::ARP));
+  EXPECT_EQ(0, pipeline.getDrops(Queue::LACP));
+
+  handler.release(4);
+  EXPECT_EQ(4, handler.waitForPackets().size());
+}
+
+TEST(RxPacketPipelineTest, SwSwitchPacketsGoThroughPipeline) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_rx_pipeline_threads = 1;
+  FLAGS_rx_pipeline_queue_size = 2;
+
+  // Answer ARP requests for 10.0.0.1 on VLAN 1
+  auto state = testStateA();
+  auto intf = state->getInterfaces()->getInterface(InterfaceID(1));
+  auto arpResponses = std::make_shared<ArpResponseTable>();
+  arpResponses->setEntry(
+      folly::IPAddressV4("10.0.0.1"), intf->getMac(), intf->getID());
+  state->getVlans()->getVlan(VlanID(1))->setArpResponseTable(arpResponses);
+  auto handle = createTestHandle(state);
+  auto sw = handle->getSw();
+  sw->initialConfigApplied(std::chrono::steady_clock::now());
+  waitForStateUpdates(sw);
+  auto pipeline = sw->getRxPacketPipeline();
+  ASSERT_NE(nullptr, pipeline);
+
+  // The first ARP reply blocks the (single) worker until released
+  const int kNumHandled = 3;
+  std::atomic<int> numReplies{0};
+  folly::Baton<> firstReply;
+  folly::Baton<> released;
+  folly::Baton<> done;
+  EXPECT_HW_CALL(sw, sendPacketOutOfPortAsync_(_, PortID(1), _))
+      .Times(kNumHandled)
+      .WillRepeatedly(testing::Invoke(
+          [&](TxPacket* /*pkt*/, PortID /*port*/, std::optional<uint8_t>) {
+            auto reply = ++numReplies;
+            if (reply == 1) {
+              firstReply.post();
+              released.wait();
+            }
+            if (reply == kNumHandled) {
+              done.post();
+            }
+            return true;
+          }));
+
+  // ARP request for 10.0.0.1 from 10.0.1.15, which is not in any of our
+  // subnets, so that no neighbor entry gets added
+  auto arpRequest = [&handle]() {
+    handle->rxPacket(
+        std::make_unique<folly::IOBuf>(PktUtil::parseHexData(
+            "ff ff ff ff ff ff  00 02 00 01 02 03  81 00 00 01 "
+            "08 06  00 01  08 00  06  04  00 01 "
+            "00 02 00 01 02 03  0a 00 01 0f "
+            "00 00 00 00 00 00  0a 00 00 01")),
+        PortID(1),
+        VlanID(1));
+  };
+  CounterCache counters(sw);
+  arpRequest();
+  firstReply.wait();
+
+  // The worker is busy with the first request, the next two fill the ARP
+  // queue and the last one is dropped
+  for (int i = 0; i < kNumHandled; ++i) {
+    arpRequest();
+  }
+  EXPECT_EQ(1, pipeline->getDrops(Queue::ARP));
+  EXPECT_EQ(0, pipeline->getDrops(Queue::LACP));
+
+  released.post();
+  done.wait();
+  counters.update();
+  counters.checkDelta("rx_pipeline.arp.drops.sum", 1);
+  counters.checkDelta(
+      SwitchStats::kCounterPrefix + "arp.request.rx.sum", kNumHandled);
+  counters.checkDelta(
+      SwitchStats::kCounterPrefix + "arp.reply.tx.sum", kNumHandled);
+}
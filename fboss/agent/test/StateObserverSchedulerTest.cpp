@@ -0,0 +1,161 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+#include "fboss/agent/StateObserverScheduler.h"
+#include "fboss/agent/FbossError.h"
+#include "fboss/agent/StateObserver.h"
+#include "fboss/agent/state/StateDelta.h"
+#include "fboss/agent/state/SwitchState.h"
+
+#include <folly/Synchronized.h>
+#include <folly/synchronization/Baton.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace facebook::fboss;
+
+namespace {
+
+using Notifications = folly::Synchronized<std::vector<std::string>>;
+
+class RecordingObserver : public StateObserver {
+ public:
+  RecordingObserver(
+      std::string name,
+      Notifications* notifications,
+      std::vector<const RecordingObserver*> dependencies = {})
+      : name_(std::move(name)),
+        notifications_(notifications),
+        dependencies_(std::move(dependencies)) {}
+
+  void stateUpdated(const StateDelta& /*delta*/) override {
+    threadId = std::this_thread::get_id();
+    for (auto dependency : dependencies_) {
+      if (!dependency->done) {
+        ++dependenciesPending;
+      }
+    }
+    if (wait) {
+      wait->wait();
+    }
+    if (post) {
+      post->post();
+    }
+    notifications_->wlock()->push_back(name_);
+    done = true;
+  }
+
+  std::thread::id threadId;
+  // Number of dependencies not done yet when this observer was notified
+  std::atomic<int> dependenciesPending{0};
+  std::atomic<bool> done{false};
+  folly::Baton<>* wait{nullptr};
+  folly::Baton<>* post{nullptr};
+
+ private:
+  std::string name_;
+  Notifications* notifications_;
+  std::vector<const RecordingObserver*> dependencies_;
+};
+
+class StateObserverSchedulerTest : public ::testing::TestWithParam<uint32_t> {
+ protected:
+  void notify(StateObserverScheduler* scheduler) {
+    StateDelta delta(
+        std::make_shared<SwitchState>(), std::make_shared<SwitchState>());
+    scheduler->notify(delta);
+  }
+
+  Notifications notifications_;
+};
+
+} // namespace
+
+TEST_P(StateObserverSchedulerTest, DependenciesAreNotifiedFirst) {
+  StateObserverScheduler scheduler(GetParam());
+  // first does not finish before release has been notified, so second,
+  // registered earlier than both, would see it pending if its dependency
+  // were ignored
+  folly::Baton<> released;
+  RecordingObserver first("first", &notifications_);
+  RecordingObserver second("second", &notifications_, {&first});
+  RecordingObserver third("third", &notifications_, {&second});
+  RecordingObserver release("release", &notifications_);
+  RecordingObserver independent("independent", &notifications_);
+  first.wait = &released;
+  release.post = &released;
+  scheduler.addObserver(&third, "third", {"second"}, true /* concurrent */);
+  scheduler.addObserver(&second, "second", {"first"}, false /* concurrent */);
+  scheduler.addObserver(&release, "release", {}, false /* concurrent */);
+  scheduler.addObserver(&first, "first", {}, true /* concurrent */);
+  scheduler.addObserver(
+      &independent, "independent", {"notRegistered"}, true /* concurrent */);
+
+  notify(&scheduler);
+
+  EXPECT_EQ(5, notifications_.rlock()->size());
+  for (auto observer : {&first, &second, &third, &release, &independent}) {
+    EXPECT_TRUE(observer->done);
+    EXPECT_EQ(0, observer->dependenciesPending);
+  }
+  // Observers which are not concurrent stay on the update thread
+  EXPECT_EQ(std::this_thread::get_id(), second.threadId);
+  EXPECT_EQ(std::this_thread::get_id(), release.threadId);
+  if (GetParam() == 0) {
+    EXPECT_EQ(std::this_thread::get_id(), first.threadId);
+    EXPECT_EQ(std::this_thread::get_id(), third.threadId);
+  } else {
+    EXPECT_NE(std::this_thread::get_id(), first.threadId);
+    EXPECT_NE(std::this_thread::get_id(), third.threadId);
+  }
+}
+
+TEST_P(StateObserverSchedulerTest, RemovedObserversAreNotNotified) {
+  StateObserverScheduler scheduler(GetParam());
+  RecordingObserver first("first", &notifications_);
+  RecordingObserver second("second", &notifications_);
+  scheduler.addObserver(&first, "first", {}, true /* concurrent */);
+  scheduler.addObserver(&second, "second", {"first"}, true /* concurrent */);
+  EXPECT_TRUE(scheduler.hasObserver(&first));
+
+  scheduler.removeObserver(&first);
+  EXPECT_FALSE(scheduler.hasObserver(&first));
+  EXPECT_THROW(scheduler.removeObserver(&first), FbossError);
+  notify(&scheduler);
+
+  EXPECT_EQ(std::vector<std::string>{"second"}, notifications_.copy());
+}
+
+TEST_P(StateObserverSchedulerTest, CyclicDependenciesAreRejected) {
+  StateObserverScheduler scheduler(GetParam());
+  RecordingObserver first("first", &notifications_);
+  RecordingObserver second("second", &notifications_);
+  scheduler.addObserver(&first, "first", {"second"}, false /* concurrent */);
+  EXPECT_THROW(
+      scheduler.addObserver(&first, "first", {}, false /* concurrent */),
+      FbossError);
+  EXPECT_THROW(
+      scheduler.addObserver(
+          &second, "second", {"first"}, false /* concurrent */),
+      FbossError);
+  EXPECT_FALSE(scheduler.hasObserver(&second));
+
+  notify(&scheduler);
+  EXPECT_EQ(std::vector<std::string>{"first"}, notifications_.copy());
+}
+
+INSTANTIATE_TEST_CASE_P(
+    StateObserverSchedulerTest,
+    StateObserverSchedulerTest,
+    ::testing::Values(0, 4));
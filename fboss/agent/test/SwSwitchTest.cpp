@@ -18,6 +18,7 @@
 #include "fboss/agent/state/ArpTable.h"
 #include "fboss/agent/state/Interface.h"
 #include "fboss/agent/state/Port.h"
+#include "fboss/agent/state/StateDelta.h"
 #include "fboss/agent/state/SwitchState.h"
 #include "fboss/agent/state/Vlan.h"
 #include "fboss/agent/test/CounterCache.h"
@@ -27,6 +28,7 @@
 #include <folly/IPAddressV4.h>
 #include <folly/IPAddressV6.h>
 #include <folly/MacAddress.h>
+#include <folly/synchronization/Baton.h>
 
 #include <algorithm>
 
@@ -185,3 +187,71 @@ TEST_F(SwSwitchTest, TestStateNonCoalescing) {
   // 0 neighbor entries expected, i.e. entries must be purged
   verifyReachableCnt(0);
 }
+
+TEST_F(SwSwitchTest, StateUpdateTraces) {
+  auto newState = bringAllPortsUp(sw->getState()->clone());
+  sw->updateState(
+      "Traced update",
+      [=](const std::shared_ptr<SwitchState>& /*state*/) { return newState; });
+  waitForStateUpdates(sw);
+
+  // The no-op update of waitForStateUpdates() is traced too
+  auto traces = sw->getStateUpdateTraces(100);
+  ASSERT_GE(traces.size(), 2);
+  EXPECT_EQ(1, sw->getStateUpdateTraces(1).size());
+  EXPECT_TRUE(sw->getStateUpdateTraces(0).empty());
+  auto trace = std::find_if(traces.begin(), traces.end(), [](auto& trace) {
+    return trace.name == "Traced update";
+  });
+  ASSERT_NE(traces.end(), trace);
+  EXPECT_GE(trace->coalescedUpdates, 1);
+  EXPECT_GT(trace->startTimeMs, 0);
+  EXPECT_GE(
+      trace->totalUs,
+      trace->updateFnsUs + trace->publishUs + trace->deltaUs + trace->hwUs +
+          trace->observersUs);
+  // Traces are most recent first
+  EXPECT_GE(traces.front().startTimeMs, trace->startTimeMs);
+}
+
+TEST_F(SwSwitchTest, MergeableUpdatesShareHwUpdates) {
+  sw->updateStateBlocking("Bring Ports Up", [](const auto& state) {
+    return bringAllPortsUp(state);
+  });
+  auto setOperState = [this](PortID portID, bool up) {
+    sw->updateStateNoCoalescing(
+        "Port OperState Update",
+        [=](const std::shared_ptr<SwitchState>& state) {
+          std::shared_ptr<SwitchState> newState(state);
+          auto port = newState->getPorts()->getPort(portID)->modify(&newState);
+          port->setOperState(up);
+          return newState;
+        },
+        folly::to<std::string>("port ", portID));
+  };
+  // Queue all the updates before the update thread gets to them
+  folly::Baton<> queued;
+  sw->getUpdateEvb()->runInEventBaseThread([&queued]() { queued.wait(); });
+  setOperState(PortID(1), false);
+  setOperState(PortID(2), false);
+  // Port 1 going down must reach the hw before it comes back up
+  setOperState(PortID(1), true);
+  setOperState(PortID(2), true);
+  EXPECT_HW_CALL(sw, stateChanged(_))
+      .Times(2)
+      .WillRepeatedly(::testing::Invoke([](const StateDelta& delta) {
+        int changedPorts = 0;
+        for (const auto& portDelta : delta.getPortsDelta()) {
+          EXPECT_NE(portDelta.getOld()->isUp(), portDelta.getNew()->isUp());
+          ++changedPorts;
+        }
+        EXPECT_EQ(2, changedPorts);
+        return delta.newState();
+      }));
+  queued.post();
+  waitForStateUpdates(sw);
+
+  auto ports = sw->getState()->getPorts();
+  EXPECT_TRUE(ports->getPort(PortID(1))->isUp());
+  EXPECT_TRUE(ports->getPort(PortID(2))->isUp());
+}
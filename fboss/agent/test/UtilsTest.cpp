@@ -0,0 +1,61 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/agent/Constants.h"
+#include "fboss/agent/Utils.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/test/TestUtils.h"
+
+#include <folly/FileUtil.h>
+#include <folly/dynamic.h>
+#include <folly/experimental/TestUtil.h>
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+
+namespace {
+
+folly::dynamic testWarmBootState() {
+  folly::dynamic state = folly::dynamic::object;
+  state[kSwSwitch] = testStateA()->toFollyDynamic();
+  return state;
+}
+
+folly::dynamic readState(const std::string& filename) {
+  std::string serializedState;
+  EXPECT_TRUE(folly::readFile(filename.c_str(), serializedState));
+  return parseState(serializedState);
+}
+
+} // namespace
+
+TEST(Utils, dumpAndParseJsonState) {
+  folly::test::TemporaryDirectory tmpDir;
+  auto filename = (tmpDir.path() / "switch_state").string();
+  auto state = testWarmBootState();
+
+  ASSERT_TRUE(dumpStateToFile(filename, state));
+  auto parsedState = readState(filename);
+  EXPECT_EQ(state, parsedState);
+  EXPECT_NE(nullptr, SwitchState::fromFollyDynamic(parsedState[kSwSwitch]));
+}
+
+TEST(Utils, dumpAndParseBinaryState) {
+  folly::test::TemporaryDirectory tmpDir;
+  auto jsonFilename = (tmpDir.path() / "switch_state.json").string();
+  auto binaryFilename = (tmpDir.path() / "switch_state").string();
+  auto state = testWarmBootState();
+
+  ASSERT_TRUE(dumpStateToFile(jsonFilename, state));
+  ASSERT_TRUE(dumpBinaryStateToFile(binaryFilename, state));
+  auto parsedState = readState(binaryFilename);
+  EXPECT_EQ(state, parsedState);
+  EXPECT_EQ(readState(jsonFilename), parsedState);
+}
@@ -0,0 +1,126 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "common/init/Init.h"
+#include "fboss/agent/Constants.h"
+#include "fboss/agent/Utils.h"
+#include "fboss/agent/hw/sim/SimPlatform.h"
+#include "fboss/agent/hw/test/ConfigFactory.h"
+#include "fboss/agent/state/SwitchState.h"
+#include "fboss/agent/test/HwTestHandle.h"
+#include "fboss/agent/test/RouteScaleGenerators.h"
+#include "fboss/agent/test/TestUtils.h"
+
+#include <folly/Benchmark.h>
+#include <folly/MacAddress.h>
+#include <folly/dynamic.h>
+#include <folly/experimental/bser/Bser.h>
+#include <folly/json.h>
+
+#include <iostream>
+
+using namespace facebook::fboss;
+
+namespace {
+
+/*
+ * Switch state holding the (large) HGRID UU route distribution, i.e. what
+ * gets serialized on graceful exit.
+ */
+std::shared_ptr<SwitchState> scaleState() {
+  auto constexpr kEcmpWidth = 4;
+  static std::shared_ptr<SwitchState> state;
+  if (state) {
+    return state;
+  }
+  SimPlatform plat(folly::MacAddress(), 100);
+  std::vector<PortID> ports;
+  for (int i = 0; i < 128; ++i) {
+    ports.push_back(PortID(i));
+  }
+  cfg::SwitchConfig config =
+      utility::onePortPerVlanConfig(plat.getHwSwitch(), ports);
+  auto testHandle = createTestHandle(&config);
+  auto generator = utility::HgridUuRouteScaleGenerator(
+      testHandle->getSw()->getAppliedState(), 1337, kEcmpWidth);
+  const auto& states = generator.getSwitchStates();
+  state = states[states.size() - 1];
+  return state;
+}
+
+folly::dynamic warmBootState() {
+  folly::dynamic switchState = folly::dynamic::object;
+  switchState[kSwSwitch] = scaleState()->toFollyDynamic();
+  return switchState;
+}
+
+std::string serialize(const folly::dynamic& switchState, bool binary) {
+  if (binary) {
+    return folly::bser::toBser(switchState, folly::bser::serialization_opts())
+        .toStdString();
+  }
+  return folly::toPrettyJson(switchState);
+}
+
+/*
+ * Exit: SwitchState -> folly::dynamic -> serialized state
+ */
+void exitBenchmark(bool binary) {
+  folly::BenchmarkSuspender suspender;
+  scaleState();
+  suspender.dismiss();
+
+  auto serialized = serialize(warmBootState(), binary);
+  folly::doNotOptimizeAway(serialized.size());
+}
+
+/*
+ * Init: serialized state -> folly::dynamic -> SwitchState
+ */
+void initBenchmark(bool binary) {
+  folly::BenchmarkSuspender suspender;
+  auto serialized = serialize(warmBootState(), binary);
+  suspender.dismiss();
+
+  auto switchState = parseState(serialized);
+  auto state = SwitchState::uniquePtrFromFollyDynamic(switchState[kSwSwitch]);
+  folly::doNotOptimizeAway(state);
+}
+
+} // namespace
+
+BENCHMARK(WarmBootExitJson) {
+  exitBenchmark(false /* binary */);
+}
+
+BENCHMARK_RELATIVE(WarmBootExitBinary) {
+  exitBenchmark(true /* binary */);
+}
+
+BENCHMARK(WarmBootInitJson) {
+  initBenchmark(false /* binary */);
+}
+
+BENCHMARK_RELATIVE(WarmBootInitBinary) {
+  initBenchmark(true /* binary */);
+}
+
+int main(int argc, char** argv) {
+  facebook::initFacebook(&argc, &argv);
+  folly::runBenchmarks();
+
+  auto switchState = warmBootState();
+  std::cout << "Serialized switch state: "
+            << serialize(switchState, false /* binary */).size()
+            << " bytes of JSON, "
+            << serialize(switchState, true /* binary */).size()
+            << " bytes of BSER" << std::endl;
+  return EXIT_SUCCESS;
+}
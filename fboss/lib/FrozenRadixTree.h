@@ -0,0 +1,215 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <folly/Bits.h>
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+
+namespace facebook {
+namespace network {
+
+/*
+ * Prefix and value of a value node in a FrozenRadixTree.
+ */
+template <typename IPADDRTYPE, typename T>
+struct FrozenRadixTreeEntry {
+  IPADDRTYPE ipAddress;
+  uint8_t masklen;
+  T value;
+};
+
+/*
+ * FrozenRadixTree is an immutable, read optimized snapshot of a RadixTree.
+ *
+ * The (path compressed) nodes of the source tree are laid out contiguously
+ * in BFS order, so the top levels of the tree, which every lookup walks
+ * through, share a handful of cache lines. Each node is 32 bytes, with the
+ * prefix stored as two host order uint64_t, and matching a node is a couple
+ * of xor/mask operations rather than a IPADDRTYPE::mask() and compare.
+ * Values are kept out of line so that they don't dilute the node array.
+ *
+ * The snapshot does not track the source tree, it has to be rebuilt to
+ * pick up changes. Lookups return a pointer to the matching entry, or
+ * nullptr if there is none.
+ */
+template <typename IPADDRTYPE, typename T>
+class FrozenRadixTree {
+ public:
+  using Entry = FrozenRadixTreeEntry<IPADDRTYPE, T>;
+  using ConstIterator = typename std::vector<Entry>::const_iterator;
+
+  FrozenRadixTree() {}
+
+  // TREE is any RadixTree<IPADDRTYPE, T, ...>
+  template <typename TREE>
+  explicit FrozenRadixTree(const TREE& tree);
+
+  FrozenRadixTree(FrozenRadixTree&&) = default;
+  FrozenRadixTree& operator=(FrozenRadixTree&&) = default;
+  FrozenRadixTree(const FrozenRadixTree&) = delete;
+  FrozenRadixTree& operator=(const FrozenRadixTree&) = delete;
+
+  /*
+   * Longest prefix, no longer than masklen, covering ipaddr/masklen
+   */
+  const Entry* longestMatch(const IPADDRTYPE& ipaddr, uint8_t masklen) const {
+    return lookup(ipaddr, masklen, false /* exact */);
+  }
+  const Entry* exactMatch(const IPADDRTYPE& ipaddr, uint8_t masklen) const {
+    return lookup(ipaddr, masklen, true /* exact */);
+  }
+
+  // Entries are iterated in BFS order of their nodes
+  ConstIterator begin() const {
+    return entries_.begin();
+  }
+  ConstIterator end() const {
+    return entries_.end();
+  }
+
+  size_t size() const {
+    return entries_.size();
+  }
+  bool empty() const {
+    return entries_.empty();
+  }
+  // Number of nodes, including the non value nodes of the source tree
+  size_t nodeCount() const {
+    return nodes_.size();
+  }
+
+ private:
+  static constexpr uint32_t kNoIndex = std::numeric_limits<uint32_t>::max();
+
+  struct alignas(32) Node {
+    // Prefix bits, most significant bit first. V4 prefixes use the upper
+    // 32 bits of hi.
+    uint64_t hi;
+    uint64_t lo;
+    uint32_t children[2];
+    // Index in entries_, kNoIndex for non value nodes
+    uint32_t entry;
+    uint8_t masklen;
+  };
+  static_assert(sizeof(Node) == 32, "Two nodes should fit in a cache line");
+
+  struct Key {
+    uint64_t hi;
+    uint64_t lo;
+  };
+
+  static Key toKey(const folly::IPAddressV4& ip) {
+    return Key{static_cast<uint64_t>(ip.toLongHBO()) << 32, 0};
+  }
+  static Key toKey(const folly::IPAddressV6& ip) {
+    auto bytes = ip.bytes();
+    return Key{folly::Endian::big(folly::loadUnaligned<uint64_t>(bytes)),
+               folly::Endian::big(folly::loadUnaligned<uint64_t>(bytes + 8))};
+  }
+
+  // True if the first node.masklen bits of key and node match
+  static bool covers(const Node& node, const Key& key) {
+    uint8_t masklen = node.masklen;
+    uint64_t hiMask =
+        masklen == 0 ? 0 : ~0ULL << (64 - std::min<uint8_t>(masklen, 64));
+    uint64_t loMask = masklen <= 64 ? 0 : ~0ULL << (128 - masklen);
+    return (((key.hi ^ node.hi) & hiMask) | ((key.lo ^ node.lo) & loMask)) ==
+        0;
+  }
+
+  static uint32_t nthMSBit(const Key& key, uint8_t n) {
+    return n < 64 ? (key.hi >> (63 - n)) & 1 : (key.lo >> (127 - n)) & 1;
+  }
+
+  const Entry* lookup(const IPADDRTYPE& ipaddr, uint8_t masklen, bool exact)
+      const;
+
+  std::vector<Node> nodes_;
+  std::vector<Entry> entries_;
+};
+
+template <typename IPADDRTYPE, typename T>
+template <typename TREE>
+FrozenRadixTree<IPADDRTYPE, T>::FrozenRadixTree(const TREE& tree) {
+  using TreeNode = typename TREE::TreeNode;
+  // Nodes in BFS order. A node's children get their index (their position
+  // in this vector) when they are queued up, i.e. when the node itself is
+  // frozen.
+  std::vector<const TreeNode*> bfsOrder;
+  if (tree.root()) {
+    bfsOrder.push_back(tree.root());
+  }
+  entries_.reserve(tree.size());
+  for (size_t i = 0; i < bfsOrder.size(); ++i) {
+    const TreeNode* treeNode = bfsOrder[i];
+    auto key = toKey(treeNode->ipAddress());
+    Node node;
+    node.hi = key.hi;
+    node.lo = key.lo;
+    node.masklen = treeNode->masklen();
+    node.entry = kNoIndex;
+    if (treeNode->isValueNode()) {
+      node.entry = entries_.size();
+      entries_.push_back(Entry{
+          treeNode->ipAddress(),
+          static_cast<uint8_t>(treeNode->masklen()),
+          treeNode->value()});
+    }
+    const TreeNode* children[2] = {treeNode->left(), treeNode->right()};
+    for (auto c = 0; c < 2; ++c) {
+      node.children[c] = kNoIndex;
+      if (children[c]) {
+        node.children[c] = bfsOrder.size();
+        bfsOrder.push_back(children[c]);
+      }
+    }
+    nodes_.push_back(node);
+  }
+  CHECK_EQ(entries_.size(), tree.size());
+}
+
+template <typename IPADDRTYPE, typename T>
+const typename FrozenRadixTree<IPADDRTYPE, T>::Entry*
+FrozenRadixTree<IPADDRTYPE, T>::lookup(
+    const IPADDRTYPE& ipaddr,
+    uint8_t masklen,
+    bool exact) const {
+  DCHECK_LE(masklen, IPADDRTYPE::bitCount());
+  if (nodes_.empty()) {
+    return nullptr;
+  }
+  const auto key = toKey(ipaddr);
+  uint32_t lastEntrySeen = kNoIndex;
+  uint32_t index = 0;
+  while (index != kNoIndex) {
+    const auto& node = nodes_[index];
+    if (node.masklen > masklen || !covers(node, key)) {
+      break;
+    }
+    if (node.entry != kNoIndex) {
+      lastEntrySeen = node.entry;
+    }
+    if (node.masklen == masklen) {
+      // Can't get any more specific than this node
+      if (exact) {
+        return node.entry == kNoIndex ? nullptr : &entries_[node.entry];
+      }
+      break;
+    }
+    index = node.children[nthMSBit(key, node.masklen)];
+  }
+  return exact || lastEntrySeen == kNoIndex ? nullptr
+                                            : &entries_[lastEntrySeen];
+}
+
+} // namespace network
+} // namespace facebook
@@ -0,0 +1,608 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <glog/logging.h>
+
+namespace facebook {
+namespace fboss {
+
+/*
+ * PersistentMap is an ordered map, with (most of) the interface of
+ * boost::container::flat_map, whose copies share structure.
+ *
+ * It is an AVL tree of reference counted nodes. Copying a map only copies
+ * the pointer to its root. Modifying a map copies the nodes on the path to
+ * the modified node that are shared with other maps (path copying), so
+ * copy + modify costs O(log N) rather than the O(N) of a flat_map, and the
+ * untouched subtrees remain shared with the original map. Nodes that are
+ * not shared are modified in place, so building a map from scratch doesn't
+ * copy anything.
+ *
+ * Mutable iterators (iterators obtained from a non const map) un-share the
+ * nodes they visit, so that the values they point to can be assigned
+ * without affecting other maps. Iterate over a const map unless the values
+ * need to be modified: walking all of a copied map through mutable
+ * iterators copies all of its nodes.
+ *
+ * As with other containers, modifying a map invalidates its iterators. A
+ * map must not be copied and modified concurrently, but copies can be read
+ * and modified independently, and dropped on any thread. For that, a node
+ * is only modified in place after an acquire fence that orders the last
+ * reads of the copies which dropped it before the write (see makeUnique()).
+ *
+ * Nodes also remember whether they were published (see publish()), so that
+ * the entries of a modified copy that need publishing can be found without
+ * walking the whole map.
+ */
+template <typename K, typename V, typename Compare = std::less<K>>
+class PersistentMap {
+  struct Node;
+  using NodePtr = std::shared_ptr<Node>;
+
+ public:
+  using key_type = K;
+  using mapped_type = V;
+  using value_type = std::pair<K, V>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using key_compare = Compare;
+
+  template <bool Const>
+  class Iterator;
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  PersistentMap() {}
+  template <typename InputIt>
+  PersistentMap(InputIt first, InputIt last) {
+    insert(first, last);
+  }
+  PersistentMap(std::initializer_list<value_type> values)
+      : PersistentMap(values.begin(), values.end()) {}
+
+  PersistentMap(const PersistentMap&) = default;
+  PersistentMap& operator=(const PersistentMap&) = default;
+  PersistentMap(PersistentMap&& other) noexcept
+      : root_(std::move(other.root_)), size_(other.size_) {
+    other.size_ = 0;
+  }
+  PersistentMap& operator=(PersistentMap&& other) noexcept {
+    root_ = std::move(other.root_);
+    size_ = other.size_;
+    other.size_ = 0;
+    return *this;
+  }
+
+  size_type size() const {
+    return size_;
+  }
+  bool empty() const {
+    return size_ == 0;
+  }
+  void clear() {
+    root_.reset();
+    size_ = 0;
+  }
+
+  const_iterator begin() const {
+    const_iterator it(&root_);
+    it.pushLeftmost(root_.get());
+    return it;
+  }
+  const_iterator end() const {
+    return const_iterator(&root_);
+  }
+  iterator begin() {
+    makeUnique(root_);
+    iterator it(&root_);
+    it.pushLeftmost(root_.get());
+    return it;
+  }
+  // Nothing is un-shared until the iterator is decremented
+  iterator end() {
+    return iterator(&root_);
+  }
+  const_iterator cbegin() const {
+    return begin();
+  }
+  const_iterator cend() const {
+    return end();
+  }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+  reverse_iterator rbegin() {
+    return reverse_iterator(end());
+  }
+  reverse_iterator rend() {
+    return reverse_iterator(begin());
+  }
+
+  const_iterator find(const K& key) const {
+    auto it = lower_bound(key);
+    if (it != end() && !compare_(key, it->first)) {
+      return it;
+    }
+    return end();
+  }
+  iterator find(const K& key) {
+    // Don't copy anything unless the key is there
+    if (std::as_const(*this).find(key) == cend()) {
+      return end();
+    }
+    return lower_bound(key);
+  }
+  size_type count(const K& key) const {
+    return find(key) == end() ? 0 : 1;
+  }
+  const_iterator lower_bound(const K& key) const {
+    return lowerBound<const_iterator>(&root_, key);
+  }
+  iterator lower_bound(const K& key) {
+    makeUnique(root_);
+    return lowerBound<iterator>(&root_, key);
+  }
+
+  std::pair<iterator, bool> insert(const value_type& value) {
+    return insertImpl(value_type(value));
+  }
+  std::pair<iterator, bool> insert(value_type&& value) {
+    return insertImpl(std::move(value));
+  }
+  template <typename P>
+  std::pair<iterator, bool> insert(P&& value) {
+    return insertImpl(value_type(std::forward<P>(value)));
+  }
+  template <typename InputIt>
+  void insert(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+      insertImpl(value_type(*first));
+    }
+  }
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    return insertImpl(value_type(std::forward<Args>(args)...));
+  }
+  // The hint is ignored, lookups are O(log N) anyway
+  template <typename... Args>
+  iterator emplace_hint(const_iterator /*hint*/, Args&&... args) {
+    return emplace(std::forward<Args>(args)...).first;
+  }
+
+  size_type erase(const K& key) {
+    if (std::as_const(*this).find(key) == cend()) {
+      return 0;
+    }
+    eraseNode(root_, key);
+    --size_;
+    return 1;
+  }
+  // Returns an iterator to the element following the erased one
+  iterator erase(const_iterator pos) {
+    K key = pos->first;
+    erase(key);
+    return lower_bound(key);
+  }
+  iterator erase(iterator pos) {
+    return erase(const_iterator(pos));
+  }
+
+  /*
+   * If first and second point to the same node of two maps sharing
+   * structure, moves both past the nodes following it in the largest subtree
+   * the maps share, and returns true. Otherwise returns false without moving
+   * the iterators.
+   *
+   * Everything in a shared subtree is identical in both maps, so walking the
+   * differences between a map and a modified copy of it with skipShared()
+   * costs O(number of changes * log N) instead of O(N).
+   */
+  static bool skipShared(const_iterator& first, const_iterator& second) {
+    auto node = first.current();
+    if (!node || node != second.current()) {
+      return false;
+    }
+    // Shared nodes are shared with all their descendants, so the nodes the
+    // maps share form the bottom of both paths.
+    auto firstDepth = first.depth_;
+    auto secondDepth = second.depth_;
+    while (firstDepth > 1 && secondDepth > 1 &&
+           first.path_[firstDepth - 2] == second.path_[secondDepth - 2]) {
+      --firstDepth;
+      --secondDepth;
+    }
+    first.depth_ = firstDepth;
+    first.skipSubtree();
+    second.depth_ = secondDepth;
+    second.skipSubtree();
+    return true;
+  }
+
+  /*
+   * Calls fn on every entry added or modified since the map, or the map it
+   * was copied from, was last published, and marks them all published.
+   *
+   * Nodes are only ever modified after being un-shared, which also clears
+   * their published mark and that of all the nodes above them. The subtrees
+   * that are still marked therefore only hold published entries and are
+   * skipped, so publishing a modified copy of a published map costs
+   * O(number of changes * log N) instead of O(N). Entries reached through
+   * mutable iterators count as modified.
+   */
+  template <typename Fn>
+  void publish(Fn fn) {
+    publishNode(root_.get(), fn);
+  }
+
+  void swap(PersistentMap& other) noexcept {
+    root_.swap(other.root_);
+    std::swap(size_, other.size_);
+  }
+
+  bool operator==(const PersistentMap& other) const {
+    return root_ == other.root_ ||
+        (size_ == other.size_ && std::equal(begin(), end(), other.begin()));
+  }
+  bool operator!=(const PersistentMap& other) const {
+    return !(*this == other);
+  }
+
+  template <bool Const>
+  class Iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = PersistentMap::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference =
+        std::conditional_t<Const, const value_type&, value_type&>;
+    using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+
+    Iterator() {}
+    Iterator(const Iterator& other) {
+      copyFrom(other);
+    }
+    Iterator& operator=(const Iterator& other) {
+      copyFrom(other);
+      return *this;
+    }
+    // iterator converts to const_iterator
+    template <
+        bool OtherConst,
+        typename = std::enable_if_t<Const && !OtherConst>>
+    /* implicit */ Iterator(const Iterator<OtherConst>& other) {
+      copyFrom(other);
+    }
+
+    reference operator*() const {
+      DCHECK_GT(depth_, 0);
+      return path_[depth_ - 1]->value;
+    }
+    pointer operator->() const {
+      return &operator*();
+    }
+
+    Iterator& operator++() {
+      auto node = current();
+      DCHECK(node);
+      if (node->right) {
+        pushLeftmost(child(node, true /* right */));
+      } else {
+        skipSubtree();
+      }
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator tmp(*this);
+      ++*this;
+      return tmp;
+    }
+    Iterator& operator--() {
+      auto node = current();
+      if (!node) {
+        // end(), whose root mutable iterators un-share only now
+        if constexpr (!Const) {
+          makeUnique(*root_);
+        }
+        pushRightmost(root_->get());
+        return *this;
+      }
+      if (node->left) {
+        pushRightmost(child(node, false /* right */));
+        return *this;
+      }
+      // Go up until we leave a right subtree
+      while (--depth_ > 0) {
+        if (path_[depth_ - 1]->right.get() == node) {
+          break;
+        }
+        node = path_[depth_ - 1];
+      }
+      DCHECK_GT(depth_, 0) << "Decremented begin()";
+      return *this;
+    }
+    Iterator operator--(int) {
+      Iterator tmp(*this);
+      --*this;
+      return tmp;
+    }
+
+    template <bool OtherConst>
+    bool operator==(const Iterator<OtherConst>& other) const {
+      return current() == other.current();
+    }
+    template <bool OtherConst>
+    bool operator!=(const Iterator<OtherConst>& other) const {
+      return !operator==(other);
+    }
+
+   private:
+    friend class PersistentMap;
+    template <bool>
+    friend class Iterator;
+
+    // An AVL tree of height 64 would hold more than 2^44 nodes
+    static constexpr size_t kMaxDepth = 64;
+
+    // The map's root slot, so that end() need not un-share the root
+    using RootPtr = std::conditional_t<Const, const NodePtr*, NodePtr*>;
+
+    explicit Iterator(RootPtr root) : root_(root) {}
+
+    template <bool OtherConst>
+    void copyFrom(const Iterator<OtherConst>& other) {
+      root_ = other.root_;
+      depth_ = other.depth_;
+      std::copy_n(other.path_.begin(), depth_, path_.begin());
+    }
+
+    Node* current() const {
+      return depth_ > 0 ? path_[depth_ - 1] : nullptr;
+    }
+    void push(Node* node) {
+      DCHECK_LT(depth_, kMaxDepth);
+      path_[depth_++] = node;
+    }
+    // Child of node, which mutable iterators first un-share so that every
+    // node on their path belongs to this map only.
+    static Node* child(Node* node, bool right) {
+      NodePtr& slot = right ? node->right : node->left;
+      if (!Const) {
+        makeUnique(slot);
+      }
+      return slot.get();
+    }
+    // Move to the first node after the subtree of the current node
+    void skipSubtree() {
+      auto node = current();
+      // Go up until we leave a left subtree
+      while (--depth_ > 0) {
+        if (path_[depth_ - 1]->left.get() == node) {
+          break;
+        }
+        node = path_[depth_ - 1];
+      }
+    }
+    void pushLeftmost(Node* node) {
+      while (node) {
+        push(node);
+        node = child(node, false /* right */);
+      }
+    }
+    void pushRightmost(Node* node) {
+      while (node) {
+        push(node);
+        node = child(node, true /* right */);
+      }
+    }
+
+    RootPtr root_{nullptr};
+    size_t depth_{0};
+    std::array<Node*, kMaxDepth> path_;
+  };
+
+ private:
+  struct Node {
+    explicit Node(value_type&& value) : value(std::move(value)) {}
+    // Copies are made to be modified, so they start out unpublished
+    Node(const Node& other)
+        : value(other.value),
+          left(other.left),
+          right(other.right),
+          height(other.height) {}
+
+    value_type value;
+    NodePtr left;
+    NodePtr right;
+    int height{1};
+    // Set once the node and all of its descendants are published. Copies of
+    // a map sharing an unpublished node may publish it at the same time.
+    std::atomic<bool> published{false};
+  };
+
+  const K& keyOf(const Node* node) const {
+    return node->value.first;
+  }
+
+  static void makeUnique(NodePtr& node) {
+    if (!node) {
+      return;
+    }
+    if (node.use_count() > 1) {
+      node = std::make_shared<Node>(*node);
+    } else {
+      // use_count() is a relaxed load. Another thread may have just dropped
+      // the other reference to the node after reading it, and the release
+      // of its decrement only orders that read before our write once we
+      // acquire.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      // About to be modified in place
+      node->published.store(false, std::memory_order_relaxed);
+    }
+  }
+
+  template <typename Fn>
+  static void publishNode(Node* node, Fn& fn) {
+    if (!node || node->published.load(std::memory_order_relaxed)) {
+      return;
+    }
+    publishNode(node->left.get(), fn);
+    fn(std::as_const(node->value));
+    publishNode(node->right.get(), fn);
+    node->published.store(true, std::memory_order_relaxed);
+  }
+
+  // Mutable iterators need root to be unique
+  template <typename It>
+  It lowerBound(typename It::RootPtr root, const K& key) const {
+    It it(root);
+    size_t depth = 0;
+    auto node = root->get();
+    while (node) {
+      it.push(node);
+      if (!compare_(keyOf(node), key)) {
+        depth = it.depth_;
+        node = It::child(node, false /* right */);
+      } else {
+        node = It::child(node, true /* right */);
+      }
+    }
+    it.depth_ = depth;
+    return it;
+  }
+
+  std::pair<iterator, bool> insertImpl(value_type&& value) {
+    if (std::as_const(*this).find(value.first) != cend()) {
+      return std::make_pair(find(value.first), false);
+    }
+    K key = value.first;
+    insertNode(root_, std::move(value));
+    ++size_;
+    return std::make_pair(lower_bound(key), true);
+  }
+
+  static int height(const NodePtr& node) {
+    return node ? node->height : 0;
+  }
+  static void updateHeight(Node* node) {
+    node->height = 1 + std::max(height(node->left), height(node->right));
+  }
+
+  // slot must be unique
+  static void rotateLeft(NodePtr& slot) {
+    NodePtr pivot = std::move(slot->right);
+    makeUnique(pivot);
+    slot->right = std::move(pivot->left);
+    updateHeight(slot.get());
+    pivot->left = std::move(slot);
+    slot = std::move(pivot);
+    updateHeight(slot.get());
+  }
+  static void rotateRight(NodePtr& slot) {
+    NodePtr pivot = std::move(slot->left);
+    makeUnique(pivot);
+    slot->left = std::move(pivot->right);
+    updateHeight(slot.get());
+    pivot->right = std::move(slot);
+    slot = std::move(pivot);
+    updateHeight(slot.get());
+  }
+  // slot must be unique
+  static void rebalance(NodePtr& slot) {
+    auto balance = height(slot->left) - height(slot->right);
+    if (balance > 1) {
+      if (height(slot->left->left) < height(slot->left->right)) {
+        makeUnique(slot->left);
+        rotateLeft(slot->left);
+      }
+      rotateRight(slot);
+    } else if (balance < -1) {
+      if (height(slot->right->right) < height(slot->right->left)) {
+        makeUnique(slot->right);
+        rotateRight(slot->right);
+      }
+      rotateLeft(slot);
+    } else {
+      updateHeight(slot.get());
+    }
+  }
+
+  // value's key must not be in the tree
+  void insertNode(NodePtr& slot, value_type&& value) {
+    if (!slot) {
+      slot = std::make_shared<Node>(std::move(value));
+      return;
+    }
+    makeUnique(slot);
+    if (compare_(value.first, keyOf(slot.get()))) {
+      insertNode(slot->left, std::move(value));
+    } else {
+      insertNode(slot->right, std::move(value));
+    }
+    rebalance(slot);
+  }
+
+  // key must be in the tree
+  void eraseNode(NodePtr& slot, const K& key) {
+    DCHECK(slot);
+    makeUnique(slot);
+    if (compare_(key, keyOf(slot.get()))) {
+      eraseNode(slot->left, key);
+    } else if (compare_(keyOf(slot.get()), key)) {
+      eraseNode(slot->right, key);
+    } else if (!slot->left) {
+      slot = NodePtr(slot->right);
+      return;
+    } else if (!slot->right) {
+      slot = NodePtr(slot->left);
+      return;
+    } else {
+      slot->value = removeMin(slot->right);
+    }
+    rebalance(slot);
+  }
+
+  static value_type removeMin(NodePtr& slot) {
+    makeUnique(slot);
+    if (!slot->left) {
+      value_type value = std::move(slot->value);
+      slot = NodePtr(slot->right);
+      return value;
+    }
+    auto value = removeMin(slot->left);
+    rebalance(slot);
+    return value;
+  }
+
+  NodePtr root_;
+  size_type size_{0};
+  Compare compare_;
+};
+
+} // namespace fboss
+} // namespace facebook
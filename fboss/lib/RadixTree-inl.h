@@ -35,9 +35,13 @@ RadixTreeNode<IPADDRTYPE, T>::searchDirection(
   return TreeDirection::PARENT;
 }
 
-template <typename IPADDRTYPE, typename T, typename TreeTraits>
-const typename RadixTree<IPADDRTYPE, T, TreeTraits>::TreeNode*
-RadixTree<IPADDRTYPE, T, TreeTraits>::longestMatchImpl(
+template <
+    typename IPADDRTYPE,
+    typename T,
+    typename TreeTraits,
+    typename NodeAllocator>
+const typename RadixTree<IPADDRTYPE, T, TreeTraits, NodeAllocator>::TreeNode*
+RadixTree<IPADDRTYPE, T, TreeTraits, NodeAllocator>::longestMatchImpl(
     const IPADDRTYPE& ipaddr,
     uint8_t masklen,
     bool& foundExact,
@@ -52,7 +56,7 @@ RadixTree<IPADDRTYPE, T, TreeTraits>::longestMatchImpl(
   // have a parent pointer
   TreeNode* parent = nullptr;
   TreeNode* lastValueNodeSeen = nullptr;
-  auto curNode = root_.get();
+  auto curNode = root_;
   auto done = false;
   while (curNode && !done) {
     auto searchDirection = curNode->searchDirection(toMatch, masklen);
@@ -97,8 +101,13 @@ RadixTree<IPADDRTYPE, T, TreeTraits>::longestMatchImpl(
   return includeNonValueNodes ? curNode : lastValueNodeSeen;
 }
 
-template <typename IPADDRTYPE, typename T, typename TreeTraits>
-inline void RadixTree<IPADDRTYPE, T, TreeTraits>::trailAppend(
+template <
+    typename IPADDRTYPE,
+    typename T,
+    typename TreeTraits,
+    typename NodeAllocator>
+inline void
+RadixTree<IPADDRTYPE, T, TreeTraits, NodeAllocator>::trailAppend(
     VecConstIterators* trail,
     bool includeNonValueNodes,
     const TreeNode* node) const {
@@ -109,10 +118,16 @@ inline void RadixTree<IPADDRTYPE, T, TreeTraits>::trailAppend(
   }
 }
 
-template <typename IPADDRTYPE, typename T, typename TreeTraits>
+template <
+    typename IPADDRTYPE,
+    typename T,
+    typename TreeTraits,
+    typename NodeAllocator>
 template <typename VALUE>
-std::pair<typename RadixTree<IPADDRTYPE, T, TreeTraits>::Iterator, bool>
-RadixTree<IPADDRTYPE, T, TreeTraits>::insert(
+std::pair<
+    typename RadixTree<IPADDRTYPE, T, TreeTraits, NodeAllocator>::Iterator,
+    bool>
+RadixTree<IPADDRTYPE, T, TreeTraits, NodeAllocator>::insert(
     const IPADDRTYPE& ipaddr,
     uint8_t mask,
     VALUE&& value) {
@@ -134,44 +149,42 @@ RadixTree<IPADDRTYPE, T, TreeTraits>::insert(
     }
   }
   auto newNode = makeNode(toAdd, mask, std::forward<VALUE>(value));
-  // Cache new node pointer since the unique_ptr maybe moved
-  auto newNodeRaw = newNode.get();
   if (!bestMatch) {
     // No match found
     if (!root_) {
       // Empty tree, make this the root
-      makeRoot(std::move(newNode));
+      makeRoot(newNode);
     } else {
       // The root exists but this ipaddr, mask failed to
       // match even the root->ipaddr/mask. We need a less
       // specific root.
       auto prefix = IPADDRTYPE::longestCommonPrefix(
           {root_->ipAddress(), root_->masklen()}, {toAdd, mask});
-      std::unique_ptr<TreeNode> newRoot = nullptr;
+      TreeNode* newRoot = nullptr;
       if (prefix.first == toAdd && prefix.second == mask) {
         // To be added node is the new root
-        newRoot = std::move(newNode);
+        newRoot = newNode;
       } else {
         // Add new root as a non value internal node
-        newRoot = makeNode(prefix.first, prefix.second);
+        newRoot = makeInternalNode(prefix.first, prefix.second, newNode);
       }
-      auto oldRootDirection = newRoot->searchDirection(root_.get());
+      auto oldRootDirection = newRoot->searchDirection(root_);
       CHECK(
           oldRootDirection == TreeDirection::LEFT ||
           oldRootDirection == TreeDirection::RIGHT);
       if (oldRootDirection == TreeDirection::LEFT) {
-        newRoot->resetLeft(std::move(root_));
-        if (newNode) {
-          // new node was not moved to be the new root
-          newRoot->resetRight(std::move(newNode));
+        newRoot->resetLeft(root_);
+        if (newRoot != newNode) {
+          // new node was not made the new root
+          newRoot->resetRight(newNode);
         }
       } else {
-        newRoot->resetRight(std::move(root_));
-        if (newNode) {
-          newRoot->resetLeft(std::move(newNode));
+        newRoot->resetRight(root_);
+        if (newRoot != newNode) {
+          newRoot->resetLeft(newNode);
         }
       }
-      makeRoot(std::move(newRoot));
+      makeRoot(newRoot);
     }
   } else {
     auto toAddDirection = bestMatch->searchDirection(toAdd, mask);
@@ -181,12 +194,12 @@ RadixTree<IPADDRTYPE, T, TreeTraits>::insert(
         toAddDirection == TreeDirection::RIGHT);
     if (toAddDirection == TreeDirection::LEFT) {
       if (!bestMatch->left()) {
-        bestMatch->resetLeft(std::move(newNode));
+        bestMatch->resetLeft(newNode);
         done = true;
       }
     } else {
       if (!bestMatch->right()) {
-        bestMatch->resetRight(std::move(newNode));
+        bestMatch->resetRight(newNode);
         done = true;
       }
     }
@@ -216,50 +229,48 @@ RadixTree<IPADDRTYPE, T, TreeTraits>::insert(
       if (prefix.first != toAdd || prefix.second != mask) {
         // We need to insert a non value internal node as a parent of
         // bestMatchChild and new node.
-        auto internalNode = makeNode(prefix.first, prefix.second);
-        auto internalNodeRaw = internalNode.get();
-        std::unique_ptr<TreeNode> oldBestMatchChild = nullptr;
+        auto internalNode =
+            makeInternalNode(prefix.first, prefix.second, newNode);
+        TreeNode* oldBestMatchChild = nullptr;
         if (toAddDirection == TreeDirection::LEFT) {
-          oldBestMatchChild = bestMatch->resetLeft(std::move(internalNode));
+          oldBestMatchChild = bestMatch->resetLeft(internalNode);
         } else {
-          oldBestMatchChild = bestMatch->resetRight(std::move(internalNode));
+          oldBestMatchChild = bestMatch->resetRight(internalNode);
         }
-        auto newNodeDirection = internalNodeRaw->searchDirection(newNode.get());
+        auto newNodeDirection = internalNode->searchDirection(newNode);
         CHECK(
             newNodeDirection == TreeDirection::LEFT ||
             newNodeDirection == TreeDirection::RIGHT);
         if (newNodeDirection == TreeDirection::LEFT) {
-          internalNodeRaw->resetLeft(std::move(newNode));
-          internalNodeRaw->resetRight(std::move(oldBestMatchChild));
+          internalNode->resetLeft(newNode);
+          internalNode->resetRight(oldBestMatchChild);
         } else {
-          internalNodeRaw->resetRight(std::move(newNode));
-          internalNodeRaw->resetLeft(std::move(oldBestMatchChild));
+          internalNode->resetRight(newNode);
+          internalNode->resetLeft(oldBestMatchChild);
         }
-        CHECK(internalNode == nullptr);
       } else {
         // New node needs to be inserted  b/w bestMatch and bestMatchChild
-        std::unique_ptr<TreeNode> oldBestMatchChild = nullptr;
+        TreeNode* oldBestMatchChild = nullptr;
         if (toAddDirection == TreeDirection::LEFT) {
-          oldBestMatchChild = bestMatch->resetLeft(std::move(newNode));
+          oldBestMatchChild = bestMatch->resetLeft(newNode);
         } else {
-          oldBestMatchChild = bestMatch->resetRight(std::move(newNode));
+          oldBestMatchChild = bestMatch->resetRight(newNode);
         }
         auto bestMatchChildDirection =
-            newNodeRaw->searchDirection(oldBestMatchChild.get());
+            newNode->searchDirection(oldBestMatchChild);
         DCHECK(
             bestMatchChildDirection == TreeDirection::LEFT ||
             bestMatchChildDirection == TreeDirection::RIGHT);
         if (bestMatchChildDirection == TreeDirection::LEFT) {
-          newNodeRaw->resetLeft(std::move(oldBestMatchChild));
+          newNode->resetLeft(oldBestMatchChild);
         } else {
-          newNodeRaw->resetRight(std::move(oldBestMatchChild));
+          newNode->resetRight(oldBestMatchChild);
         }
       }
     }
   }
-  CHECK(newNode == nullptr);
   ++size_;
-  return std::make_pair(traits_.makeItr(newNodeRaw), true);
+  return std::make_pair(traits_.makeItr(newNode), true);
 }
 
 /*
@@ -273,8 +284,13 @@ RadixTree<IPADDRTYPE, T, TreeTraits>::insert(
  * as well. Why this is true is explained below for each of the
  * different cases of erase.
  */
-template <typename IPADDRTYPE, typename T, typename TreeTraits>
-bool RadixTree<IPADDRTYPE, T, TreeTraits>::erase(TreeNode* toDelete) {
+template <
+    typename IPADDRTYPE,
+    typename T,
+    typename TreeTraits,
+    typename NodeAllocator>
+bool RadixTree<IPADDRTYPE, T, TreeTraits, NodeAllocator>::erase(
+    TreeNode* toDelete) {
   if (!toDelete) {
     return false;
   }
@@ -298,7 +314,6 @@ bool RadixTree<IPADDRTYPE, T, TreeTraits>::erase(TreeNode* toDelete) {
     // toDelete has just one child, let the child's grandparent
     // adopt it since toDelete is about to got away.
     if (parent) {
-      // Note - toDelete gets freed here.
       if (parent->left() == toDelete) {
         parent->resetLeft(
             left ? toDelete->resetLeft(nullptr)
@@ -309,11 +324,13 @@ bool RadixTree<IPADDRTYPE, T, TreeTraits>::erase(TreeNode* toDelete) {
                  : toDelete->resetRight(nullptr));
       }
     } else {
-      CHECK(root_.get() == toDelete);
-      // Update root, toDelete (old root) gets deleted as a result
+      CHECK(root_ == toDelete);
+      // Update root
       makeRoot(
           left ? toDelete->resetLeft(nullptr) : toDelete->resetRight(nullptr));
     }
+    // toDelete is now unlinked from the tree, free it
+    freeNode(toDelete);
     // We just made toDelete's parent the parent of toDelete's only
     // child. There are 2 possibilities with regard to toDelete's parent
     // a) The parent is a value node - In this case there is no bearing
@@ -327,9 +344,10 @@ bool RadixTree<IPADDRTYPE, T, TreeTraits>::erase(TreeNode* toDelete) {
   } else {
     // toDelete has no children.
     if (parent) {
-      // Free toDelete
+      // Unlink and free toDelete
       parent->left() == toDelete ? parent->resetLeft(nullptr)
                                  : parent->resetRight(nullptr);
+      freeNode(toDelete);
       if (parent->isNonValueNode()) {
         // toDelete's parent is a non value node. Since we removed
         // toDelete, toDelete's parent needs to be deleted as well
@@ -342,10 +360,11 @@ bool RadixTree<IPADDRTYPE, T, TreeTraits>::erase(TreeNode* toDelete) {
                                               : parent->resetRight(nullptr);
         CHECK(toDeleteSibling);
         if (grandParent) {
-          // Free toDelete's parent
+          // Unlink and free toDelete's parent
           grandParent->left() == parent
-              ? grandParent->resetLeft(std::move(toDeleteSibling))
-              : grandParent->resetRight(std::move(toDeleteSibling));
+              ? grandParent->resetLeft(toDeleteSibling)
+              : grandParent->resetRight(toDeleteSibling);
+          freeNode(parent);
           // Here we replaced one of grandparent's children with
           // another and removed parent, toDelete nodes. There are
           // 2 possibilities with regards to grand parent
@@ -364,9 +383,10 @@ bool RadixTree<IPADDRTYPE, T, TreeTraits>::erase(TreeNode* toDelete) {
           // 2 children), each subtree of such a tree is also valid.
           // Since the tree under toDeleteSibling is one such tree,
           // our post condition is held.
-          CHECK(root_.get() == parent);
+          CHECK(root_ == parent);
           CHECK(parent->isLeaf()); // Both children should be set to null
-          makeRoot(std::move(toDeleteSibling));
+          makeRoot(toDeleteSibling);
+          freeNode(parent);
         }
       } else {
         // toDelete's parent is a value node.
@@ -378,17 +398,22 @@ bool RadixTree<IPADDRTYPE, T, TreeTraits>::erase(TreeNode* toDelete) {
     } else {
       // To be deleted node has no parent and no children.
       // Its thus the root (and only node) in the tree.
-      CHECK_EQ(root_.get(), toDelete);
+      CHECK_EQ(root_, toDelete);
       // Empty tree, post condition trivially held.
-      root_.reset(nullptr);
+      root_ = nullptr;
+      freeNode(toDelete);
     }
   }
   --size_;
   return true;
 }
 
-template <typename IPADDRTYPE, typename T, typename TreeTraits>
-bool RadixTree<IPADDRTYPE, T, TreeTraits>::radixSubTreesEqual(
+template <
+    typename IPADDRTYPE,
+    typename T,
+    typename TreeTraits,
+    typename NodeAllocator>
+bool RadixTree<IPADDRTYPE, T, TreeTraits, NodeAllocator>::radixSubTreesEqual(
     const TreeNode* nodeA,
     const TreeNode* nodeB) {
   if (nodeA && nodeB) {
@@ -402,25 +427,30 @@ bool RadixTree<IPADDRTYPE, T, TreeTraits>::radixSubTreesEqual(
   return !nodeA && !nodeB;
 }
 
-template <typename IPADDRTYPE, typename T, typename TreeTraits>
-std::unique_ptr<typename RadixTree<IPADDRTYPE, T, TreeTraits>::TreeNode>
-RadixTree<IPADDRTYPE, T, TreeTraits>::cloneSubTree(const TreeNode* node) {
+template <
+    typename IPADDRTYPE,
+    typename T,
+    typename TreeTraits,
+    typename NodeAllocator>
+typename RadixTree<IPADDRTYPE, T, TreeTraits, NodeAllocator>::TreeNode*
+RadixTree<IPADDRTYPE, T, TreeTraits, NodeAllocator>::cloneSubTree(
+    const TreeNode* node) {
   if (!node) {
     return nullptr;
   }
-  std::unique_ptr<TreeNode> copy;
+  TreeNode* copy = nullptr;
   if (node->isValueNode()) {
-    copy = std::make_unique<TreeNode>(
-        node->ipAddress(),
-        node->masklen(),
-        node->value(),
-        node->nodeDeleteCallback());
+    copy = makeNode(node->ipAddress(), node->masklen(), node->value());
   } else {
-    copy = std::make_unique<TreeNode>(
-        node->ipAddress(), node->masklen(), node->nodeDeleteCallback());
+    copy = makeNode(node->ipAddress(), node->masklen());
+  }
+  try {
+    copy->resetLeft(cloneSubTree(node->left()));
+    copy->resetRight(cloneSubTree(node->right()));
+  } catch (...) {
+    freeSubTree(copy);
+    throw;
   }
-  copy->resetLeft(cloneSubTree(node->left()));
-  copy->resetRight(cloneSubTree(node->right()));
   return copy;
 }
 
@@ -8,7 +8,9 @@
 #include <exception>
 #include <functional>
 #include <memory>
+#include <new>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -29,36 +31,27 @@ namespace network {
  * ones created by the radix tree implementation, which will
  * hold no values. All non value nodes will have 2 children,
  * this invariant must be maintained at all times.
+ *
+ * Child links are intrusive (raw) pointers. Nodes do not own their
+ * children, the RadixTree allocates and frees all of its nodes through
+ * its NodeAllocator and runs its (tree level) delete callback on them.
  */
 template <typename IPADDRTYPE, typename T>
 class RadixTreeNode {
  public:
-  // Optional function parameter to call from destructor
+  // Optional function to call on a node before it is freed by its tree
   typedef std::function<void(const RadixTreeNode<IPADDRTYPE, T>&)>
       NodeDeleteCallback;
 
-  RadixTreeNode(
-      const IPADDRTYPE& ipAddr,
-      uint8_t mlen,
-      NodeDeleteCallback deleteCallback)
-      : ipAddress_(ipAddr), masklen_(mlen), deleteCallback_(deleteCallback) {}
+  RadixTreeNode(const IPADDRTYPE& ipAddr, uint8_t mlen)
+      : ipAddress_(ipAddr), masklen_(mlen) {}
 
   template <typename VALUE>
-  RadixTreeNode(
-      const IPADDRTYPE& ipAddr,
-      uint8_t mlen,
-      VALUE&& val,
-      NodeDeleteCallback deleteCallback)
-      : ipAddress_(ipAddr),
-        masklen_(mlen),
-        value_(std::forward<VALUE>(val)),
-        deleteCallback_(deleteCallback) {}
-
-  ~RadixTreeNode() {
-    if (deleteCallback_) {
-      deleteCallback_(*this);
-    }
-  }
+  RadixTreeNode(const IPADDRTYPE& ipAddr, uint8_t mlen, VALUE&& val)
+      : ipAddress_(ipAddr), masklen_(mlen), value_(std::forward<VALUE>(val)) {}
+
+  RadixTreeNode(const RadixTreeNode&) = delete;
+  RadixTreeNode& operator=(const RadixTreeNode&) = delete;
 
   enum class TreeDirection { LEFT, RIGHT, PARENT, THIS_NODE };
 
@@ -75,16 +68,16 @@ class RadixTreeNode {
     return masklen_;
   }
   const RadixTreeNode* left() const {
-    return left_.get();
+    return left_;
   }
   RadixTreeNode* left() {
-    return left_.get();
+    return left_;
   }
   const RadixTreeNode* right() const {
-    return right_.get();
+    return right_;
   }
   RadixTreeNode* right() {
-    return right_.get();
+    return right_;
   }
   RadixTreeNode* parent() {
     return parent_;
@@ -101,9 +94,6 @@ class RadixTreeNode {
   T& value() {
     return value_.value();
   }
-  NodeDeleteCallback nodeDeleteCallback() const {
-    return deleteCallback_;
-  }
   std::string str(bool printValue = true) const {
     auto nodeStr = folly::to<std::string>(ipAddress_.str(), "/", masklen_);
     if (printValue) {
@@ -130,20 +120,23 @@ class RadixTreeNode {
         (!isValueNode() || this->value() == r.value());
   }
 
-  std::unique_ptr<RadixTreeNode> resetLeft(
-      std::unique_ptr<RadixTreeNode> newLeft) {
-    auto old = std::move(left_);
-    left_ = std::move(newLeft);
+  /*
+   * Replace the left (right) child, returning the previous one. The
+   * returned node is unlinked from this node but is not freed, that
+   * is up to the caller (i.e. the tree owning the node).
+   */
+  RadixTreeNode* resetLeft(RadixTreeNode* newLeft) {
+    auto old = left_;
+    left_ = newLeft;
     if (left_) {
       left_->setParent(this);
     }
     return old;
   }
 
-  std::unique_ptr<RadixTreeNode> resetRight(
-      std::unique_ptr<RadixTreeNode> newRight) {
-    auto old = std::move(right_);
-    right_ = std::move(newRight);
+  RadixTreeNode* resetRight(RadixTreeNode* newRight) {
+    auto old = right_;
+    right_ = newRight;
     if (right_) {
       right_->setParent(this);
     }
@@ -167,10 +160,95 @@ class RadixTreeNode {
   IPADDRTYPE ipAddress_;
   uint32_t masklen_{0}; // Number of bits to match.
   std::optional<T> value_;
-  std::unique_ptr<RadixTreeNode> left_{nullptr};
-  std::unique_ptr<RadixTreeNode> right_{nullptr};
+  RadixTreeNode* left_{nullptr};
+  RadixTreeNode* right_{nullptr};
   RadixTreeNode* parent_{nullptr};
-  NodeDeleteCallback deleteCallback_;
+};
+
+/*
+ * Default node allocator for RadixTree, every node is a separate
+ * heap allocation.
+ */
+template <typename TREENODE>
+class RadixTreeHeapNodeAllocator {
+ public:
+  void* allocate() {
+    return ::operator new(sizeof(TREENODE));
+  }
+  void deallocate(void* node) {
+    ::operator delete(node);
+  }
+};
+
+/*
+ * Pooled node allocator for RadixTree. Nodes are carved out of slabs of
+ * kNodesPerSlab nodes and freed nodes are kept on an intrusive free list
+ * for reuse. This saves the per allocation malloc overhead and keeps nodes
+ * of a tree close to each other in memory. Slabs are only released when
+ * the pool (i.e. the tree owning it) is destroyed.
+ */
+template <typename TREENODE, size_t kNodesPerSlab = 256>
+class RadixTreeNodePool {
+ public:
+  RadixTreeNodePool() {}
+  RadixTreeNodePool(RadixTreeNodePool&& r) noexcept {
+    *this = std::move(r);
+  }
+  RadixTreeNodePool& operator=(RadixTreeNodePool&& r) noexcept {
+    // All nodes allocated from this pool must have been freed by now
+    DCHECK_EQ(nodesInUse_, 0);
+    slabs_ = std::move(r.slabs_);
+    freeList_ = std::exchange(r.freeList_, nullptr);
+    nodesInUse_ = std::exchange(r.nodesInUse_, 0);
+    r.slabs_.clear();
+    return *this;
+  }
+  RadixTreeNodePool(const RadixTreeNodePool&) = delete;
+  RadixTreeNodePool& operator=(const RadixTreeNodePool&) = delete;
+
+  void* allocate() {
+    if (!freeList_) {
+      addSlab();
+    }
+    auto slot = freeList_;
+    freeList_ = slot->next;
+    ++nodesInUse_;
+    return slot;
+  }
+  void deallocate(void* node) {
+    auto slot = static_cast<Slot*>(node);
+    slot->next = freeList_;
+    freeList_ = slot;
+    --nodesInUse_;
+  }
+
+  size_t nodesInUse() const {
+    return nodesInUse_;
+  }
+  // Bytes held by the pool, whether handed out or on the free list
+  size_t bytesReserved() const {
+    return slabs_.size() * kNodesPerSlab * sizeof(Slot);
+  }
+
+ private:
+  union Slot {
+    Slot* next;
+    typename std::aligned_storage<sizeof(TREENODE), alignof(TREENODE)>::type
+        storage;
+  };
+
+  void addSlab() {
+    slabs_.push_back(std::make_unique<Slot[]>(kNodesPerSlab));
+    auto slab = slabs_.back().get();
+    for (size_t i = 0; i < kNodesPerSlab; ++i) {
+      slab[i].next = i + 1 < kNodesPerSlab ? &slab[i + 1] : freeList_;
+    }
+    freeList_ = slab;
+  }
+
+  std::vector<std::unique_ptr<Slot[]>> slabs_;
+  Slot* freeList_{nullptr};
+  size_t nodesInUse_{0};
 };
 
 /*
@@ -399,10 +477,18 @@ struct RadixTreeTraits {
   }
 };
 
+/*
+ * NodeAllocator controls where the nodes of the tree live. It must
+ * provide void* allocate() and void deallocate(void*) for blocks of
+ * sizeof(TreeNode) bytes. See RadixTreeHeapNodeAllocator (default)
+ * and RadixTreeNodePool.
+ */
 template <
     typename IPADDRTYPE,
     typename T,
-    typename TreeTraits = RadixTreeTraits<IPADDRTYPE, T>>
+    typename TreeTraits = RadixTreeTraits<IPADDRTYPE, T>,
+    typename NodeAllocator =
+        RadixTreeHeapNodeAllocator<RadixTreeNode<IPADDRTYPE, T>>>
 class RadixTree {
  public:
   typedef RadixTreeNode<IPADDRTYPE, T> TreeNode;
@@ -417,17 +503,21 @@ class RadixTree {
       const TreeTraits& treeTraits = TreeTraits())
       : nodeDeleteCallback_(nodeDelCallback), traits_(treeTraits) {}
 
+  ~RadixTree() {
+    clear();
+  }
+
   RadixTree(const RadixTree& r) = delete;
   RadixTree& operator=(const RadixTree& r) = delete;
 
   Iterator begin() {
-    return traits_.makeItr(root_.get());
+    return traits_.makeItr(root_);
   }
   Iterator end() {
     return traits_.makeItr(nullptr);
   }
   ConstIterator begin() const {
-    return traits_.makeCItr(root_.get());
+    return traits_.makeCItr(root_);
   }
   ConstIterator end() const {
     return traits_.makeCItr(nullptr);
@@ -435,7 +525,8 @@ class RadixTree {
 
   // Free all nodes and clear the tree.
   void clear() {
-    root_.reset(nullptr);
+    freeSubTree(root_);
+    root_ = nullptr;
     size_ = 0;
   }
   RadixTree(RadixTree&& r) noexcept
@@ -445,9 +536,12 @@ class RadixTree {
   // Move radix tree onto this
   RadixTree& operator=(RadixTree&& r) noexcept {
     // Don't copy the traits and delete callback, use
-    // ones with which this Radix tree was created
+    // ones with which this Radix tree was created.
+    // The nodes move along with the allocator they came from.
+    clear();
+    allocator_ = std::move(r.allocator_);
     size_ = r.size_;
-    makeRoot(std::move(r.root_));
+    makeRoot(std::exchange(r.root_, nullptr));
     r.size_ = 0;
     return *this;
   }
@@ -460,7 +554,7 @@ class RadixTree {
         "clone template type must be the same as Radix tree value type");
     RadixTree copy(nodeDeleteCallback_, traits_);
     copy.size_ = size_;
-    copy.root_ = cloneSubTree(root_.get());
+    copy.root_ = copy.cloneSubTree(root_);
     return copy;
   }
   /*
@@ -604,10 +698,10 @@ class RadixTree {
     return size_;
   }
   const TreeNode* root() const {
-    return root_.get();
+    return root_;
   }
   TreeNode* root() {
-    return root_.get();
+    return root_;
   }
   NodeDeleteCallback nodeDeleteCallback() const {
     return nodeDeleteCallback_;
@@ -615,9 +709,12 @@ class RadixTree {
   const TreeTraits& traits() const {
     return traits_;
   }
+  const NodeAllocator& allocator() const {
+    return allocator_;
+  }
 
  private:
-  static std::unique_ptr<TreeNode> cloneSubTree(const TreeNode* node);
+  TreeNode* cloneSubTree(const TreeNode* node);
   // Worker function to do the actual longest match lookup.
   const TreeNode* longestMatchImpl(
       const IPADDRTYPE& ipaddr,
@@ -638,23 +735,60 @@ class RadixTree {
             ipaddr, masklen, foundExact, includeNonValueNodes, trail));
   }
 
-  std::unique_ptr<TreeNode> makeNode(const IPADDRTYPE& ip, uint8_t masklen) {
-    return std::make_unique<TreeNode>(ip, masklen, nodeDeleteCallback_);
+  template <typename... Args>
+  TreeNode* makeNode(Args&&... args) {
+    auto mem = allocator_.allocate();
+    try {
+      return new (mem) TreeNode(std::forward<Args>(args)...);
+    } catch (...) {
+      allocator_.deallocate(mem);
+      throw;
+    }
   }
 
-  template <typename VALUE>
-  std::unique_ptr<TreeNode>
-  makeNode(const IPADDRTYPE& ip, uint8_t masklen, VALUE&& value) {
-    return std::make_unique<TreeNode>(
-        ip, masklen, std::forward<VALUE>(value), nodeDeleteCallback_);
+  /*
+   * Make a non value node for insert(). Frees the (not yet linked) node
+   * being inserted should the allocation fail.
+   */
+  TreeNode* makeInternalNode(
+      const IPADDRTYPE& ip,
+      uint8_t masklen,
+      TreeNode* nodeBeingInserted) {
+    try {
+      return makeNode(ip, masklen);
+    } catch (...) {
+      freeNode(nodeBeingInserted);
+      throw;
+    }
+  }
+
+  // Free a single node, its children (if any) must have been unlinked
+  void freeNode(TreeNode* node) {
+    if (nodeDeleteCallback_) {
+      nodeDeleteCallback_(*node);
+    }
+    node->~TreeNode();
+    allocator_.deallocate(node);
+  }
+
+  void freeSubTree(TreeNode* node) {
+    if (!node) {
+      return;
+    }
+    auto left = node->resetLeft(nullptr);
+    auto right = node->resetRight(nullptr);
+    // Parent goes first, same as when nodes owned their children
+    freeNode(node);
+    freeSubTree(left);
+    freeSubTree(right);
   }
 
-  void makeRoot(std::unique_ptr<TreeNode> newRoot) {
-    CHECK(root_ != newRoot || root_ == nullptr);
+  // Make newRoot the root, the caller is responsible for the old root
+  void makeRoot(TreeNode* newRoot) {
     if (newRoot) {
       newRoot->setParent(nullptr);
     }
-    root_ = std::move(newRoot);
+    root_ = newRoot;
   }
 
   inline void trailAppend(
@@ -662,12 +796,27 @@ class RadixTree {
       bool includeNonValueNodes,
       const TreeNode* node) const;
 
-  std::unique_ptr<TreeNode> root_{nullptr};
+  TreeNode* root_{nullptr};
   size_t size_{0};
   NodeDeleteCallback nodeDeleteCallback_;
   TreeTraits traits_;
+  NodeAllocator allocator_;
 };
 
+/*
+ * RadixTree whose nodes come from a RadixTreeNodePool, for large trees
+ * where per node heap allocations are a noticeable memory overhead.
+ */
+template <
+    typename IPADDRTYPE,
+    typename T,
+    typename TreeTraits = RadixTreeTraits<IPADDRTYPE, T>>
+using PooledRadixTree = RadixTree<
+    IPADDRTYPE,
+    T,
+    TreeTraits,
+    RadixTreeNodePool<RadixTreeNode<IPADDRTYPE, T>>>;
+
 // RadixTreeIteratorImpl for IPAddress
 template <
     typename T,
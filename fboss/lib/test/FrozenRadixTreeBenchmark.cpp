@@ -0,0 +1,108 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <folly/Benchmark.h>
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+#include <folly/Random.h>
+#include <set>
+#include <vector>
+#include "common/init/Init.h"
+#include "fboss/lib/FrozenRadixTree.h"
+#include "fboss/lib/RadixTree.h"
+
+using namespace std;
+using namespace folly;
+using namespace facebook;
+using namespace facebook::network;
+
+DEFINE_int32(
+    prefix_count,
+    200000,
+    "The number of prefixes to insert into each tree");
+DEFINE_int32(
+    lookup_count,
+    10000,
+    "The number of addresses to look up on each lookup iteration");
+
+namespace {
+RadixTree<IPAddressV4, int> tree4;
+RadixTree<IPAddressV6, int> tree6;
+FrozenRadixTree<IPAddressV4, int> frozen4;
+FrozenRadixTree<IPAddressV6, int> frozen6;
+vector<IPAddressV4> lookups4;
+vector<IPAddressV6> lookups6;
+
+template <typename TREE, typename ADDRS>
+void treeLongestMatch(const TREE& tree, const ADDRS& addrs) {
+  for (const auto& addr : addrs) {
+    doNotOptimizeAway(tree.longestMatch(addr, addr.bitCount()));
+  }
+}
+
+BENCHMARK(RadixTreeLongestMatch4) {
+  treeLongestMatch(tree4, lookups4);
+}
+
+BENCHMARK_RELATIVE(FrozenRadixTreeLongestMatch4) {
+  treeLongestMatch(frozen4, lookups4);
+}
+
+BENCHMARK(RadixTreeLongestMatch6) {
+  treeLongestMatch(tree6, lookups6);
+}
+
+BENCHMARK_RELATIVE(FrozenRadixTreeLongestMatch6) {
+  treeLongestMatch(frozen6, lookups6);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(FreezeTree4) {
+  FrozenRadixTree<IPAddressV4, int> frozen(tree4);
+  doNotOptimizeAway(frozen.size());
+}
+
+BENCHMARK(FreezeTree6) {
+  FrozenRadixTree<IPAddressV6, int> frozen(tree6);
+  doNotOptimizeAway(frozen.size());
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+  facebook::initFacebook(&argc, &argv);
+  vector<IPAddressV4> installed4;
+  vector<IPAddressV6> installed6;
+  while (tree4.size() < FLAGS_prefix_count) {
+    auto mask = 8 + folly::Random::rand32(25);
+    auto ip = IPAddressV4::fromLongHBO(folly::Random::rand32()).mask(mask);
+    if (tree4.insert(ip, mask, tree4.size()).second) {
+      installed4.push_back(ip);
+    }
+  }
+  while (tree6.size() < FLAGS_prefix_count) {
+    auto mask = 16 + folly::Random::rand32(113);
+    ByteArray16 ba;
+    *(uint64_t*)(&ba[0]) = folly::Random::rand64();
+    *(uint64_t*)(&ba[8]) = folly::Random::rand64();
+    auto ip = IPAddressV6(ba).mask(mask);
+    if (tree6.insert(ip, mask, tree6.size()).second) {
+      installed6.push_back(ip);
+    }
+  }
+  frozen4 = FrozenRadixTree<IPAddressV4, int>(tree4);
+  frozen6 = FrozenRadixTree<IPAddressV6, int>(tree6);
+  // Half of the lookups hit an installed prefix, the rest are random
+  for (auto i = 0; i < FLAGS_lookup_count; ++i) {
+    if (i % 2) {
+      lookups4.push_back(installed4[folly::Random::rand32(installed4.size())]);
+      lookups6.push_back(installed6[folly::Random::rand32(installed6.size())]);
+    } else {
+      lookups4.push_back(IPAddressV4::fromLongHBO(folly::Random::rand32()));
+      ByteArray16 ba;
+      *(uint64_t*)(&ba[0]) = folly::Random::rand64();
+      *(uint64_t*)(&ba[8]) = folly::Random::rand64();
+      lookups6.push_back(IPAddressV6(ba));
+    }
+  }
+  runBenchmarks();
+}
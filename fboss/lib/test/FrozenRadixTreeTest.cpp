@@ -0,0 +1,112 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <gtest/gtest.h>
+
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+#include <folly/Random.h>
+
+#include "fboss/lib/FrozenRadixTree.h"
+#include "fboss/lib/RadixTree.h"
+
+using namespace facebook::network;
+using folly::IPAddressV4;
+using folly::IPAddressV6;
+
+namespace {
+
+IPAddressV4 randomIp4() {
+  // Keep the address space small enough for prefixes to overlap
+  return IPAddressV4::fromLongHBO(folly::Random::rand32() & 0xF0F0FFFF);
+}
+
+IPAddressV6 randomIp6() {
+  // Like randomIp4() in the leading bytes, with bytes 4-7 left at zero
+  uint64_t high = folly::Random::rand64() & 0xF0F0FFFF00000000;
+  uint64_t low = folly::Random::rand64();
+  folly::ByteArray16 bytes{};
+  for (int i = 0; i < 8; ++i) {
+    bytes[i] = static_cast<uint8_t>(high >> (56 - 8 * i));
+    bytes[8 + i] = static_cast<uint8_t>(low >> (56 - 8 * i));
+  }
+  return IPAddressV6(bytes);
+}
+
+template <typename IPADDRTYPE, typename RandomIp>
+void checkFrozenMatchesTree(RandomIp randomIp) {
+  RadixTree<IPADDRTYPE, int> tree;
+  auto bitCount = IPADDRTYPE::bitCount();
+  for (auto i = 0; i < 10000; ++i) {
+    auto masklen = folly::Random::rand32(bitCount + 1);
+    tree.insert(randomIp().mask(masklen), masklen, i);
+  }
+  FrozenRadixTree<IPADDRTYPE, int> frozen(tree);
+  EXPECT_EQ(tree.size(), frozen.size());
+  EXPECT_GE(frozen.nodeCount(), frozen.size());
+
+  for (const auto& entry : frozen) {
+    auto itr = tree.exactMatch(entry.ipAddress, entry.masklen);
+    ASSERT_NE(tree.end(), itr);
+    EXPECT_EQ(itr->value(), entry.value);
+  }
+  for (auto i = 0; i < 100000; ++i) {
+    auto ip = randomIp();
+    auto masklen = folly::Random::rand32(bitCount + 1);
+
+    auto itr = tree.longestMatch(ip, masklen);
+    auto entry = frozen.longestMatch(ip, masklen);
+    ASSERT_EQ(itr == tree.end(), entry == nullptr);
+    if (entry) {
+      EXPECT_EQ(itr->ipAddress(), entry->ipAddress);
+      EXPECT_EQ(itr->masklen(), entry->masklen);
+      EXPECT_EQ(itr->value(), entry->value);
+    }
+
+    itr = tree.exactMatch(ip.mask(masklen), masklen);
+    entry = frozen.exactMatch(ip, masklen);
+    ASSERT_EQ(itr == tree.end(), entry == nullptr);
+    if (entry) {
+      EXPECT_EQ(itr->value(), entry->value);
+    }
+  }
+}
+} // namespace
+
+TEST(FrozenRadixTree, Empty) {
+  RadixTree<IPAddressV4, int> tree;
+  FrozenRadixTree<IPAddressV4, int> frozen(tree);
+  EXPECT_TRUE(frozen.empty());
+  EXPECT_EQ(0, frozen.nodeCount());
+  EXPECT_EQ(nullptr, frozen.longestMatch(IPAddressV4("10.0.0.1"), 32));
+  EXPECT_EQ(nullptr, frozen.exactMatch(IPAddressV4("10.0.0.0"), 8));
+}
+
+TEST(FrozenRadixTree, DefaultRoute) {
+  RadixTree<IPAddressV6, int> tree;
+  tree.insert(IPAddressV6("::"), 0, 1);
+  tree.insert(IPAddressV6("2401:db00::"), 32, 2);
+  tree.insert(IPAddressV6("2401:db00::1"), 128, 3);
+  FrozenRadixTree<IPAddressV6, int> frozen(tree);
+
+  auto entry = frozen.longestMatch(IPAddressV6("2401:db00::1"), 128);
+  ASSERT_NE(nullptr, entry);
+  EXPECT_EQ(3, entry->value);
+  entry = frozen.longestMatch(IPAddressV6("2401:db00::2"), 128);
+  ASSERT_NE(nullptr, entry);
+  EXPECT_EQ(2, entry->value);
+  entry = frozen.longestMatch(IPAddressV6("2401:db00::1"), 64);
+  ASSERT_NE(nullptr, entry);
+  EXPECT_EQ(2, entry->value);
+  entry = frozen.longestMatch(IPAddressV6("fc00::1"), 128);
+  ASSERT_NE(nullptr, entry);
+  EXPECT_EQ(1, entry->value);
+  EXPECT_EQ(nullptr, frozen.exactMatch(IPAddressV6("2401:db00::"), 64));
+}
+
+TEST(FrozenRadixTree, MatchesTree4) {
+  checkFrozenMatchesTree<IPAddressV4>(randomIp4);
+}
+
+TEST(FrozenRadixTree, MatchesTree6) {
+  checkFrozenMatchesTree<IPAddressV6>(randomIp6);
+}
@@ -0,0 +1,254 @@
+/*
+ *  Copyright (c) 2004-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree. An additional grant
+ *  of patent rights can be found in the PATENTS file in the same directory.
+ *
+ */
+
+#include "fboss/lib/PersistentMap.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace facebook::fboss;
+
+namespace {
+
+using IntMap = PersistentMap<int, std::shared_ptr<int>>;
+
+template <typename MapT>
+void expectSameContents(
+    const std::map<int, int>& expected,
+    const MapT& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  auto it = actual.begin();
+  for (const auto& entry : expected) {
+    ASSERT_NE(actual.end(), it);
+    EXPECT_EQ(entry.first, it->first);
+    EXPECT_EQ(entry.second, *it->second);
+    ++it;
+  }
+  EXPECT_EQ(actual.end(), it);
+  // And backwards
+  auto rit = actual.rbegin();
+  for (auto eit = expected.rbegin(); eit != expected.rend(); ++eit, ++rit) {
+    ASSERT_NE(actual.rend(), rit);
+    EXPECT_EQ(eit->first, rit->first);
+  }
+  EXPECT_EQ(actual.rend(), rit);
+}
+
+} // namespace
+
+TEST(PersistentMap, InsertFindErase) {
+  IntMap map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.begin(), map.end());
+
+  for (int i = 0; i < 100; ++i) {
+    auto ret = map.insert(std::make_pair(i * 2, std::make_shared<int>(i)));
+    EXPECT_TRUE(ret.second);
+    EXPECT_EQ(i * 2, ret.first->first);
+  }
+  EXPECT_EQ(100, map.size());
+  EXPECT_FALSE(map.insert(std::make_pair(10, std::make_shared<int>(0))).second);
+  EXPECT_EQ(5, *map.find(10)->second);
+  EXPECT_EQ(map.end(), map.find(11));
+  EXPECT_EQ(12, map.lower_bound(11)->first);
+  EXPECT_EQ(1, map.count(198));
+  EXPECT_EQ(0, map.count(199));
+
+  auto next = map.erase(map.find(10));
+  EXPECT_EQ(12, next->first);
+  EXPECT_EQ(0, map.erase(10));
+  EXPECT_EQ(1, map.erase(12));
+  EXPECT_EQ(98, map.size());
+  EXPECT_EQ(map.end(), map.erase(map.find(198)));
+}
+
+TEST(PersistentMap, CopiesAreIndependent) {
+  IntMap map;
+  for (int i = 0; i < 1000; ++i) {
+    map.emplace(i, std::make_shared<int>(i));
+  }
+  const IntMap original = map;
+  auto copy = map;
+  EXPECT_EQ(original, copy);
+
+  copy.find(500)->second = std::make_shared<int>(-1);
+  copy.erase(0);
+  copy.emplace(1000, std::make_shared<int>(1000));
+
+  EXPECT_EQ(500, *original.find(500)->second);
+  EXPECT_EQ(-1, *copy.find(500)->second);
+  EXPECT_EQ(1, original.count(0));
+  EXPECT_EQ(0, copy.count(0));
+  EXPECT_EQ(0, original.count(1000));
+  EXPECT_NE(original, copy);
+  // Unmodified values are the same objects in both maps
+  EXPECT_EQ(original.find(250)->second, copy.find(250)->second);
+}
+
+TEST(PersistentMap, MutableIterationDoesNotLeak) {
+  IntMap map;
+  for (int i = 0; i < 100; ++i) {
+    map.emplace(i, std::make_shared<int>(i));
+  }
+  const IntMap original = map;
+  for (auto& entry : map) {
+    entry.second = std::make_shared<int>(entry.first + 1);
+  }
+  for (const auto& entry : original) {
+    EXPECT_EQ(entry.first, *entry.second);
+  }
+  for (const auto& entry : map) {
+    EXPECT_EQ(entry.first + 1, *entry.second);
+  }
+}
+
+TEST(PersistentMap, EndDoesNotUnshare) {
+  IntMap single{{0, std::make_shared<int>(0)}};
+  const IntMap singleCopy = single;
+  EXPECT_EQ(single.end(), single.find(1));
+  // The root is still shared with the copy
+  EXPECT_EQ(&*singleCopy.begin(), &*std::as_const(single).begin());
+
+  IntMap map;
+  for (int i = 0; i < 100; ++i) {
+    map.emplace(i, std::make_shared<int>(i));
+  }
+  const IntMap original = map;
+
+  // Decrementing end() un-shares the path to the last entry
+  auto last = --map.end();
+  EXPECT_EQ(99, last->first);
+  last->second = std::make_shared<int>(-1);
+  EXPECT_EQ(99, *original.find(99)->second);
+  EXPECT_EQ(-1, *map.find(99)->second);
+}
+
+TEST(PersistentMap, RandomOperations) {
+  std::mt19937 gen(1337);
+  std::uniform_int_distribution<int> keys(0, 500);
+  std::map<int, int> expected;
+  IntMap map;
+  std::vector<std::pair<std::map<int, int>, IntMap>> snapshots;
+  for (int i = 0; i < 5000; ++i) {
+    auto key = keys(gen);
+    switch (gen() % 3) {
+      case 0:
+        expected.emplace(key, i);
+        map.emplace(key, std::make_shared<int>(i));
+        break;
+      case 1: {
+        auto it = map.find(key);
+        if (it != map.end()) {
+          it->second = std::make_shared<int>(i);
+          expected[key] = i;
+        }
+        break;
+      }
+      case 2:
+        EXPECT_EQ(expected.erase(key), map.erase(key));
+        break;
+    }
+    if (i % 500 == 0) {
+      snapshots.emplace_back(expected, map);
+    }
+  }
+  expectSameContents(expected, map);
+  for (const auto& snapshot : snapshots) {
+    expectSameContents(snapshot.first, snapshot.second);
+  }
+}
+
+TEST(PersistentMap, SkipShared) {
+  IntMap oldMap;
+  for (int i = 0; i < 10000; ++i) {
+    oldMap.emplace(i, std::make_shared<int>(i));
+  }
+  auto newMap = oldMap;
+  newMap.find(1234)->second = std::make_shared<int>(-1);
+  newMap.erase(5000);
+  newMap.emplace(10000, std::make_shared<int>(10000));
+
+  // Walk both maps like NodeMapDelta does, skipping what they share
+  std::vector<int> changed;
+  size_t steps = 0;
+  auto oldIt = std::as_const(oldMap).begin();
+  auto newIt = std::as_const(newMap).begin();
+  while (oldIt != oldMap.end() || newIt != newMap.end()) {
+    ++steps;
+    if (newIt == newMap.end() ||
+        (oldIt != oldMap.end() && oldIt->first < newIt->first)) {
+      changed.push_back(oldIt++->first);
+    } else if (oldIt == oldMap.end() || newIt->first < oldIt->first) {
+      changed.push_back(newIt++->first);
+    } else if (oldIt->second != newIt->second) {
+      changed.push_back(oldIt->first);
+      ++oldIt;
+      ++newIt;
+    } else if (!IntMap::skipShared(oldIt, newIt)) {
+      ++oldIt;
+      ++newIt;
+    }
+  }
+  EXPECT_EQ((std::vector<int>{1234, 5000, 10000}), changed);
+  // Only the nodes on the modified paths had to be visited
+  EXPECT_LT(steps, 200);
+}
+
+TEST(PersistentMap, PublishSkipsPublishedSubtrees) {
+  IntMap oldMap;
+  for (int i = 0; i < 10000; ++i) {
+    oldMap.emplace(i, std::make_shared<int>(i));
+  }
+  size_t published = 0;
+  auto countPublished = [&published](const IntMap::value_type&) {
+    ++published;
+  };
+  oldMap.publish(countPublished);
+  EXPECT_EQ(10000, published);
+  published = 0;
+  oldMap.publish(countPublished);
+  EXPECT_EQ(0, published);
+
+  auto newMap = oldMap;
+  newMap.find(1234)->second = std::make_shared<int>(-1);
+  newMap.erase(5000);
+  newMap.emplace(10000, std::make_shared<int>(10000));
+  std::vector<int> visited;
+  newMap.publish(
+      [&visited](const IntMap::value_type& entry) {
+        visited.push_back(entry.first);
+      });
+  // The changed entries, and the entries on the paths to them
+  EXPECT_TRUE(std::is_sorted(visited.begin(), visited.end()));
+  EXPECT_NE(visited.end(), std::find(visited.begin(), visited.end(), 1234));
+  EXPECT_NE(visited.end(), std::find(visited.begin(), visited.end(), 10000));
+  EXPECT_LT(visited.size(), 100);
+
+  // The original map is still published
+  oldMap.publish(countPublished);
+  EXPECT_EQ(0, published);
+
+  // Modifying a published map that isn't shared clears its marks too
+  oldMap = IntMap();
+  newMap.find(42)->second = std::make_shared<int>(-1);
+  visited.clear();
+  newMap.publish(
+      [&visited](const IntMap::value_type& entry) {
+        visited.push_back(entry.first);
+      });
+  EXPECT_NE(visited.end(), std::find(visited.begin(), visited.end(), 42));
+  EXPECT_LT(visited.size(), 50);
+}
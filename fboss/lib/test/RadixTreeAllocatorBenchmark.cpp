@@ -0,0 +1,175 @@
+// Copyright 2004-present Facebook. All Rights Reserved.
+
+#include <malloc.h>
+#include <folly/Benchmark.h>
+#include <folly/IPAddressV4.h>
+#include <folly/IPAddressV6.h>
+#include <folly/Random.h>
+#include <iostream>
+#include <set>
+#include <vector>
+#include "Utils.h"
+#include "common/init/Init.h"
+#include "fboss/lib/RadixTree.h"
+
+using namespace std;
+using namespace folly;
+using namespace facebook;
+using namespace facebook::network;
+
+DEFINE_int32(
+    prefix_count,
+    200000,
+    "The number of prefixes to insert into each tree");
+DEFINE_int32(
+    lookup_count,
+    10000,
+    "The number of addresses to look up on each lookup iteration");
+
+namespace {
+vector<Prefix4> prefixes4;
+vector<Prefix6> prefixes6;
+vector<IPAddressV4> lookups4;
+vector<IPAddressV6> lookups6;
+
+/*
+ * Heap node allocator which keeps track of the bytes malloc actually
+ * handed out (including malloc's own rounding), used to report the memory
+ * per prefix of non pooled trees.
+ */
+template <typename TREENODE>
+class CountingHeapNodeAllocator {
+ public:
+  void* allocate() {
+    auto node = ::operator new(sizeof(TREENODE));
+    bytesAllocated_ += malloc_usable_size(node);
+    return node;
+  }
+  void deallocate(void* node) {
+    bytesAllocated_ -= malloc_usable_size(node);
+    ::operator delete(node);
+  }
+  size_t bytesAllocated() const {
+    return bytesAllocated_;
+  }
+
+ private:
+  size_t bytesAllocated_{0};
+};
+
+template <typename IPADDRTYPE, typename T>
+using CountingRadixTree = RadixTree<
+    IPADDRTYPE,
+    T,
+    RadixTreeTraits<IPADDRTYPE, T>,
+    CountingHeapNodeAllocator<RadixTreeNode<IPADDRTYPE, T>>>;
+
+template <typename TREE, typename PREFIXES>
+void setupTree(TREE& tree, const PREFIXES& prefixes) {
+  auto count = 0;
+  for (const auto& pfx : prefixes) {
+    tree.insert(pfx.ip, pfx.mask, count++);
+  }
+}
+
+template <typename TREE, typename PREFIXES>
+void insert(const PREFIXES& prefixes) {
+  TREE tree;
+  setupTree(tree, prefixes);
+  // Don't count freeing the tree
+  BENCHMARK_SUSPEND {
+    tree.clear();
+  }
+}
+
+template <typename TREE, typename PREFIXES, typename ADDRS>
+void longestMatch(const PREFIXES& prefixes, const ADDRS& addrs) {
+  TREE tree;
+  BENCHMARK_SUSPEND {
+    setupTree(tree, prefixes);
+  }
+  for (const auto& addr : addrs) {
+    doNotOptimizeAway(tree.longestMatch(addr, addr.bitCount()));
+  }
+  BENCHMARK_SUSPEND {
+    tree.clear();
+  }
+}
+
+BENCHMARK(HeapInsert4) {
+  insert<RadixTree<IPAddressV4, int>>(prefixes4);
+}
+
+BENCHMARK_RELATIVE(PooledInsert4) {
+  insert<PooledRadixTree<IPAddressV4, int>>(prefixes4);
+}
+
+BENCHMARK(HeapLongestMatch4) {
+  longestMatch<RadixTree<IPAddressV4, int>>(prefixes4, lookups4);
+}
+
+BENCHMARK_RELATIVE(PooledLongestMatch4) {
+  longestMatch<PooledRadixTree<IPAddressV4, int>>(prefixes4, lookups4);
+}
+
+BENCHMARK(HeapInsert6) {
+  insert<RadixTree<IPAddressV6, int>>(prefixes6);
+}
+
+BENCHMARK_RELATIVE(PooledInsert6) {
+  insert<PooledRadixTree<IPAddressV6, int>>(prefixes6);
+}
+
+BENCHMARK(HeapLongestMatch6) {
+  longestMatch<RadixTree<IPAddressV6, int>>(prefixes6, lookups6);
+}
+
+BENCHMARK_RELATIVE(PooledLongestMatch6) {
+  longestMatch<PooledRadixTree<IPAddressV6, int>>(prefixes6, lookups6);
+}
+
+template <typename IPADDRTYPE, typename PREFIXES>
+void printMemoryPerPrefix(const string& name, const PREFIXES& prefixes) {
+  CountingRadixTree<IPADDRTYPE, int> heapTree;
+  PooledRadixTree<IPADDRTYPE, int> pooledTree;
+  setupTree(heapTree, prefixes);
+  setupTree(pooledTree, prefixes);
+  cout << name << ": node size " << sizeof(RadixTreeNode<IPADDRTYPE, int>)
+       << "B, heap " << heapTree.allocator().bytesAllocated() / prefixes.size()
+       << "B/prefix, pooled "
+       << pooledTree.allocator().bytesReserved() / prefixes.size()
+       << "B/prefix" << endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  facebook::initFacebook(&argc, &argv);
+  set<Prefix4> seen4;
+  while (prefixes4.size() < FLAGS_prefix_count) {
+    auto mask = 8 + folly::Random::rand32(25);
+    auto ip = IPAddressV4::fromLongHBO(folly::Random::rand32()).mask(mask);
+    if (seen4.insert(Prefix4(ip, mask)).second) {
+      prefixes4.push_back(Prefix4(ip, mask));
+    }
+  }
+  set<Prefix6> seen6;
+  while (prefixes6.size() < FLAGS_prefix_count) {
+    auto mask = 16 + folly::Random::rand32(113);
+    ByteArray16 ba;
+    *(uint64_t*)(&ba[0]) = folly::Random::rand64();
+    *(uint64_t*)(&ba[8]) = folly::Random::rand64();
+    auto ip = IPAddressV6(ba).mask(mask);
+    if (seen6.insert(Prefix6(ip, mask)).second) {
+      prefixes6.push_back(Prefix6(ip, mask));
+    }
+  }
+  for (auto i = 0; i < FLAGS_lookup_count; ++i) {
+    lookups4.push_back(prefixes4[folly::Random::rand32(prefixes4.size())].ip);
+    lookups6.push_back(prefixes6[folly::Random::rand32(prefixes6.size())].ip);
+  }
+
+  printMemoryPerPrefix<IPAddressV4>("v4", prefixes4);
+  printMemoryPerPrefix<IPAddressV6>("v6", prefixes6);
+  runBenchmarks();
+}
@@ -1539,3 +1539,70 @@ TEST(RadixTree, SubTreeIterator) {
   }
   EXPECT_EQ(rtree.end().subTreeIterator(), rtree.end());
 }
+
+/*
+ * A tree backed by a node pool should behave exactly like the default,
+ * heap backed tree: same shape, same delete callback invocations and
+ * node reuse across erase/insert cycles.
+ */
+TEST(RadixTree, PooledNodes) {
+  auto heapNodesDeleted = 0;
+  auto pooledNodesDeleted = 0;
+  RadixTree<IPAddressV4, int> heapTree(
+      [&](const RadixTreeNode<IPAddressV4, int>& /*node*/) {
+        ++heapNodesDeleted;
+      });
+  PooledRadixTree<IPAddressV4, int> pooledTree(
+      [&](const RadixTreeNode<IPAddressV4, int>& /*node*/) {
+        ++pooledNodesDeleted;
+      });
+  std::vector<std::pair<IPAddressV4, uint8_t>> inserted;
+  auto const kInsertCount = 1000;
+  set<Prefix4> prefixesSeen;
+  for (auto i = 0; i < kInsertCount;) {
+    auto mask = folly::Random::rand32(32);
+    auto ip = IPAddressV4::fromLongHBO(folly::Random::rand32()).mask(mask);
+    if (!prefixesSeen.insert(Prefix4(ip, mask)).second) {
+      continue;
+    }
+    ++i;
+    heapTree.insert(ip, mask, i);
+    pooledTree.insert(ip, mask, i);
+    inserted.emplace_back(ip, mask);
+  }
+  EXPECT_EQ(kInsertCount, pooledTree.size());
+  EXPECT_TRUE(RadixTree<IPAddressV4, int>::radixSubTreesEqual(
+      heapTree.root(), pooledTree.root()));
+  auto nodesInUse = pooledTree.allocator().nodesInUse();
+  auto bytesReserved = pooledTree.allocator().bytesReserved();
+  EXPECT_GE(nodesInUse, kInsertCount);
+
+  // Erase and re-insert half the prefixes, freed nodes should be reused
+  for (auto i = 0; i < kInsertCount / 2; ++i) {
+    EXPECT_TRUE(heapTree.erase(inserted[i].first, inserted[i].second));
+    EXPECT_TRUE(pooledTree.erase(inserted[i].first, inserted[i].second));
+  }
+  EXPECT_EQ(heapNodesDeleted, pooledNodesDeleted);
+  EXPECT_EQ(
+      nodesInUse - pooledNodesDeleted, pooledTree.allocator().nodesInUse());
+  for (auto i = 0; i < kInsertCount / 2; ++i) {
+    heapTree.insert(inserted[i].first, inserted[i].second, i);
+    pooledTree.insert(inserted[i].first, inserted[i].second, i);
+  }
+  EXPECT_TRUE(RadixTree<IPAddressV4, int>::radixSubTreesEqual(
+      heapTree.root(), pooledTree.root()));
+  EXPECT_EQ(bytesReserved, pooledTree.allocator().bytesReserved());
+
+  // Nodes move along with the pool
+  auto movedTree = std::move(pooledTree);
+  EXPECT_EQ(0, pooledTree.size());
+  EXPECT_EQ(0, pooledTree.allocator().nodesInUse());
+  EXPECT_EQ(kInsertCount, movedTree.size());
+  EXPECT_TRUE(RadixTree<IPAddressV4, int>::radixSubTreesEqual(
+      heapTree.root(), movedTree.root()));
+
+  movedTree.clear();
+  heapTree.clear();
+  EXPECT_EQ(heapNodesDeleted, pooledNodesDeleted);
+  EXPECT_EQ(0, movedTree.allocator().nodesInUse());
+}